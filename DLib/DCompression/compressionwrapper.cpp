@@ -28,6 +28,8 @@
 
 #include "compressionwrapper.h"
 
+/* miniz.c is compiled separately (see DLib-import of the .pro) */
+#define MINIZ_HEADER_FILE_ONLY
 #include "miniz.c"
 
 bool DCompressor::compressIt(QByteArray *pDest, const QByteArray &pSource, DCompressor::COMPRESSION_LEVEL level)
@@ -36,22 +38,22 @@ bool DCompressor::compressIt(QByteArray *pDest, const QByteArray &pSource, DComp
         return false;
 
 
-    unsigned char* toCompress = (unsigned char*)pSource.data();
-    mz_ulong len = (mz_ulong)pSource.size();
-
-    mz_ulong outputLen = len;
-    unsigned char* compressedData = (unsigned char*)malloc((size_t)len);
+    const unsigned char* toCompress = (const unsigned char*)pSource.constData();
+    const mz_ulong len = (mz_ulong)pSource.size();
 
-    const int returnVal = mz_compress2(compressedData, &outputLen, toCompress, len, level);
+    mz_ulong outputLen = mz_compressBound(len);
+    pDest->resize((int)outputLen);
 
-    pDest->resize(outputLen);
-    for ( int i = 0 ; i < outputLen ; ++ i )
-        pDest->append(compressedData[i]);
+    const int returnVal = mz_compress2((unsigned char*)pDest->data(), &outputLen, toCompress, len, (level == DEFAULT_COMPRESSION)?MZ_DEFAULT_COMPRESSION:(int)level);
 
-    if ( returnVal == MZ_OK )
+    if ( returnVal == MZ_OK ) {
+        pDest->resize((int)outputLen);
         return true;
-    else
+    }
+    else {
+        pDest->clear();
         return false;
+    }
 }
 
 bool DCompressor::uncompressIt(QByteArray *pDest, const QByteArray &pSource)
@@ -60,22 +62,56 @@ bool DCompressor::uncompressIt(QByteArray *pDest, const QByteArray &pSource)
         return false;
 
 
-    const unsigned char* toUncompress = (const unsigned char*)pSource.data();
-    const mz_ulong len = (mz_ulong)pSource.size();
+    /* the uncompressed size is unknown: grow the buffer until it fits */
+    int size = qMax(1024, 4*pSource.size());
+
+    forever {
+        if ( uncompressIt(pDest, pSource, size) )
+            return true;
+
+        if ( pDest->size() != size /* not a buffer error */
+             || size > (INT_MAX/2) )
+            return false;
+
+        size *= 2;
+    }
+}
+
+bool DCompressor::uncompressIt(QByteArray *pDest, const QByteArray &pSource, int uncompressedSize)
+{
+    if ( !pDest )
+        return false;
+
 
-    mz_ulong outputLen = len;
-    unsigned char* uncompressedData;
+    const unsigned char* toUncompress = (const unsigned char*)pSource.constData();
+    const mz_ulong len = (mz_ulong)pSource.size();
 
-    const int returnVal = mz_uncompress(uncompressedData, &outputLen, toUncompress, len);
+    mz_ulong outputLen = (mz_ulong)uncompressedSize;
+    pDest->resize(uncompressedSize);
 
-    pDest->resize(outputLen);
-    for ( int i = 0 ; i < outputLen ; ++ i )
-        pDest->append(uncompressedData[i]);
+    const int returnVal = mz_uncompress((unsigned char*)pDest->data(), &outputLen, toUncompress, len);
 
-    if ( returnVal == MZ_OK )
+    if ( returnVal == MZ_OK ) {
+        pDest->resize((int)outputLen);
         return true;
-    else
+    }
+    else {
+        /* buffer too small: the size is kept for uncompressIt(...) without size */
+        if ( returnVal != MZ_BUF_ERROR )
+            pDest->clear();
+
         return false;
+    }
+}
+
+quint32 DCompressor::crc32(const QByteArray &pSource, quint32 crc)
+{
+    return (quint32)mz_crc32((mz_ulong)crc, (const unsigned char*)pSource.constData(), (size_t)pSource.size());
+}
+
+quint32 DCompressor::crc32(const char *pSource, int size, quint32 crc)
+{
+    return (quint32)mz_crc32((mz_ulong)crc, (const unsigned char*)pSource, (size_t)size);
 }
 
 QByteArray DCompressor::unzip(const QByteArray &pSource)
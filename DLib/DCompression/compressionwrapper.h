@@ -45,6 +45,11 @@ public:
 
     static bool compressIt(QByteArray *pDest, const QByteArray& pSource, COMPRESSION_LEVEL level = DEFAULT_LEVEL);
     static bool uncompressIt(QByteArray *pDest, const QByteArray& pSource);
+    static bool uncompressIt(QByteArray *pDest, const QByteArray& pSource, int uncompressedSize);
+
+    /* CRC-32 (zlib), crc: CRC of the preceding data (0: start) */
+    static quint32 crc32(const QByteArray& pSource, quint32 crc = 0);
+    static quint32 crc32(const char *pSource, int size, quint32 crc = 0);
 
     static QByteArray zip(const QByteArray& pSource, COMPRESSION_LEVEL level = DEFAULT_LEVEL);
     static QByteArray unzip(const QByteArray& pSource);
@@ -644,6 +644,47 @@ int plot2DXAxis::ConvertToPixel(double point,
     return pxValue;
 }
 
+void plot2DXAxis::ConvertToPixel(const double *points,
+                                  int count,
+                                  int *pxValues,
+                                  plot2DXAxis::axisScaling scaling)
+{
+    if ( !points || !pxValues || count <= 0 )
+        return;
+
+    const bool vertical = (m_docking == yLeft || m_docking == yRight);
+    const double length = (double)getAxisLength();
+    const double origin = vertical?((double)m_height - (double)AXIS_TO_BORDER_OFFSET):(double)AXIS_TO_BORDER_OFFSET;
+    const double direction = vertical?-1.0:1.0;
+
+    switch ( scaling ){
+    case linear:
+    {
+        const double minValue = getAxisMinValue();
+        const double span = getAxisSpan();
+
+        for ( int i = 0 ; i < count ; ++ i )
+            pxValues[i] = origin + direction*(( points[i] - minValue )/span)*length;
+    }
+        break;
+    case logarithmic:
+    {
+        const double logMinValue = log10(getAxisMinValue());
+        const double logSpan = log10(getAxisMaxValue()) - logMinValue;
+
+        for ( int i = 0 ; i < count ; ++ i )
+            pxValues[i] = origin + direction*(( log10(points[i]) - logMinValue )/logSpan)*length;
+    }
+        break;
+    default:
+    {
+        for ( int i = 0 ; i < count ; ++ i )
+            pxValues[i] = 0;
+    }
+        break;
+    }
+}
+
 double plot2DXAxis::ConvertFromPixel(int point,
                                           plot2DXAxis::axisScaling scaling)
 {
@@ -147,6 +147,7 @@ public:
     axisValueDisplay getValueDisplay() const;
 
     int ConvertToPixel(double point, axisScaling scaling);
+    void ConvertToPixel(const double *points, int count, int *pxValues, axisScaling scaling); //batch: scaling is evaluated once
     double ConvertFromPixel(int point, axisScaling scaling);
 
 signals:
@@ -37,19 +37,37 @@
 plot2DXCanvas::plot2DXCanvas(QWidget *parent) :
     QWidget(parent),
     m_canvasPixmap(parent->size()),
-    m_bgdColor(DEFAULT_CANVAS_BACKGROUND_COLOR)
+    m_composeNeeded(false),
+    m_bgdColor(DEFAULT_CANVAS_BACKGROUND_COLOR),
+    m_asyncRendering(false),
+    m_frameRequested(false),
+    m_generation(0),
+    m_layerRevision(0),
+    m_renderer(nullptr),
+    m_renderThread(nullptr)
 {
     m_canvasPixmap.fill(getBackgroundColor());
 }
 
+plot2DXCanvas::~plot2DXCanvas()
+{
+    if ( m_renderThread ){
+        m_renderThread->quit();
+        m_renderThread->wait();
+    }
+
+    delete m_renderer;
+    m_renderer = 0;
+
+    delete m_renderThread;
+    m_renderThread = 0;
+}
+
 void plot2DXCanvas::setBackgroundColor(const QColor &color)
 {
     m_bgdColor = color;
 
-    m_canvasPixmap = QPixmap(rect().size());
-    m_canvasPixmap.fill(getBackgroundColor());
-
-    update();
+    clear();
 
     emit canvasPropertyChanged();
 }
@@ -59,7 +77,53 @@ void plot2DXCanvas::clear()
     m_canvasPixmap = QPixmap(rect().size());
     m_canvasPixmap.fill(getBackgroundColor());
 
-    update();
+    m_gridPixmap = QPixmap();
+
+    m_curveLayers.clear();
+    m_curveLayerKeys.clear();
+    m_curveLayerValid.clear();
+
+    m_composeNeeded = false;
+
+    m_sceneGrids.clear();
+    m_sceneLayers.clear();
+
+    if ( isAsyncRendering() )
+        invalidate();
+    else
+        update();
+}
+
+void plot2DXCanvas::setAsyncRendering(bool on)
+{
+    if ( m_asyncRendering == on )
+        return;
+
+    if ( on && !m_renderer ){
+        m_renderThread = new QThread;
+        m_renderer = new plot2DXRenderer;
+        m_renderer->moveToThread(m_renderThread);
+
+        connect(m_renderer, SIGNAL(frameReady(int,QImage)), this, SLOT(frameReady(int,QImage)));
+
+        m_renderThread->start();
+    }
+
+    m_asyncRendering = on;
+    m_frame = QImage();
+
+    //the layers are built again in the new mode:
+    clear();
+
+    emit canvasPropertyChanged();
+}
+
+void plot2DXCanvas::clearGrid()
+{
+    m_gridPixmap = QPixmap();
+    m_sceneGrids.clear();
+
+    invalidate();
 }
 
 QColor plot2DXCanvas::getBackgroundColor() const
@@ -67,28 +131,125 @@ QColor plot2DXCanvas::getBackgroundColor() const
     return m_bgdColor;
 }
 
-void plot2DXCanvas::drawCurve(int curveWidth,
+bool plot2DXCanvas::isAsyncRendering() const
+{
+    return m_asyncRendering;
+}
+
+bool plot2DXCanvas::hasCurveLayer(int layer, const plot2DXLayerKey &key) const
+{
+    if ( layer < 0 || layer >= m_curveLayerValid.size() )
+        return false;
+
+    return m_curveLayerValid.at(layer)
+            && m_curveLayerKeys.at(layer) == key;
+}
+
+void plot2DXCanvas::drawCurve(int layer,
+                                   const plot2DXLayerKey &key,
+                                   int curveWidth,
                                    const QColor& curveColor,
                                    plot2DXCurve::curveStyle style,
                                    const QList<QPoint>& pixelList)
 {
-    if ( m_canvasPixmap.isNull() )
+    if ( layer < 0 )
+        return;
+
+    if ( isAsyncRendering() ){
+        //record the layer of the scene (rasterized by the renderer):
+        plot2DXLayerSnapshot *snapshot = sceneLayer(layer);
+
+        snapshot->revision = ++ m_layerRevision;
+        snapshot->width = curveWidth;
+        snapshot->color = curveColor;
+        snapshot->style = style;
+        snapshot->pixelList = key.shown?pixelList:QList<QPoint>();
+
+        if ( layer >= m_curveLayerKeys.size() ){
+            m_curveLayerKeys.resize(layer + 1);
+            m_curveLayerValid.resize(layer + 1);
+        }
+    }
+    else if ( !key.shown || pixelList.isEmpty() ){
+        //nothing to draw: no layer is allocated
+        if ( layer >= m_curveLayers.size() ){
+            m_curveLayers.resize(layer + 1);
+            m_curveLayerKeys.resize(layer + 1);
+            m_curveLayerValid.resize(layer + 1);
+        }
+
+        m_curveLayers[layer] = QPixmap();
+    }
+    else{
+        QPixmap *curveLayer = this->layer(layer);
+
+        if ( !curveLayer )
+            return;
+
+        curveLayer->fill(Qt::transparent);
+
+        rasterizeCurve(curveLayer, curveWidth, curveColor, style, pixelList);
+    }
+
+    m_curveLayerKeys[layer] = key;
+    m_curveLayerValid[layer] = true;
+
+    invalidate();
+}
+
+void plot2DXCanvas::appendToCurve(int layer,
+                                       int curveWidth,
+                                       const QColor &curveColor,
+                                       plot2DXCurve::curveStyle style,
+                                       const QList<QPoint> &pixelList)
+{
+    if ( layer < 0 )
+        return;
+
+    if ( isAsyncRendering() ){
+        plot2DXLayerSnapshot *snapshot = sceneLayer(layer);
+
+        snapshot->revision = ++ m_layerRevision;
+        snapshot->width = curveWidth;
+        snapshot->color = curveColor;
+        snapshot->style = style;
+        snapshot->pixelList.append(pixelList);
+    }
+    else{
+        QPixmap *curveLayer = this->layer(layer);
+
+        if ( !curveLayer )
+            return;
+
+        rasterizeCurve(curveLayer, curveWidth, curveColor, style, pixelList);
+    }
+
+    //the layer doesn´t match any key anymore (rasterized completely on the next view update):
+    if ( layer < m_curveLayerValid.size() )
+        m_curveLayerValid[layer] = false;
+
+    invalidate();
+}
+
+void plot2DXCanvas::rasterizeCurve(QPaintDevice *device,
+                                        int curveWidth,
+                                        const QColor& curveColor,
+                                        plot2DXCurve::curveStyle style,
+                                        const QList<QPoint>& pixelList)
+{
+    if ( !device || pixelList.isEmpty() )
         return;
 
     const QPen pen(QBrush(curveColor),
                    curveWidth);
 
-    QPainter painter(pixmap());
+    QPainter painter(device);
 
     painter.setPen(pen);
 
     switch ( style ){
     case plot2DXCurve::point:
-    {
-        for ( int i = 0 ; i < pixelList.size() ; i ++ ){
-            drawPoints(pixelList.at(i),&painter);
-        }
-    }
+        drawPoints(pixelList,&painter);
         break;
 
     case plot2DXCurve::line:
@@ -96,27 +257,15 @@ void plot2DXCanvas::drawCurve(int curveWidth,
         break;
 
     case plot2DXCurve::cross:
-    {
-        for ( int i = 0 ; i < pixelList.size() ; i ++ ){
-            drawCross(pixelList.at(i),&painter);
-        }
-    }
+        drawCross(pixelList,&painter);
         break;
 
     case plot2DXCurve::rect:
-    {
-        for ( int i = 0 ; i < pixelList.size() ; i ++ ){
-            drawRect(pixelList.at(i),&painter);
-        }
-    }
+        drawRect(pixelList,&painter);
         break;
 
     case plot2DXCurve::circle:
-    {
-        for ( int i = 0 ; i < pixelList.size() ; i ++ ){
-            drawCircle(pixelList.at(i),&painter);
-        }
-    }
+        drawCircle(pixelList,&painter);
         break;
 
     default:
@@ -124,14 +273,27 @@ void plot2DXCanvas::drawCurve(int curveWidth,
     }
 
     painter.end();
-
-    update();
 }
 
 void plot2DXCanvas::paintEvent(QPaintEvent *event)
 {
     Q_UNUSED(event);
 
+    //asynchronous rendering: blit the last completed frame
+    if ( isAsyncRendering() ){
+        if ( m_frame.isNull() )
+            return;
+
+        QPainter painter(this);
+
+        painter.drawImage(rect(),m_frame);
+
+        return;
+    }
+
+    if ( m_composeNeeded )
+        compose();
+
     if ( m_canvasPixmap.isNull() )
         return;
 
@@ -145,43 +307,211 @@ QPixmap* plot2DXCanvas::pixmap()
     return &m_canvasPixmap;
 }
 
+QPixmap *plot2DXCanvas::layer(int layer)
+{
+    if ( layer < 0 || rect().isEmpty() )
+        return nullptr;
+
+    if ( layer >= m_curveLayers.size() ){
+        m_curveLayers.resize(layer + 1);
+        m_curveLayerKeys.resize(layer + 1);
+        m_curveLayerValid.resize(layer + 1);
+    }
+
+    if ( m_curveLayers.at(layer).size() != rect().size() ){
+        m_curveLayers[layer] = QPixmap(rect().size());
+        m_curveLayers[layer].fill(Qt::transparent);
+
+        m_curveLayerValid[layer] = false;
+    }
+
+    return &m_curveLayers[layer];
+}
+
+QPixmap *plot2DXCanvas::gridLayer()
+{
+    if ( rect().isEmpty() )
+        return nullptr;
+
+    if ( m_gridPixmap.size() != rect().size() ){
+        m_gridPixmap = QPixmap(rect().size());
+        m_gridPixmap.fill(Qt::transparent);
+    }
+
+    return &m_gridPixmap;
+}
+
+plot2DXLayerSnapshot *plot2DXCanvas::sceneLayer(int layer)
+{
+    if ( layer >= m_sceneLayers.size() ){
+        const int oldSize = m_sceneLayers.size();
+
+        m_sceneLayers.resize(layer + 1);
+
+        for ( int i = oldSize ; i < m_sceneLayers.size() ; ++i ){
+            m_sceneLayers[i].revision = ++ m_layerRevision;
+            m_sceneLayers[i].width = 1;
+            m_sceneLayers[i].style = plot2DXCurve::line;
+        }
+    }
+
+    return &m_sceneLayers[layer];
+}
+
+void plot2DXCanvas::invalidate()
+{
+    if ( isAsyncRendering() ){
+        //a single snapshot of all changes until the event loop is reached:
+        if ( !m_frameRequested ){
+            m_frameRequested = true;
+            QMetaObject::invokeMethod(this, "requestFrame", Qt::QueuedConnection);
+        }
+
+        return;
+    }
+
+    m_composeNeeded = true;
+
+    update();
+}
+
+void plot2DXCanvas::requestFrame()
+{
+    m_frameRequested = false;
+
+    if ( !isAsyncRendering() || !m_renderer )
+        return;
+
+    plot2DXScene scene;
+
+    scene.generation = ++ m_generation;
+    scene.size = rect().size();
+    scene.background = getBackgroundColor();
+    scene.grids = m_sceneGrids;
+    scene.layers = m_sceneLayers;
+
+    m_renderer->requestFrame(scene);
+}
+
+void plot2DXCanvas::frameReady(int generation, const QImage &frame)
+{
+    //stale: a newer scene was requested meanwhile
+    if ( generation != m_generation )
+        return;
+
+    m_frame = frame;
+
+    update();
+}
+
+void plot2DXCanvas::compose()
+{
+    /**
+      **********************************************
+      the cached layers are blended in order:
+      background => grid => curve 0 ... curve n
+      **********************************************
+      */
+    m_composeNeeded = false;
+
+    if ( m_canvasPixmap.size() != rect().size() )
+        m_canvasPixmap = QPixmap(rect().size());
+
+    if ( m_canvasPixmap.isNull() )
+        return;
+
+    m_canvasPixmap.fill(getBackgroundColor());
+
+    QPainter painter(pixmap());
+
+    if ( !m_gridPixmap.isNull() )
+        painter.drawPixmap(0,0,m_gridPixmap);
+
+    for ( int i = 0 ; i < m_curveLayers.size() ; ++i ){
+        if ( m_curveLayers.at(i).isNull() )
+            continue;
+
+        painter.drawPixmap(0,0,m_curveLayers.at(i));
+    }
+
+    painter.end();
+}
+
 void plot2DXCanvas::shiftPixmap(int shift)
 {
     if ( shift == 0 )
         return;
 
-    if ( abs(shift) > pixmap()->rect().width() ){
+    if ( abs(shift) > rect().width() ){
         this->clear();
         return;
     }
 
-    QRegion region;
+    if ( isAsyncRendering() ){
+        //the pixels of the curve layers are moved, the grid stays in place:
+        for ( int i = 0 ; i < m_sceneLayers.size() ; ++i ){
+            plot2DXLayerSnapshot *snapshot = &m_sceneLayers[i];
 
-    //scroll and determine the exposed region:
-    pixmap()->scroll(shift,0,pixmap()->rect(),&region);
+            if ( snapshot->pixelList.isEmpty() )
+                continue;
 
-    QPixmap exposedPixmap = QPixmap(region.boundingRect().size());
+            QList<QPoint> shiftedList;
+            shiftedList.reserve(snapshot->pixelList.size());
 
-    exposedPixmap.fill(getBackgroundColor());
+            for ( const QPoint& pixel : snapshot->pixelList ){
+                const QPoint shiftedPixel(pixel.x() + shift, pixel.y());
 
+                if ( shiftedPixel.x() >= 0 && shiftedPixel.x() < rect().width() )
+                    shiftedList.append(shiftedPixel);
+            }
 
-    QPainter painter(pixmap());
+            snapshot->pixelList = shiftedList;
+            snapshot->revision = ++ m_layerRevision;
 
-    if ( shift < 0 )
-        painter.drawPixmap(pixmap()->rect().width() + shift,0,exposedPixmap);
-    else if ( shift > 0 )
-        painter.drawPixmap(shift,0,exposedPixmap);
+            if ( i < m_curveLayerValid.size() )
+                m_curveLayerValid[i] = false;
+        }
 
-    painter.end();
+        invalidate();
+        return;
+    }
+
+    //the curve layers are scrolled, the grid stays in place:
+    for ( int i = 0 ; i < m_curveLayers.size() ; ++i ){
+        QPixmap *curveLayer = &m_curveLayers[i];
+
+        if ( curveLayer->isNull() )
+            continue;
+
+        QRegion region;
+
+        //scroll and determine the exposed region:
+        curveLayer->scroll(shift,0,curveLayer->rect(),&region);
+
+        QPainter painter(curveLayer);
+
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+
+        if ( shift < 0 )
+            painter.fillRect(QRect(curveLayer->rect().width() + shift,0,-shift,curveLayer->rect().height()),Qt::transparent);
+        else if ( shift > 0 )
+            painter.fillRect(QRect(0,0,shift,curveLayer->rect().height()),Qt::transparent);
+
+        painter.end();
+
+        m_curveLayerValid[i] = false;
+    }
+
+    invalidate();
 }
 
-void plot2DXCanvas::drawPoints(const QPoint &pixel,
+void plot2DXCanvas::drawPoints(const QList<QPoint> &pixelList,
                                     QPainter *painter)
 {
-    painter->drawPoint(pixel);
+    painter->drawPoints(QPolygon(pixelList.toVector()));
 }
 
-void plot2DXCanvas::drawCross(const QPoint &pixel,
+void plot2DXCanvas::drawCross(const QList<QPoint> &pixelList,
                                    QPainter *painter)
 {
     const int width = painter->pen().width();
@@ -190,19 +520,20 @@ void plot2DXCanvas::drawCross(const QPoint &pixel,
 
     painter->setPen(QPen(QBrush(painter->pen().brush()),1));
 
-    QPainterPath path;
+    QVector<QLine> lines;
+    lines.reserve(2*pixelList.size());
 
-    path.moveTo(QPoint(pixel.x()-width/2,pixel.y()-width/2));
-    path.lineTo(QPoint(pixel.x()+width/2,pixel.y()+width/2));
-    path.moveTo(QPoint(pixel.x()+width/2,pixel.y()-width/2));
-    path.lineTo(QPoint(pixel.x()-width/2,pixel.y()+width/2));
+    for ( const QPoint& pixel : pixelList ){
+        lines.append(QLine(pixel.x()-width/2,pixel.y()-width/2,pixel.x()+width/2,pixel.y()+width/2));
+        lines.append(QLine(pixel.x()+width/2,pixel.y()-width/2,pixel.x()-width/2,pixel.y()+width/2));
+    }
 
-    painter->drawPath(path);
+    painter->drawLines(lines);
 
     painter->restore();
 }
 
-void plot2DXCanvas::drawRect(const QPoint &pixel,
+void plot2DXCanvas::drawRect(const QList<QPoint> &pixelList,
                                   QPainter *painter)
 {
     const int width = painter->pen().width();
@@ -210,7 +541,14 @@ void plot2DXCanvas::drawRect(const QPoint &pixel,
     painter->save();
 
     painter->setPen(QPen(QBrush(painter->pen().brush()),1));
-    painter->drawRect(QRect(pixel.x()-width/2,pixel.y()-width/2,width,width));
+
+    QVector<QRect> rects;
+    rects.reserve(pixelList.size());
+
+    for ( const QPoint& pixel : pixelList )
+        rects.append(QRect(pixel.x()-width/2,pixel.y()-width/2,width,width));
+
+    painter->drawRects(rects);
 
     painter->restore();
 }
@@ -218,14 +556,10 @@ void plot2DXCanvas::drawRect(const QPoint &pixel,
 void plot2DXCanvas::drawLine(const QList<QPoint> &pixelList,
                                   QPainter *painter)
 {
-    QVector<QLineF> lineVec;
-    for ( int i = 0 ; i < pixelList.size() - 1 ; i ++ )
-        lineVec.append(QLineF(QPointF(pixelList.at(i)), QPointF(pixelList.at(i+1))));
-
-    painter->drawLines(lineVec);
+    painter->drawPolyline(QPolygon(pixelList.toVector()));
 }
 
-void plot2DXCanvas::drawCircle(const QPoint &pixel,
+void plot2DXCanvas::drawCircle(const QList<QPoint> &pixelList,
                                     QPainter *painter)
 {
     const int width = painter->pen().width();
@@ -233,71 +567,90 @@ void plot2DXCanvas::drawCircle(const QPoint &pixel,
     painter->save();
 
     painter->setPen(QPen(QBrush(painter->pen().brush()),1));
-    painter->drawEllipse(QRect(pixel.x()-width/2,pixel.y()-width/2,width,width));
+
+    QPainterPath path;
+
+    for ( const QPoint& pixel : pixelList )
+        path.addEllipse(QRect(pixel.x()-width/2,pixel.y()-width/2,width,width));
+
+    painter->drawPath(path);
 
     painter->restore();
 }
 
 void plot2DXCanvas::drawYLeftGrid(const QList<double> &yPxList, const QPen &pen)
 {
-    QPainter painter(pixmap());
+    QVector<QLine> lines;
+    lines.reserve(yPxList.size());
 
-    painter.setPen(pen);
-
-    for ( int i = 0 ; i < yPxList.size() ; ++i ){
-        const QPoint begin(0,yPxList[i]);
-        const QPoint end(pixmap()->width(),yPxList[i]);
-
-        painter.drawLine(begin,end);
-    }
+    for ( int i = 0 ; i < yPxList.size() ; ++i )
+        lines.append(QLine(0,yPxList[i],rect().width(),yPxList[i]));
 
-    update();
+    drawGrid(lines, pen);
 }
 
 void plot2DXCanvas::drawYRightGrid(const QList<double> &yPxList, const QPen &pen)
 {
-    QPainter painter(pixmap());
+    QVector<QLine> lines;
+    lines.reserve(yPxList.size());
 
-    painter.setPen(pen);
-
-    for ( int i = 0 ; i < yPxList.size() ; ++i ){
-        const QPoint begin(0,yPxList[i]);
-        const QPoint end(pixmap()->width(),yPxList[i]);
-
-        painter.drawLine(begin,end);
-    }
+    for ( int i = 0 ; i < yPxList.size() ; ++i )
+        lines.append(QLine(0,yPxList[i],rect().width(),yPxList[i]));
 
-    update();
+    drawGrid(lines, pen);
 }
 
 void plot2DXCanvas::drawXBottomGrid(const QList<double> &xPxList, const QPen &pen)
 {
-    QPainter painter(pixmap());
+    QVector<QLine> lines;
+    lines.reserve(xPxList.size());
 
-    painter.setPen(pen);
+    for ( int i = 0 ; i < xPxList.size() ; ++i )
+        lines.append(QLine(xPxList[i],0,xPxList[i],rect().height()));
 
-    for ( int i = 0 ; i < xPxList.size() ; ++i ){
-        const QPoint begin(xPxList[i],0);
-        const QPoint end(xPxList[i],pixmap()->height());
+    drawGrid(lines, pen);
+}
 
-        painter.drawLine(begin,end);
-    }
+void plot2DXCanvas::drawXTopGrid(const QList<double> &xPxList, const QPen &pen)
+{
+    QVector<QLine> lines;
+    lines.reserve(xPxList.size());
 
-    update();
+    for ( int i = 0 ; i < xPxList.size() ; ++i )
+        lines.append(QLine(xPxList[i],0,xPxList[i],rect().height()));
+
+    drawGrid(lines, pen);
 }
 
-void plot2DXCanvas::drawXTopGrid(const QList<double> &xPxList, const QPen &pen)
+void plot2DXCanvas::drawGrid(const QVector<QLine> &lines, const QPen &pen)
 {
-    QPainter painter(pixmap());
+    if ( isAsyncRendering() ){
+        //the grids are drawn again on each replot: a grid of the scene is recorded once
+        for ( const plot2DXGridSnapshot& grid : m_sceneGrids ){
+            if ( grid.lines == lines && grid.pen == pen )
+                return;
+        }
 
-    painter.setPen(pen);
+        plot2DXGridSnapshot grid;
 
-    for ( int i = 0 ; i < xPxList.size() ; ++i ){
-        const QPoint begin(xPxList[i],0);
-        const QPoint end(xPxList[i],pixmap()->height());
+        grid.lines = lines;
+        grid.pen = pen;
 
-        painter.drawLine(begin,end);
+        m_sceneGrids.append(grid);
+
+        invalidate();
+        return;
     }
 
-    update();
+    QPixmap *gridLayer = this->gridLayer();
+
+    if ( !gridLayer )
+        return;
+
+    QPainter painter(gridLayer);
+
+    painter.setPen(pen);
+    painter.drawLines(lines);
+
+    invalidate();
 }
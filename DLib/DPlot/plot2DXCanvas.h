@@ -37,8 +37,12 @@
 #include <QList>
 #include <QPoint>
 #include <QPixmap>
+#include <QImage>
+#include <QVector>
+#include <QThread>
 
 #include "plot2DXCurve.h"
+#include "plot2DXRenderer.h"
 
 class plot2DXCanvas : public QWidget
 {
@@ -47,32 +51,56 @@ class plot2DXCanvas : public QWidget
     Q_OBJECT
 public:
     plot2DXCanvas(QWidget *parent = 0);
+    virtual ~plot2DXCanvas();
 
 public slots:
     void setBackgroundColor(const QColor& color);
     void clear();
 
+    /* the layers are rasterized on a worker thread, the canvas shows the last completed frame */
+    void setAsyncRendering(bool on);
+
 signals:
     void canvasPropertyChanged();
 
 public:
     QColor getBackgroundColor() const;
-    void drawCurve(int curveWidth, const QColor &curveColor, plot2DXCurve::curveStyle style, const QList<QPoint> &pixelList);
+    bool isAsyncRendering() const;
+
+    /* curve layers: a layer is rasterized again only if its key changed */
+    bool hasCurveLayer(int layer, const plot2DXLayerKey& key) const;
+    void drawCurve(int layer, const plot2DXLayerKey& key, int curveWidth, const QColor &curveColor, plot2DXCurve::curveStyle style, const QList<QPoint> &pixelList);
+    void appendToCurve(int layer, int curveWidth, const QColor &curveColor, plot2DXCurve::curveStyle style, const QList<QPoint> &pixelList);
+
+    void clearGrid();
+
+    static void rasterizeCurve(QPaintDevice *device, int curveWidth, const QColor &curveColor, plot2DXCurve::curveStyle style, const QList<QPoint> &pixelList);
 
 protected:
     virtual void paintEvent(QPaintEvent *event);
 
 private:
     QPixmap* pixmap();
+    QPixmap* layer(int layer);
+    QPixmap* gridLayer();
+
+    void invalidate();
+    void compose();
+
+    void drawGrid(const QVector<QLine>& lines, const QPen& pen);
+    plot2DXLayerSnapshot* sceneLayer(int layer);
+
+    static void drawPoints(const QList<QPoint>& pixelList, QPainter* painter);
+    static void drawCross(const QList<QPoint>& pixelList, QPainter* painter);
+    static void drawRect(const QList<QPoint>& pixelList, QPainter* painter);
+    static void drawLine(const QList<QPoint>& pixelList, QPainter* painter);
+    static void drawCircle(const QList<QPoint>& pixelList, QPainter* painter);
 
 private slots:
     void shiftPixmap(int shift);
 
-    void drawPoints(const QPoint& pixel, QPainter* painter);
-    void drawCross(const QPoint& pixel, QPainter* painter);
-    void drawRect(const QPoint& pixel, QPainter* painter);
-    void drawLine(const QList<QPoint>& pixelList, QPainter* painter);
-    void drawCircle(const QPoint& pixel, QPainter* painter);
+    void requestFrame();
+    void frameReady(int generation, const QImage& frame);
 
     void drawYLeftGrid(const QList<double>& yPxList, const QPen& pen);
     void drawYRightGrid(const QList<double>& yPxList, const QPen& pen);
@@ -80,8 +108,29 @@ private slots:
     void drawXTopGrid(const QList<double>& xPxList, const QPen &pen);
 
 private:
-    QPixmap m_canvasPixmap;
+    QPixmap m_canvasPixmap; /* composition of the layers (shown) */
+    QPixmap m_gridPixmap;
+    QVector<QPixmap> m_curveLayers; /* transparent, one per curve */
+    QVector<plot2DXLayerKey> m_curveLayerKeys;
+    QVector<bool> m_curveLayerValid;
+
+    bool m_composeNeeded;
+
     QColor m_bgdColor;
+
+    /* asynchronous rendering: scene (GUI thread) => renderer (worker thread) => frame */
+    bool m_asyncRendering;
+    bool m_frameRequested;
+    int m_generation;
+    int m_layerRevision;
+
+    QList<plot2DXGridSnapshot> m_sceneGrids;
+    QVector<plot2DXLayerSnapshot> m_sceneLayers;
+
+    QImage m_frame;
+
+    plot2DXRenderer *m_renderer;
+    QThread *m_renderThread;
 };
 
 #endif // PLOT2DXCANVAS_H
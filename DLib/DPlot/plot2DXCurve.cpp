@@ -48,7 +48,9 @@ plot2DXCurve::plot2DXCurve() :
     x_min(INT_MAX),
     y_min(INT_MAX),
     x_max(-INT_MAX),
-    y_max(-INT_MAX){}
+    y_max(-INT_MAX),
+    m_revision(0),
+    m_pixelCacheValid(false){}
 
 plot2DXCurve::~plot2DXCurve()
 {
@@ -102,11 +104,88 @@ void plot2DXCurve::addData(const QList<QPointF> &dataset)
     m_cache.append(dataset);
 }
 
+void plot2DXCurve::addData(const double *x_values, const double *y_values, int count)
+{
+    if ( !x_values || !y_values || count <= 0 )
+        return;
+
+    m_cache.reserve(m_cache.size() + count);
+
+    for ( int i = 0 ; i < count ; ++ i )
+        m_cache.append(QPointF(x_values[i], y_values[i]));
+}
+
+//replaces the data from index 'from' on (e.g. a growing spectrum): appended values are drawn on the next replot,
+//changed values of the container lead to a complete redraw of the curve
+void plot2DXCurve::updateData(int from, const double *x_values, const double *y_values, int count)
+{
+    if ( from < 0 || !x_values || !y_values || count < 0 )
+        return;
+
+    //1. appended only:
+    if ( from == m_dataContainer.size() + m_cache.size() ){
+        addData(x_values, y_values, count);
+        return;
+    }
+
+    //2. replace the container from 'from' on:
+    swapToContainer();
+
+    from = qMin(from, m_dataContainer.size());
+
+    m_dataContainer.erase(m_dataContainer.begin() + from, m_dataContainer.end());
+    m_dataContainer.reserve(from + count);
+
+    bool extremeValue = false;
+
+    for ( int i = 0 ; i < count ; ++i ){
+        const QPointF value(x_values[i], y_values[i]);
+
+        if ( value.x() < x_min ){
+            x_min = value.x();
+            extremeValue = true;
+        }
+        else if ( value.x() > x_max ){
+            x_max = value.x();
+            extremeValue = true;
+        }
+
+        if ( value.y() < y_min ){
+            y_min = value.y();
+            extremeValue = true;
+        }
+        else if ( value.y() > y_max ){
+            y_max = value.y();
+            extremeValue = true;
+        }
+
+        m_dataContainer.append(value);
+    }
+
+    if ( extremeValue )
+        emit maxValueChanged(x_min,y_min,x_max,y_max,getAxis());
+
+    //reduce container to limit:
+    while ( m_dataContainer.size() > m_maxCount ){
+        m_dataContainer.removeFirst();
+    };
+
+    m_revision ++;
+    m_pixelCacheValid = false;
+    m_pixelCache.clear();
+
+    emit curvePropertyChanged();
+}
+
 void plot2DXCurve::clearCurveContent()
 {
     m_dataContainer.clear();
     m_cache.clear();
 
+    m_revision ++;
+    m_pixelCacheValid = false;
+    m_pixelCache.clear();
+
     emit curvePropertyChanged();
 }
 
@@ -122,6 +201,8 @@ void plot2DXCurve::clearCurveContent(int from, int to)
         m_dataContainer.removeAt(i);
     }
 
+    m_revision ++;
+
     emit curvePropertyChanged();
 }
 
@@ -203,6 +284,8 @@ void plot2DXCurve::swapToContainer()
         m_dataContainer.removeFirst();
     };
 
+    m_revision ++;
+
     //clear cache:
     reset();
 }
@@ -38,6 +38,42 @@
 #include <QPoint>
 #include <QRectF>
 
+/* axis state a pixel list was computed for (see plot2DXWidget::pixelList(...)) */
+typedef struct plot2DXPixelCacheKey {
+    double xMin, xMax;
+    double yMin, yMax;
+
+    int xScaling, yScaling;
+    int width, height; /* canvas */
+
+    int style;
+    int revision; /* data container */
+
+    bool operator==(const plot2DXPixelCacheKey& other) const {
+        return xMin == other.xMin && xMax == other.xMax
+                && yMin == other.yMin && yMax == other.yMax
+                && xScaling == other.xScaling && yScaling == other.yScaling
+                && width == other.width && height == other.height
+                && style == other.style && revision == other.revision;
+    }
+} plot2DXPixelCacheKey;
+
+/* state a curve layer of the canvas was rasterized for (see plot2DXCanvas::hasCurveLayer(...)) */
+typedef struct plot2DXLayerKey {
+    plot2DXPixelCacheKey pixels;
+
+    QRgb color;
+    int width;
+    bool shown;
+
+    bool operator==(const plot2DXLayerKey& other) const {
+        return pixels == other.pixels
+                && color == other.color
+                && width == other.width
+                && shown == other.shown;
+    }
+} plot2DXLayerKey;
+
 class plot2DXCurve : QObject
 {
     friend class plot2DXWidget;
@@ -71,6 +107,8 @@ public slots:
 
     void addData(double x_value, double y_value);
     void addData(const QList<QPointF> &dataset);
+    void addData(const double *x_values, const double *y_values, int count);
+    void updateData(int from, const double *x_values, const double *y_values, int count);
 
     void clearCurveContent();
     void clearCurveContent(int from, int to);
@@ -123,6 +161,13 @@ private:
 
     double x_min, x_max;
     double y_min, y_max;
+
+    int m_revision; /* incremented on each change of the data container */
+
+    /* decimated pixel list of the data container (valid for m_pixelCacheKey) */
+    QList<QPoint> m_pixelCache;
+    plot2DXPixelCacheKey m_pixelCacheKey;
+    bool m_pixelCacheValid;
 };
 
 #endif // PLOT2DXCURVE_H
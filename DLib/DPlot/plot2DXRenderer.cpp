@@ -0,0 +1,132 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+#include "plot2DXRenderer.h"
+#include "plot2DXCanvas.h"
+
+#include <QPainter>
+
+#ifdef QT_DEBUG
+#include <QDebug>
+#endif
+
+plot2DXRenderer::plot2DXRenderer() :
+    QObject()
+{
+    qRegisterMetaType<QImage>("QImage");
+}
+
+plot2DXRenderer::~plot2DXRenderer() {}
+
+void plot2DXRenderer::requestFrame(const plot2DXScene &scene)
+{
+    //wake up the render thread if it is idle, otherwise the scene is picked up by its running loop:
+    if ( m_scene.post(scene, scene.generation) )
+        QMetaObject::invokeMethod(this, "processRequests", Qt::QueuedConnection);
+}
+
+int plot2DXRenderer::latestGeneration() const
+{
+    return m_scene.latestGeneration();
+}
+
+void plot2DXRenderer::processRequests()
+{
+    plot2DXScene scene;
+
+    while ( m_scene.take(&scene) ){
+        const QImage frame = render(scene);
+
+        //the canvas has moved on while this frame was painted:
+        if ( m_scene.isStale(scene.generation) ){
+#ifdef __PLOT_RENDER_DEBUG
+            qDebug() << "render: frame " << scene.generation << " dropped";
+#endif
+            continue;
+        }
+
+        emit frameReady(scene.generation, frame);
+    }
+}
+
+QImage plot2DXRenderer::render(const plot2DXScene &scene)
+{
+    if ( scene.size.isEmpty() )
+        return QImage();
+
+    //1. rasterize the changed curve layers:
+    if ( m_layers.size() < scene.layers.size() ){
+        m_layers.resize(scene.layers.size());
+        m_layerRevisions.resize(scene.layers.size());
+    }
+
+    for ( int i = 0 ; i < scene.layers.size() ; ++i ){
+        const plot2DXLayerSnapshot& layer = scene.layers.at(i);
+
+        if ( layer.pixelList.isEmpty() ){
+            m_layers[i] = QImage();
+            m_layerRevisions[i] = layer.revision;
+
+            continue;
+        }
+
+        if ( m_layerRevisions.at(i) == layer.revision
+             && m_layers.at(i).size() == scene.size )
+            continue;
+
+        QImage image(scene.size, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+
+        plot2DXCanvas::rasterizeCurve(&image, layer.width, layer.color, layer.style, layer.pixelList);
+
+        m_layers[i] = image;
+        m_layerRevisions[i] = layer.revision;
+    }
+
+    //2. compose the frame: background => grid => curve 0 ... curve n
+    QImage frame(scene.size, QImage::Format_ARGB32_Premultiplied);
+    frame.fill(scene.background);
+
+    QPainter painter(&frame);
+
+    for ( const plot2DXGridSnapshot& grid : scene.grids ){
+        painter.setPen(grid.pen);
+        painter.drawLines(grid.lines);
+    }
+
+    for ( int i = 0 ; i < scene.layers.size() ; ++i ){
+        if ( m_layers.at(i).isNull() )
+            continue;
+
+        painter.drawImage(0,0,m_layers.at(i));
+    }
+
+    painter.end();
+
+    return frame;
+}
@@ -0,0 +1,117 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+#ifndef PLOT2DXRENDERER_H
+#define PLOT2DXRENDERER_H
+
+#include <QObject>
+#include <QImage>
+#include <QColor>
+#include <QPen>
+#include <QList>
+#include <QVector>
+#include <QLine>
+#include <QPoint>
+#include <QSize>
+#include <QMetaType>
+
+#include "plot2DXCurve.h"
+
+#include "../DTypes/latestrequest.h"
+
+//#define __PLOT_RENDER_DEBUG
+
+/* curve layer of a scene */
+typedef struct {
+    int revision; /* unique: changes with each change of the layer (pixels or pen) */
+
+    int width;
+    QColor color;
+    plot2DXCurve::curveStyle style;
+
+    QList<QPoint> pixelList; /* implicitly shared with the canvas (empty: nothing to draw) */
+} plot2DXLayerSnapshot;
+
+/* grid lines of a scene */
+typedef struct {
+    QVector<QLine> lines;
+    QPen pen;
+} plot2DXGridSnapshot;
+
+/* immutable snapshot of the canvas (taken on the GUI thread) */
+typedef struct {
+    int generation;
+
+    QSize size;
+    QColor background;
+
+    QList<plot2DXGridSnapshot> grids;
+    QVector<plot2DXLayerSnapshot> layers; /* index: curve */
+} plot2DXScene;
+
+/*
+ * plot2DXRenderer - rasterization of the canvas off the GUI thread:
+ *-----------------------------------------------------------------
+ *
+ * The canvas hands a snapshot of its grids and curve layers to requestFrame(...) on each replot. Only the newest snapshot
+ * matters for the screen, so intermediate scenes are skipped (DLatestRequest) and a frame is thrown away if a newer scene was
+ * requested while it was painted. Curve layers are painted into images of their own which survive across frames: a frame only
+ * repaints the layers whose revision has changed and composes the rest.
+ */
+
+class plot2DXRenderer : public QObject
+{
+    Q_OBJECT
+public:
+    plot2DXRenderer();
+    virtual ~plot2DXRenderer();
+
+    /* thread-safe */
+    void requestFrame(const plot2DXScene& scene);
+
+    /* generation of the latest scene */
+    int latestGeneration() const;
+
+signals:
+    void frameReady(int generation, const QImage& frame);
+
+private slots:
+    void processRequests();
+
+private:
+    QImage render(const plot2DXScene& scene);
+
+private:
+    DLatestRequest<plot2DXScene> m_scene;
+
+    /* owned by the render thread */
+    QVector<QImage> m_layers;
+    QVector<int> m_layerRevisions;
+};
+
+#endif // PLOT2DXRENDERER_H
@@ -230,7 +230,8 @@ void plot2DXWidget::replot()
         //1. get the new scaling-list of curve-object´s cache-list:
         for ( int index = 0 ; index < MAX_CURVE_NUMBER ; index ++ ){
             QList<QPoint> cachePixelList = pixelList(curve().at(index)->getCache(),
-                                                     curve().at(index)->getAxis());
+                                                     curve().at(index)->getAxis(),
+                                                     curve().at(index)->getCurveStyle());
 
 
             if ( cachePixelList.isEmpty() )
@@ -292,7 +293,8 @@ void plot2DXWidget::replot()
 
 
             //3.b) append new curve-value:
-            canvas()->drawCurve(curve().at(index)->getCurveWidth(),
+            canvas()->appendToCurve(index,
+                                curve().at(index)->getCurveWidth(),
                                 curve().at(index)->getCurveColor(),
                                 curve().at(index)->getCurveStyle(),
                                 cachePixelList);
@@ -351,7 +353,8 @@ void plot2DXWidget::replot()
         for ( int index = 0 ; index < MAX_CURVE_NUMBER ; index ++ ){
 
             QList<QPoint> cachePixelList = pixelList(curve().at(index)->getCache(),
-                                                     curve().at(index)->getAxis());
+                                                     curve().at(index)->getAxis(),
+                                                     curve().at(index)->getCurveStyle());
 
             if ( cachePixelList.isEmpty() ){
                 //6.1. swap the cache-list to the container:
@@ -361,7 +364,8 @@ void plot2DXWidget::replot()
                     continue;
 
                 //6.2. append new curve-value:
-                canvas()->drawCurve(curve().at(index)->getCurveWidth(),
+                canvas()->appendToCurve(index,
+                                    curve().at(index)->getCurveWidth(),
                                     curve().at(index)->getCurveColor(),
                                     curve().at(index)->getCurveStyle(),
                                     cachePixelList);
@@ -451,7 +455,8 @@ void plot2DXWidget::replot()
                 continue;
 
             //8. append new curve-value:
-            canvas()->drawCurve(curve().at(index)->getCurveWidth(),
+            canvas()->appendToCurve(index,
+                                curve().at(index)->getCurveWidth(),
                                 curve().at(index)->getCurveColor(),
                                 curve().at(index)->getCurveStyle(),
                                 cachePixelList);
@@ -461,8 +466,8 @@ void plot2DXWidget::replot()
 
 void plot2DXWidget::updatePlotView()
 {
-    //1. clear canvas:
-    canvas()->clear();
+    //1. clear the grid-layer (the curve-layers are kept as long as they are up to date):
+    canvas()->clearGrid();
 
     //2.a) draw the grids at first to set it on the background of the curves:
     if ( isYLeftGridShown() && yLeft()->isVisible() ){
@@ -531,18 +536,23 @@ void plot2DXWidget::updatePlotView()
     }
 
 
-    //2.b) get new scaling of each curve
+    //2.b) get new scaling of each changed curve
     for ( int i = 0 ; i < MAX_CURVE_NUMBER ; ++i ){
 
-        //check wether curve is set visible:
-        if ( !curve().at(i)->isCurveShown() )
+        const plot2DXLayerKey key = layerKey(curve().at(i));
+
+        //curve-layer is up to date:
+        if ( canvas()->hasCurveLayer(i, key) )
             continue;
 
 
-        const QList<QPoint> clippingList = pixelList(curve().at(i));
+        //check wether curve is set visible:
+        const QList<QPoint> clippingList = curve().at(i)->isCurveShown()?pixelList(curve().at(i)):QList<QPoint>();
 
-        //3) repaint the canvas with new data
-        canvas()->drawCurve(curve().at(i)->getCurveWidth(),
+        //3) rasterize the curve-layer with new data
+        canvas()->drawCurve(i,
+                            key,
+                            curve().at(i)->getCurveWidth(),
                             curve().at(i)->getCurveColor(),
                             curve().at(i)->getCurveStyle(),
                             clippingList
@@ -555,6 +565,17 @@ void plot2DXWidget::enableReplot(bool on)
     m_replotEnabled = on;
 }
 
+void plot2DXWidget::setAsyncRendering(bool on)
+{
+    if ( isAsyncRendering() == on )
+        return;
+
+    //the canvas drops its layers on switching the mode:
+    canvas()->setAsyncRendering(on);
+
+    replot();
+}
+
 void plot2DXWidget::setBackgroundColor(const QColor &color)
 {
     m_bgrdColor = color;
@@ -663,246 +684,204 @@ void plot2DXWidget::paintEvent(QPaintEvent *event)
 
 QList<QPoint> plot2DXWidget::pixelList(plot2DXCurve *curve)
 {
-    QList<QPoint> pixelList;
+    const plot2DXPixelCacheKey key = pixelCacheKey(curve);
 
-    switch (curve->getAxis()){
+    //unchanged data and axes: reuse the decimated pixel list:
+    if ( curve->m_pixelCacheValid && curve->m_pixelCacheKey == key )
+        return curve->m_pixelCache;
 
-    case plot2DXCurve::yLeft_xBottom:
-    {
-        const double minXValue = xBottom()->getAxisMinValue();
-        const double maxXValue = xBottom()->getAxisMaxValue();
-        const double minYValue = yLeft()->getAxisMinValue();
-        const double maxYValue = yLeft()->getAxisMaxValue();
+    const QList<QPoint> pixelList = decimate(transform(curve->m_dataContainer, curve->getAxis()), curve->getCurveStyle());
 
-        for ( int i = 0 ; i < curve->getData().size() ; i ++ ){
-
-            const QPointF iterValue = curve->getData().at(i);
-
-            //point inside canvas?:
-            if ( !insideCanvas(iterValue,minXValue,maxXValue,minYValue,maxYValue) )
-                continue;
-
-            const QPoint pxPoint(xBottom()->ConvertToPixel(iterValue.x(),
-                                                           xBottom()->getAxisScaling()), //x-value
-
-                                 yLeft()->ConvertToPixel(iterValue.y(),
-                                                         yLeft()->getAxisScaling() )); //y-value
-
-            pixelList.append(pxPoint);
-        }
-    }
-        break;
-
-
-    case plot2DXCurve::yLeft_xTop:
-    {
-        const double minXValue = xTop()->getAxisMinValue();
-        const double maxXValue = xTop()->getAxisMaxValue();
-        const double minYValue = yLeft()->getAxisMinValue();
-        const double maxYValue = yLeft()->getAxisMaxValue();
+    curve->m_pixelCache = pixelList;
+    curve->m_pixelCacheKey = key;
+    curve->m_pixelCacheValid = true;
 
-        for ( int i = 0 ; i < curve->getData().size() ; i ++ ){
-
-            const QPointF iterValue = curve->getData().at(i);
+    return pixelList;
+}
 
-            //point inside canvas?:
-            if ( !insideCanvas(iterValue,minXValue,maxXValue,minYValue,maxYValue) )
-                continue;
+QList<QPoint> plot2DXWidget::pixelList(const QList<QPointF> &curve,
+                                          plot2DXCurve::scaleAxis axis,
+                                          plot2DXCurve::curveStyle style)
+{
+    return decimate(transform(curve, axis), style);
+}
 
-            const QPoint pxPoint(xTop()->ConvertToPixel(iterValue.x(),
-                                                        xTop()->getAxisScaling()), //x-value
+void plot2DXWidget::axesOf(plot2DXCurve::scaleAxis axis, plot2DXAxis **xAxis, plot2DXAxis **yAxis) const
+{
+    const bool bottom = (axis == plot2DXCurve::yLeft_xBottom || axis == plot2DXCurve::yRight_xBottom);
+    const bool left = (axis == plot2DXCurve::yLeft_xBottom || axis == plot2DXCurve::yLeft_xTop);
 
-                                 yLeft()->ConvertToPixel(iterValue.y(),
-                                                         yLeft()->getAxisScaling() )); //y-value
+    *xAxis = bottom?xBottom():xTop();
+    *yAxis = left?yLeft():yRight();
+}
 
-            pixelList.append(pxPoint);
-        }
-    }
-        break;
+QList<QPoint> plot2DXWidget::transform(const QList<QPointF> &curve, plot2DXCurve::scaleAxis axis)
+{
+    QList<QPoint> pixelList;
 
+    if ( curve.isEmpty() )
+        return pixelList;
 
-    case plot2DXCurve::yRight_xBottom:
-    {
-        const double minXValue = xBottom()->getAxisMinValue();
-        const double maxXValue = xBottom()->getAxisMaxValue();
-        const double minYValue = yRight()->getAxisMinValue();
-        const double maxYValue = yRight()->getAxisMaxValue();
+    plot2DXAxis *xAxis = nullptr;
+    plot2DXAxis *yAxis = nullptr;
 
-        for ( int i = 0 ; i < curve->getData().size() ; i ++ ){
+    axesOf(axis, &xAxis, &yAxis);
 
-            const QPointF iterValue = curve->getData().at(i);
+    const double minXValue = xAxis->getAxisMinValue();
+    const double maxXValue = xAxis->getAxisMaxValue();
+    const double minYValue = yAxis->getAxisMinValue();
+    const double maxYValue = yAxis->getAxisMaxValue();
 
-            //point inside canvas?:
-            if ( !insideCanvas(iterValue,minXValue,maxXValue,minYValue,maxYValue) )
-                continue;
+    //1. collect the points inside the canvas:
+    QVector<double> xValues;
+    QVector<double> yValues;
 
-            const QPoint pxPoint(xBottom()->ConvertToPixel(iterValue.x(),
-                                                           xBottom()->getAxisScaling()), //x-value
+    xValues.reserve(curve.size());
+    yValues.reserve(curve.size());
 
-                                 yRight()->ConvertToPixel(iterValue.y(),
-                                                          yRight()->getAxisScaling() )); //y-value
+    for ( const QPointF& point : curve ){
+        if ( !insideCanvas(point,minXValue,maxXValue,minYValue,maxYValue) )
+            continue;
 
-            pixelList.append(pxPoint);
-        }
+        xValues.append(point.x());
+        yValues.append(point.y());
     }
-        break;
-
-
-    case plot2DXCurve::yRight_xTop:
-    {
-        const double minXValue = xTop()->getAxisMinValue();
-        const double maxXValue = xTop()->getAxisMaxValue();
-        const double minYValue = yRight()->getAxisMinValue();
-        const double maxYValue = yRight()->getAxisMaxValue();
-
-        for ( int i = 0 ; i < curve->getData().size() ; i ++ ){
-
-            const QPointF iterValue = curve->getData().at(i);
 
-            //point inside canvas?:
-            if ( !insideCanvas(iterValue,minXValue,maxXValue,minYValue,maxYValue) )
-                continue;
-
-            const QPoint pxPoint(xTop()->ConvertToPixel(iterValue.x(),
-                                                        xTop()->getAxisScaling()), //x-value
+    const int count = xValues.size();
 
-                                 yRight()->ConvertToPixel(iterValue.y(),
-                                                          yRight()->getAxisScaling() )); //y-value
+    if ( count == 0 )
+        return pixelList;
 
-            pixelList.append(pxPoint);
-        }
-    }
-        break;
+    //2. convert them as a batch (the scaling is evaluated once per axis):
+    QVector<int> xPixels(count);
+    QVector<int> yPixels(count);
 
+    xAxis->ConvertToPixel(xValues.constData(), count, xPixels.data(), xAxis->getAxisScaling());
+    yAxis->ConvertToPixel(yValues.constData(), count, yPixels.data(), yAxis->getAxisScaling());
 
-    default:
-        break;
-    }
+    pixelList.reserve(count);
 
+    for ( int i = 0 ; i < count ; ++ i )
+        pixelList.append(QPoint(xPixels.at(i), yPixels.at(i)));
 
     return pixelList;
 }
 
-QList<QPoint> plot2DXWidget::pixelList(const QList<QPointF> &curve,
-                                          plot2DXCurve::scaleAxis axis)
+plot2DXPixelCacheKey plot2DXWidget::pixelCacheKey(plot2DXCurve *curve)
 {
-    QList<QPoint> pixelList;
-
-    switch (axis){
-
-    case plot2DXCurve::yLeft_xBottom:
-    {
-        const double minXValue = xBottom()->getAxisMinValue();
-        const double maxXValue = xBottom()->getAxisMaxValue();
-        const double minYValue = yLeft()->getAxisMinValue();
-        const double maxYValue = yLeft()->getAxisMaxValue();
-
-        for ( int i = 0 ; i < curve.size() ; i ++ ){
+    plot2DXAxis *xAxis = nullptr;
+    plot2DXAxis *yAxis = nullptr;
 
-            const QPointF iterValue = curve.at(i);
+    axesOf(curve->getAxis(), &xAxis, &yAxis);
 
-            //point inside canvas?:
-            if ( !insideCanvas(iterValue,minXValue,maxXValue,minYValue,maxYValue) )
-                continue;
+    plot2DXPixelCacheKey key;
 
-            const QPoint pxPoint(xBottom()->ConvertToPixel(iterValue.x(),
-                                                           xBottom()->getAxisScaling()), //x-value
+    key.xMin = xAxis->getAxisMinValue();
+    key.xMax = xAxis->getAxisMaxValue();
+    key.yMin = yAxis->getAxisMinValue();
+    key.yMax = yAxis->getAxisMaxValue();
+    key.xScaling = (int)xAxis->getAxisScaling();
+    key.yScaling = (int)yAxis->getAxisScaling();
+    key.width = m_canvasRect.width();
+    key.height = m_canvasRect.height();
+    key.style = (int)curve->getCurveStyle();
+    key.revision = curve->m_revision;
 
-                                 yLeft()->ConvertToPixel(iterValue.y(),
-                                                         yLeft()->getAxisScaling() )); //y-value
-
-            pixelList.append(pxPoint);
-        }
-    }
-        break;
-
-
-    case plot2DXCurve::yLeft_xTop:
-    {
-        const double minXValue = xTop()->getAxisMinValue();
-        const double maxXValue = xTop()->getAxisMaxValue();
-        const double minYValue = yLeft()->getAxisMinValue();
-        const double maxYValue = yLeft()->getAxisMaxValue();
+    return key;
+}
 
-        for ( int i = 0 ; i < curve.size() ; i ++ ){
+plot2DXLayerKey plot2DXWidget::layerKey(plot2DXCurve *curve)
+{
+    plot2DXLayerKey key;
 
-            const QPointF iterValue = curve.at(i);
+    key.pixels = pixelCacheKey(curve);
+    key.color = curve->getCurveColor().rgba();
+    key.width = curve->getCurveWidth();
+    key.shown = curve->isCurveShown();
 
-            //point inside canvas?:
-            if ( !insideCanvas(iterValue,minXValue,maxXValue,minYValue,maxYValue) )
-                continue;
+    return key;
+}
 
-            const QPoint pxPoint(xBottom()->ConvertToPixel(iterValue.x(),
-                                                           xTop()->getAxisScaling()),    //x-value
+QList<QPoint> plot2DXWidget::decimate(const QList<QPoint> &pixelList, plot2DXCurve::curveStyle style)
+{
+    /**
+      **********************************************
+      level of detail: the points falling into the
+      same pixel column are reduced to their visual
+      envelope, so the count of drawn points is
+      bounded by the canvas width (not the data):
+
+      line:    first, minimum, maximum and last point
+               of the column (in order of occurrence)
+      markers: each covered pixel once
+      **********************************************
+      */
+    if ( pixelList.size() < 3 )
+        return pixelList;
 
-                                 yLeft()->ConvertToPixel(iterValue.y(),
-                                                         yLeft()->getAxisScaling() )); //y-value
+    QList<QPoint> decimatedList;
+    decimatedList.reserve(pixelList.size());
 
-            pixelList.append(pxPoint);
-        }
-    }
-        break;
+    if ( style == plot2DXCurve::line ){
+        int columnStart = 0;
 
+        while ( columnStart < pixelList.size() ){
+            const int x = pixelList.at(columnStart).x();
 
-    case plot2DXCurve::yRight_xBottom:
-    {
-        const double minXValue = xBottom()->getAxisMinValue();
-        const double maxXValue = xBottom()->getAxisMaxValue();
-        const double minYValue = yRight()->getAxisMinValue();
-        const double maxYValue = yRight()->getAxisMaxValue();
+            int columnEnd = columnStart + 1;
+            int minIndex = columnStart;
+            int maxIndex = columnStart;
 
-        for ( int i = 0 ; i < curve.size() ; i ++ ){
+            while ( columnEnd < pixelList.size() && pixelList.at(columnEnd).x() == x ){
+                if ( pixelList.at(columnEnd).y() < pixelList.at(minIndex).y() )
+                    minIndex = columnEnd;
+                if ( pixelList.at(columnEnd).y() > pixelList.at(maxIndex).y() )
+                    maxIndex = columnEnd;
 
-            const QPointF iterValue = curve.at(i);
+                columnEnd ++;
+            }
 
-            //point inside canvas?:
-            if ( !insideCanvas(iterValue,minXValue,maxXValue,minYValue,maxYValue) )
-                continue;
+            const int indices[4] = { columnStart, qMin(minIndex, maxIndex), qMax(minIndex, maxIndex), columnEnd - 1 };
 
-            const QPoint pxPoint(xBottom()->ConvertToPixel(iterValue.x(),
-                                                           xBottom()->getAxisScaling()),  //x-value
+            for ( int i = 0 ; i < 4 ; ++ i ){
+                if ( i > 0 && indices[i] == indices[i - 1] )
+                    continue;
 
-                                 yRight()->ConvertToPixel(iterValue.y(),
-                                                          yRight()->getAxisScaling() )); //y-value
+                decimatedList.append(pixelList.at(indices[i]));
+            }
 
-            pixelList.append(pxPoint);
+            columnStart = columnEnd;
         }
     }
-        break;
+    else{
+        int maxY = 0;
 
+        for ( int i = 0 ; i < pixelList.size() ; ++ i )
+            maxY = qMax(maxY, pixelList.at(i).y());
 
-    case plot2DXCurve::yRight_xTop:
-    {
-        const double minXValue = xTop()->getAxisMinValue();
-        const double maxXValue = xTop()->getAxisMaxValue();
-        const double minYValue = yRight()->getAxisMinValue();
-        const double maxYValue = yRight()->getAxisMaxValue();
+        //column in which a pixel row was covered last:
+        QVector<int> coveredInColumn(maxY + 1, -1);
 
-        for ( int i = 0 ; i < curve.size() ; i ++ ){
+        int column = 0;
 
-            const QPointF iterValue = curve.at(i);
+        for ( int i = 0 ; i < pixelList.size() ; ++ i ){
+            const QPoint point = pixelList.at(i);
 
-            //point inside canvas?:
-            if ( !insideCanvas(iterValue,minXValue,maxXValue,minYValue,maxYValue) )
-                continue;
+            if ( i > 0 && point.x() != pixelList.at(i - 1).x() )
+                column ++;
 
-            const QPoint pxPoint(xTop()->ConvertToPixel(iterValue.x(),
-                                                        xTop()->getAxisScaling()),     //x-value
+            if ( point.y() >= 0 ){
+                if ( coveredInColumn.at(point.y()) == column )
+                    continue;
 
-                                 yRight()->ConvertToPixel(iterValue.y(),
-                                                          yRight()->getAxisScaling() )); //y-value
+                coveredInColumn[point.y()] = column;
+            }
 
-            pixelList.append(pxPoint);
+            decimatedList.append(point);
         }
     }
-        break;
-
-    default:
-        break;
-    }
 
-
-    return pixelList;
+    return decimatedList;
 }
 
 bool plot2DXWidget::insideCanvas(const QPointF &point,
@@ -973,6 +952,11 @@ bool plot2DXWidget::isReplotEnabled() const
     return m_replotEnabled;
 }
 
+bool plot2DXWidget::isAsyncRendering() const
+{
+    return canvas()->isAsyncRendering();
+}
+
 bool plot2DXWidget::isYLeftGridShown() const
 {
     return m_yLeftGridShown;
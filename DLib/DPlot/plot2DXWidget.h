@@ -34,6 +34,7 @@
 #include <QColor>
 #include <QRect>
 #include <QList>
+#include <QVector>
 #include <QPoint>
 #include <QPointF>
 #include <QString>
@@ -66,6 +67,7 @@ public slots:
     virtual void updatePlotView();
 
     void enableReplot(bool on);
+    void setAsyncRendering(bool on);
     void setBackgroundColor(const QColor& color);
 
     void showYLeftGrid(bool on);
@@ -89,7 +91,14 @@ private:
     plot2DXCanvas *canvas() const;
 
     QList<QPoint> pixelList(plot2DXCurve* curve);
-    QList<QPoint> pixelList(const QList<QPointF> &curve, plot2DXCurve::scaleAxis axis);
+    QList<QPoint> pixelList(const QList<QPointF> &curve, plot2DXCurve::scaleAxis axis, plot2DXCurve::curveStyle style);
+
+    void axesOf(plot2DXCurve::scaleAxis axis, plot2DXAxis **xAxis, plot2DXAxis **yAxis) const;
+    QList<QPoint> transform(const QList<QPointF> &curve, plot2DXCurve::scaleAxis axis);
+
+    plot2DXPixelCacheKey pixelCacheKey(plot2DXCurve* curve);
+    plot2DXLayerKey layerKey(plot2DXCurve* curve);
+    static QList<QPoint> decimate(const QList<QPoint>& pixelList, plot2DXCurve::curveStyle style);
 
     bool insideCanvas(const QPointF& point, double xMin, double xMax, double yMin, double yMax);
     double getMaximumXValue(const QList<QPointF>& valueList);
@@ -104,6 +113,7 @@ public:
 
     QColor getBackgroundColor() const;
     bool isReplotEnabled() const;
+    bool isAsyncRendering() const;
 
     bool isYLeftGridShown() const;
     bool isYRightGridShown() const;
@@ -0,0 +1,105 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+
+#ifndef DLATESTREQUEST_H
+#define DLATESTREQUEST_H
+
+#include <QMutex>
+#include <QMutexLocker>
+
+/*
+ * DLatestRequest - pending slot of a worker fed at any rate by another thread:
+ *-----------------------------------------------------------------------------
+ *
+ * post(...) replaces the pending request (latest wins) and tells the caller whether the worker has to be woken up: only the
+ * first post(...) after the worker went idle does, all further requests are picked up by the same wake-up. The worker calls
+ * take(...) until it returns false and compares the generation of its result with latestGeneration() to drop stale results.
+ */
+
+template<typename T> class DLatestRequest
+{
+    T m_pending;
+    bool m_hasPending;
+    bool m_scheduled;
+    int m_latestGeneration;
+
+    mutable QMutex m_mutex;
+
+public:
+    inline DLatestRequest<T>() :
+        m_hasPending(false),
+        m_scheduled(false),
+        m_latestGeneration(0) {}
+
+    /* true: the worker is idle and has to be scheduled (e.g. by a queued call) */
+    inline bool post(const T& request, int generation)
+    {
+        QMutexLocker locker(&m_mutex);
+
+        m_pending = request;
+        m_hasPending = true;
+        m_latestGeneration = generation;
+
+        if ( m_scheduled )
+            return false;
+
+        m_scheduled = true;
+        return true;
+    }
+
+    /* false: nothing pending, the worker is idle again */
+    inline bool take(T *request)
+    {
+        QMutexLocker locker(&m_mutex);
+
+        if ( !m_hasPending ) {
+            m_scheduled = false;
+            return false;
+        }
+
+        *request = m_pending;
+        m_hasPending = false;
+
+        return true;
+    }
+
+    inline int latestGeneration() const
+    {
+        QMutexLocker locker(&m_mutex);
+
+        return m_latestGeneration;
+    }
+
+    inline bool isStale(int generation) const
+    {
+        return (latestGeneration() != generation);
+    }
+};
+
+#endif // DLATESTREQUEST_H
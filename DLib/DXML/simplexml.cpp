@@ -39,6 +39,200 @@ QString getTabJumpString(int cnt)
     return tabString;
 }
 
+int getShortestDoubleString(double value, char *buffer)
+{
+    if ( std::isnan(value) )
+    {
+        memcpy(buffer, "nan", 3);
+        return 3;
+    }
+
+    if ( std::isinf(value) )
+    {
+        memcpy(buffer, (value < 0) ? "-inf" : "inf", (value < 0) ? 4 : 3);
+        return (value < 0) ? 4 : 3;
+    }
+
+    /* integral values (channels, counts) */
+    if ( value == std::floor(value) && std::fabs(value) < 1E15 )
+    {
+        long long integer = (long long)value;
+
+        char digits[20];
+        int digitCnt = 0;
+        int length = 0;
+
+        if ( integer < 0 )
+        {
+            buffer[length ++] = '-';
+            integer = -integer;
+        }
+
+        do {
+            digits[digitCnt ++] = char('0' + integer % 10);
+            integer /= 10;
+        } while ( integer );
+
+        while ( digitCnt )
+            buffer[length ++] = digits[-- digitCnt];
+
+        return length;
+    }
+
+    /* the shortest precision reading back to the same value */
+    int length = 0;
+    for ( int precision = 15 ; precision <= 17 ; ++ precision )
+    {
+        length = snprintf(buffer, DSIMPLEXML_DOUBLE_STRING_SIZE, "%.*g", precision, value);
+
+        if ( precision == 17 || strtod(buffer, nullptr) == value )
+            break;
+    }
+
+    /* the decimal point of the C-library follows the locale */
+    const char decimalPoint = localeconv()->decimal_point[0];
+
+    if ( decimalPoint != '.' )
+    {
+        for ( int i = 0 ; i < length ; ++ i )
+        {
+            if ( buffer[i] == decimalPoint )
+                buffer[i] = '.';
+        }
+    }
+
+    return length;
+}
+
+QString getPointArrayString(const double *x, const double *y, int cnt)
+{
+    QByteArray text;
+    text.reserve(cnt*16);
+
+    char number[DSIMPLEXML_DOUBLE_STRING_SIZE];
+
+    for ( int i = 0 ; i < cnt ; ++ i )
+    {
+        text.append('{');
+        text.append(number, getShortestDoubleString(x[i], number));
+        text.append('|');
+        text.append(number, getShortestDoubleString(y[i], number));
+        text.append('}');
+    }
+
+    return QString::fromLatin1(text);
+}
+
+DSimpleXMLOutputStream::DSimpleXMLOutputStream(QIODevice *device, int bufferSize) :
+    m_device(device),
+    m_codec(QTextCodec::codecForLocale()),
+    m_size(0),
+    m_error(false)
+{
+    m_buffer.resize(qMax(bufferSize, 2*DSIMPLEXML_DOUBLE_STRING_SIZE + 3));
+}
+
+DSimpleXMLOutputStream::~DSimpleXMLOutputStream()
+{
+    flush();
+}
+
+DSimpleXMLOutputStream &DSimpleXMLOutputStream::operator<<(const QString &text)
+{
+    const QChar *data = text.constData();
+    const int size = text.size();
+
+    bool isASCII = true;
+    for ( int i = 0 ; i < size && isASCII ; ++ i )
+        isASCII = (data[i].unicode() < 0x80);
+
+    if ( isASCII )
+    {
+        /* copy in pieces of the buffer size */
+        int pos = 0;
+        while ( pos < size )
+        {
+            if ( m_size == m_buffer.size() )
+                flush();
+
+            const int cnt = qMin(size - pos, m_buffer.size() - m_size);
+
+            char *dest = m_buffer.data() + m_size;
+            for ( int i = 0 ; i < cnt ; ++ i )
+                dest[i] = char(data[pos + i].unicode());
+
+            m_size += cnt;
+            pos += cnt;
+        }
+    }
+    else
+    {
+        const QByteArray encoded = m_codec ? m_codec->fromUnicode(text) : text.toUtf8();
+
+        write(encoded.constData(), encoded.size());
+    }
+
+    return *this;
+}
+
+void DSimpleXMLOutputStream::writePoints(const double *x, const double *y, int cnt)
+{
+    const int maxPointSize = 2*DSIMPLEXML_DOUBLE_STRING_SIZE + 3;
+
+    for ( int i = 0 ; i < cnt ; ++ i )
+    {
+        if ( m_buffer.size() - m_size < maxPointSize )
+            flush();
+
+        char *dest = m_buffer.data() + m_size;
+        int length = 0;
+
+        dest[length ++] = '{';
+        length += getShortestDoubleString(x[i], dest + length);
+        dest[length ++] = '|';
+        length += getShortestDoubleString(y[i], dest + length);
+        dest[length ++] = '}';
+
+        m_size += length;
+    }
+}
+
+bool DSimpleXMLOutputStream::flush()
+{
+    if ( m_size > 0 && !m_error )
+    {
+        if ( !m_device || m_device->write(m_buffer.constData(), m_size) != m_size )
+            m_error = true;
+    }
+
+    m_size = 0;
+
+    return !m_error;
+}
+
+bool DSimpleXMLOutputStream::hasError() const
+{
+    return m_error;
+}
+
+void DSimpleXMLOutputStream::write(const char *data, int size)
+{
+    if ( m_size + size > m_buffer.size() )
+        flush();
+
+    if ( size > m_buffer.size() )
+    {
+        if ( !m_error && (!m_device || m_device->write(data, size) != size) )
+            m_error = true;
+
+        return;
+    }
+
+    memcpy(m_buffer.data() + m_size, data, size);
+    m_size += size;
+}
+
+
 DSimpleXMLWriter::DSimpleXMLWriter() :
     QFile(),
     m_tabCnt(0)
@@ -62,7 +256,20 @@ DSimpleXMLWriter::DSimpleXMLWriter(const DString &fileName) :
 
 DSimpleXMLWriter::~DSimpleXMLWriter() {}
 
-void DSimpleXMLWriter::writeNode(const QList<DSimpleXMLNode*>& nodeList, QTextStream *stream)
+void DSimpleXMLWriter::writeValue(const DSimpleXMLNode *node, DSimpleXMLOutputStream *stream)
+{
+    if ( node->hasPoints() )
+    {
+        const QVector<double> x = node->getPointsX();
+        const QVector<double> y = node->getPointsY();
+
+        stream->writePoints(x.constData(), y.constData(), qMin(x.size(), y.size()));
+    }
+    else
+        (*stream) << node->getValue().toString();
+}
+
+void DSimpleXMLWriter::writeNode(const QList<DSimpleXMLNode*>& nodeList, DSimpleXMLOutputStream *stream)
 {
     m_tabCnt ++;
     (*stream) << QString("\r\n");
@@ -76,7 +283,7 @@ void DSimpleXMLWriter::writeNode(const QList<DSimpleXMLNode*>& nodeList, QTextSt
         if ( nodeList.at(index)->hasValue() )
         {
             (*stream) << DSIMPLEXML_TABJUMP(m_tabCnt) % DSIMPLEXML_STARTNODE(nodeList.at(index)->nodeName());
-                (*stream) << nodeList.at(index)->getValue().toString();
+                writeValue(nodeList.at(index), stream);
             (*stream) << DSIMPLEXML_ENDNODE(nodeList.at(index)->nodeName());
         }
         else if ( nodeList.at(index)->hasChilds() )
@@ -104,64 +311,73 @@ bool DSimpleXMLWriter::writeToFile(DSimpleXMLNode *rootNode)
     }
 
 
-    QTextStream xmlStream(this);
+    QSaveFile file(fileName());
 
-    if ( open(QIODevice::ReadWrite|QIODevice::Truncate) )
-    {
-        xmlStream << DSIMPLEXML_STARTNODE(rootNode->nodeName());
+    if ( !file.open(QIODevice::WriteOnly) )
+        return false;
 
-        if ( rootNode->hasValue() )
-            xmlStream << rootNode->getValue().toString();
-        else if ( rootNode->hasChilds() )
-            writeNode(rootNode->getChilds(), &xmlStream);
+    DSimpleXMLOutputStream xmlStream(&file);
 
-        xmlStream << DSIMPLEXML_ENDNODE(rootNode->nodeName());
+    xmlStream << DSIMPLEXML_STARTNODE(rootNode->nodeName());
 
-        close();
-    }
-    else
+    if ( rootNode->hasValue() )
+        writeValue(rootNode, &xmlStream);
+    else if ( rootNode->hasChilds() )
+        writeNode(rootNode->getChilds(), &xmlStream);
+
+    xmlStream << DSIMPLEXML_ENDNODE(rootNode->nodeName());
+
+    if ( !xmlStream.flush() )
+    {
+        file.cancelWriting();
         return false;
+    }
 
 
-    return true;
+    return file.commit();
 }
 
 bool DSimpleXMLWriter::writeToFile(const QList<DSimpleXMLNode *> &rootNodeList)
 {
-    QTextStream xmlStream(this);
+    QSaveFile file(fileName());
 
-    if ( open(QIODevice::ReadWrite|QIODevice::Truncate) )
-    {
-        for ( int index = 0 ; index < rootNodeList.size() ; ++ index )
-        {
-            if ( !rootNodeList.at(index) )
-                continue;
+    if ( !file.open(QIODevice::WriteOnly) )
+        return false;
 
-            xmlStream << DSIMPLEXML_STARTNODE(rootNodeList.at(index)->nodeName());
+    DSimpleXMLOutputStream xmlStream(&file);
 
-            if ( rootNodeList.at(index)->hasValue() )
-                xmlStream << rootNodeList.at(index)->getValue().toString();
-            else if ( rootNodeList.at(index)->hasChilds() )
-                writeNode(rootNodeList.at(index)->getChilds(), &xmlStream);
+    for ( int index = 0 ; index < rootNodeList.size() ; ++ index )
+    {
+        if ( !rootNodeList.at(index) )
+            continue;
 
-            xmlStream << DSIMPLEXML_ENDNODE(rootNodeList.at(index)->nodeName());
+        xmlStream << DSIMPLEXML_STARTNODE(rootNodeList.at(index)->nodeName());
 
-            xmlStream << QString("\r\n");
-        }
+        if ( rootNodeList.at(index)->hasValue() )
+            writeValue(rootNodeList.at(index), &xmlStream);
+        else if ( rootNodeList.at(index)->hasChilds() )
+            writeNode(rootNodeList.at(index)->getChilds(), &xmlStream);
 
-        close();
+        xmlStream << DSIMPLEXML_ENDNODE(rootNodeList.at(index)->nodeName());
+
+        xmlStream << QString("\r\n");
     }
-    else
+
+    if ( !xmlStream.flush() )
+    {
+        file.cancelWriting();
         return false;
+    }
 
 
-    return true;
+    return file.commit();
 }
 
 
 DSimpleXMLNode::DSimpleXMLNode() :
        m_nodeName(""),
        m_value(""),
+       m_hasPoints(false),
        m_parent(nullptr)
 {
     if ( m_nodeName.isEmpty() )
@@ -176,6 +392,7 @@ DSimpleXMLNode::DSimpleXMLNode() :
 DSimpleXMLNode::DSimpleXMLNode(const QString &nodeName) :
     m_nodeName(nodeName),
     m_value(""),
+    m_hasPoints(false),
     m_parent(nullptr)
 {
     if ( m_nodeName.isEmpty() )
@@ -190,6 +407,7 @@ DSimpleXMLNode::DSimpleXMLNode(const QString &nodeName) :
 DSimpleXMLNode::DSimpleXMLNode(const DString &nodeName) :
     m_nodeName((QString)nodeName),
     m_value(""),
+    m_hasPoints(false),
     m_parent(nullptr)
 {
     if ( m_nodeName.isEmpty() )
@@ -278,12 +496,43 @@ QList<DSimpleXMLNode*> DSimpleXMLNode::getChilds() const
 
 QVariant DSimpleXMLNode::getValue() const
 {
+     if ( m_hasPoints )
+         return QVariant(getPointArrayString(m_pointsX.constData(), m_pointsY.constData(), qMin(m_pointsX.size(), m_pointsY.size())));
+
      return m_value;
 }
 
 void DSimpleXMLNode::setValue(const QVariant &value)
 {
     m_value = value;
+
+    m_pointsX.clear();
+    m_pointsY.clear();
+    m_hasPoints = false;
+}
+
+void DSimpleXMLNode::setPoints(const QVector<double> &x, const QVector<double> &y)
+{
+    m_pointsX = x;
+    m_pointsY = y;
+    m_hasPoints = true;
+
+    m_value = QVariant("");
+}
+
+bool DSimpleXMLNode::hasPoints() const
+{
+    return m_hasPoints;
+}
+
+QVector<double> DSimpleXMLNode::getPointsX() const
+{
+    return m_pointsX;
+}
+
+QVector<double> DSimpleXMLNode::getPointsY() const
+{
+    return m_pointsY;
 }
 
 DSimpleXMLNode *DSimpleXMLNode::getParent() const
@@ -303,7 +552,9 @@ void DSimpleXMLNode::removeFromParent(DSimpleXMLNode *childNode)
 
 
     const int index = m_childs.indexOf(childNode);
-    m_childs.takeAt(index);
+
+    if ( index > -1 ) /* already taken by the destructor of the parent */
+        m_childs.takeAt(index);
 }
 
 void DSimpleXMLNode::XMLMessageBox()
@@ -325,33 +576,176 @@ bool DSimpleXMLNode::isValid() const
 }
 
 
+DSimpleXMLIndex::DSimpleXMLIndex(const QString &document) :
+    m_document(document)
+{
+    tokenize();
+}
+
+const QString &DSimpleXMLIndex::document() const
+{
+    return m_document;
+}
+
+int DSimpleXMLIndex::elementCount() const
+{
+    return m_elements.size();
+}
+
+const DSimpleXMLIndex::element &DSimpleXMLIndex::elementAt(int index) const
+{
+    return m_elements.at(index);
+}
+
+int DSimpleXMLIndex::find(int parent, const QString &tagName) const
+{
+    const QHash<QString, QVector<int> >::const_iterator it = m_elementsByName.constFind(tagName);
+
+    if ( it == m_elementsByName.constEnd() )
+        return -1;
+
+    const int subtreeEnd = (parent < 0) ? m_elements.size() : m_elements.at(parent).subtreeEnd;
+
+    const QVector<int>& elements = it.value();
+    QVector<int>::const_iterator last = std::lower_bound(elements.constBegin(), elements.constEnd(), subtreeEnd);
+
+    if ( last == elements.constBegin() )
+        return -1;
+
+    -- last;
+
+    if ( *last <= parent )
+        return -1;
+
+    return *last;
+}
+
+void DSimpleXMLIndex::tokenize()
+{
+    const QChar *data = m_document.constData();
+    const int size = m_document.size();
+
+    QVector<int> openElements;
+
+    int pos = 0;
+    while ( pos < size )
+    {
+        if ( data[pos] != QLatin1Char('<') )
+        {
+            pos ++;
+            continue;
+        }
+
+        const bool isEndTag = (pos + 1 < size && data[pos + 1] == QLatin1Char('/'));
+        const int nameBegin = pos + (isEndTag ? 2 : 1);
+
+        /* '<name>' or '</name>': anything else is text */
+        int nameEnd = nameBegin;
+        while ( nameEnd < size )
+        {
+            const QChar c = data[nameEnd];
+
+            if ( c == QLatin1Char('>') || c == QLatin1Char('<') || c == QLatin1Char('/') || c == QLatin1Char('!') || c == QLatin1Char('?') || c.isSpace() )
+                break;
+
+            nameEnd ++;
+        }
+
+        if ( nameEnd == nameBegin || nameEnd >= size || data[nameEnd] != QLatin1Char('>') )
+        {
+            pos ++;
+            continue;
+        }
+
+        const int nameLength = nameEnd - nameBegin;
+
+        if ( !isEndTag )
+        {
+            element e;
+            e.nameBegin = nameBegin;
+            e.nameLength = nameLength;
+            e.contentBegin = nameEnd + 1;
+            e.contentEnd = size;
+            e.subtreeEnd = -1;
+
+            m_elementsByName[QString::fromRawData(data + nameBegin, nameLength)].append(m_elements.size());
+
+            openElements.append(m_elements.size());
+            m_elements.append(e);
+        }
+        else
+        {
+            int depth = openElements.size() - 1;
+            for ( ; depth >= 0 ; -- depth )
+            {
+                const element& e = m_elements.at(openElements.at(depth));
+
+                if ( e.nameLength == nameLength
+                     && !memcmp(data + e.nameBegin, data + nameBegin, nameLength * sizeof(QChar)) )
+                    break;
+            }
+
+            /* close the matching element and the unclosed elements within */
+            if ( depth >= 0 )
+            {
+                while ( openElements.size() > depth )
+                {
+                    element& e = m_elements[openElements.takeLast()];
+
+                    e.contentEnd = pos;
+                    e.subtreeEnd = m_elements.size();
+                }
+            }
+        }
+
+        pos = nameEnd + 1;
+    }
+
+    while ( !openElements.isEmpty() )
+        m_elements[openElements.takeLast()].subtreeEnd = m_elements.size();
+}
+
+
 DSimpleXMLTag::DSimpleXMLTag() :
-    DString("") {}
+    DString(""),
+    m_element(-1) {}
 
 DSimpleXMLTag::DSimpleXMLTag(const QString &value) :
-    DString(value) {}
+    DString(value),
+    m_element(-1)
+{
+    if ( !value.isEmpty() )
+        m_index = QSharedPointer<const DSimpleXMLIndex>(new DSimpleXMLIndex(value));
+}
 
 DSimpleXMLTag::DSimpleXMLTag(const DString &value) :
-    DString(value) {}
+    DSimpleXMLTag((QString)value) {}
 
 DSimpleXMLTag::DSimpleXMLTag(const DSimpleXMLString &value) :
-    DString(value) {}
+    DSimpleXMLTag((QString)value) {}
+
+DSimpleXMLTag::DSimpleXMLTag(const QSharedPointer<const DSimpleXMLIndex> &index, int element) :
+    DString(QString::fromRawData(index->document().constData() + index->elementAt(element).contentBegin,
+                                 index->elementAt(element).contentEnd - index->elementAt(element).contentBegin)),
+    m_index(index),
+    m_element(element) {}
 
 DSimpleXMLTag::~DSimpleXMLTag() {}
 
 DSimpleXMLTag DSimpleXMLTag::getTag(const QString &tagName, bool *ok) const
 {
-    const DString pValue = parseBetween(DSIMPLEXML_STARTNODE(tagName), DSIMPLEXML_ENDNODE(tagName));
+    const int element = m_index ? m_index->find(m_element, tagName) : -1;
 
-    if ( pValue.isEmpty() )
+    if ( element < 0
+         || m_index->elementAt(element).contentEnd == m_index->elementAt(element).contentBegin )
     {
         if ( ok ) *ok = false;
-        return DSimpleXMLTag("");
+        return DSimpleXMLTag();
     }
     else
     {
         if ( ok ) *ok = true;
-        return DSimpleXMLTag(pValue);
+        return DSimpleXMLTag(m_index, element);
     }
 }
 
@@ -373,14 +767,15 @@ DSimpleXMLTag DSimpleXMLTag::getTag(const DSimpleXMLNode &node, bool *ok) const
 DSimpleXMLTag DSimpleXMLTag::getTag(DSimpleXMLNode *node, bool *ok) const
 {
     if ( !node )
-        return DSimpleXMLTag("");
+        return DSimpleXMLTag();
     else
         return getTag(node->nodeName(), ok);
 }
 
 QVariant DSimpleXMLTag::getValue() const
 {
-    return QVariant(*this);
+    /* deep copy: the tag might be a view on the document */
+    return QVariant(QString(constData(), size()));
 }
 
 QVariant DSimpleXMLTag::getValueAt(const QString &tagName, bool *ok) const
@@ -408,7 +803,7 @@ QVariant DSimpleXMLTag::getValueAt(DSimpleXMLNode *node, bool *ok) const
 
 void DSimpleXMLTag::XMLMessageBox()
 {
-    DMSGBOX((QString)*this);
+    DMSGBOX(getValue().toString());
 }
 
 QVariant DSimpleXMLTag::getValueAt(const DSimpleXMLString &tagName, bool *ok) const
@@ -30,23 +30,80 @@
 #ifndef SIMPLEXML_H
 #define SIMPLEXML_H
 
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <clocale>
+
+#include <QSharedPointer>
+#include <QHash>
+#include <QVector>
+#include <QPointF>
+#include <QSaveFile>
+#include <QTextCodec>
+
 #include "../DTypes/types.h"
 #include "../DCompression/compressionwrapper.h"
 
 QString getTabJumpString(int cnt);
 
+/* shortest decimal representation of 'value' which reads back to the same double (C-locale, not terminated), returns the length */
+int getShortestDoubleString(double value, char *buffer);
+/* {x|y}{x|y}... */
+QString getPointArrayString(const double *x, const double *y, int cnt);
+
 #define DSIMPLEXML_STARTNODE(__nodeName__)     QString("<"  % __nodeName__ % ">")
 #define DSIMPLEXML_ENDNODE(__nodeName__)        QString("</" % __nodeName__ % ">")
 #define DSIMPLEXML_TABJUMP(__cnt__)                    getTabJumpString(__cnt__)
 
+#define DSIMPLEXML_DOUBLE_STRING_SIZE   32
+#define DSIMPLEXML_OUTPUT_BUFFER_SIZE   (1 << 20) /* [bytes] */
+
 
 class DSimpleXMLNode;
 class DSimpleXMLTag;
 class DSimpleXMLString;
+class DSimpleXMLIndex;
 
 class DSimpleXMLWriter;
 class DSimpleXMLReader;
+class DSimpleXMLOutputStream;
 
+/*
+ * DSimpleXMLOutputStream - buffered output of a writer:
+ *-----------------------------------------------------
+ *
+ * The text is encoded (codec of the locale as QTextStream does, ASCII is copied as is) into a large buffer which is written
+ * to the device when it is full. Point arrays are formatted from the values directly into the buffer.
+ */
+
+class DSimpleXMLOutputStream
+{
+    QIODevice *m_device;
+    QTextCodec *m_codec;
+
+    QByteArray m_buffer;
+    int m_size;
+
+    bool m_error;
+
+public:
+    explicit DSimpleXMLOutputStream(QIODevice *device, int bufferSize = DSIMPLEXML_OUTPUT_BUFFER_SIZE);
+    ~DSimpleXMLOutputStream();
+
+    DSimpleXMLOutputStream& operator<<(const QString& text);
+    void writePoints(const double *x, const double *y, int cnt);
+
+    /* false: writing to the device failed */
+    bool flush();
+    bool hasError() const;
+
+private:
+    void write(const char *data, int size);
+};
+
+/* writes to a temporary file which replaces the file on success (QSaveFile) */
 class DSimpleXMLWriter : public QFile
 {
     int m_tabCnt;
@@ -62,7 +119,8 @@ public:
     virtual bool writeToFile(const QList<DSimpleXMLNode*>& rootNodeList);
 
 private:
-    void writeNode(const QList<DSimpleXMLNode *> &nodeList, QTextStream *stream);
+    void writeNode(const QList<DSimpleXMLNode *> &nodeList, DSimpleXMLOutputStream *stream);
+    void writeValue(const DSimpleXMLNode *node, DSimpleXMLOutputStream *stream);
 };
 
 
@@ -103,6 +161,9 @@ class DSimpleXMLNode
 {
     QString m_nodeName;
     QVariant m_value;
+    QVector<double> m_pointsX;
+    QVector<double> m_pointsY;
+    bool m_hasPoints;
     QList<DSimpleXMLNode* > m_childs;
     DSimpleXMLNode *m_parent;
 
@@ -130,6 +191,12 @@ public:
 
     void setValue(const QVariant& value);
 
+    /* typed value (implicitly shared arrays): formatted as {x|y}{x|y}... not before it is written or requested by getValue() */
+    void setPoints(const QVector<double>& x, const QVector<double>& y);
+    bool hasPoints() const;
+    QVector<double> getPointsX() const;
+    QVector<double> getPointsY() const;
+
 private:
     DSimpleXMLNode* getParent() const;
     void setParent(DSimpleXMLNode* parentNode);
@@ -140,8 +207,66 @@ public slots:
 };
 
 
+/*
+ * DSimpleXMLIndex - element spans of a document:
+ *-----------------------------------------------
+ *
+ * The document is tokenized once: each '<name>' ... '</name>' pair becomes an element span (offsets into the document),
+ * stored in document order, so the descendants of an element are the contiguous range (element, subtreeEnd). The elements
+ * of each name are listed in document order, hence a lookup by name within an element is a binary search.
+ *
+ * Start tags without an end tag (e.g. html-tags of a value) are closed by the end tag of the enclosing element, end tags
+ * without a start tag are skipped. Tags with attributes, comments and declarations are treated as text.
+ */
+
+class DSimpleXMLIndex
+{
+public:
+    typedef struct {
+        int nameBegin;
+        int nameLength;
+        int contentBegin;
+        int contentEnd;
+        int subtreeEnd; /* index of the first element behind the descendants */
+    } element;
+
+    explicit DSimpleXMLIndex(const QString& document);
+
+    const QString& document() const;
+    int elementCount() const;
+    const element& elementAt(int index) const;
+
+    /* last element named 'tagName' (document order) within the descendants of 'parent' (-1: document) or -1 */
+    int find(int parent, const QString& tagName) const;
+
+private:
+    void tokenize();
+
+private:
+    QString m_document;
+    QVector<element> m_elements;
+    QHash<QString, QVector<int> > m_elementsByName; /* keys reference the name within m_document */
+};
+
+
+/*
+ * DSimpleXMLTag - the content of an element:
+ *------------------------------------------
+ *
+ * A tag created from a document string indexes the document (DSimpleXMLIndex) once. The tags returned by getTag(...) share
+ * this index and hold a view (QString::fromRawData) on their content within the document, so that chained lookups neither
+ * search nor copy the document. The view is only valid as long as a tag of the document exists, use getValue() for a copy.
+ *
+ * As before, getTag(...) returns the last element of the name within the tag and an empty content is treated as missing.
+ */
+
 class DSimpleXMLTag : public DString
 {
+    QSharedPointer<const DSimpleXMLIndex> m_index;
+    int m_element; /* -1: document */
+
+    DSimpleXMLTag(const QSharedPointer<const DSimpleXMLIndex>& index, int element);
+
 public:
     DSimpleXMLTag();
     DSimpleXMLTag(const QString& value);
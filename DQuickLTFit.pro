@@ -26,7 +26,7 @@
 #
 # *****************************************************************************
 
-QT += core gui
+QT += core gui network
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -37,6 +37,16 @@ QMAKE_MAC_SDK = macosx10.11
 TARGET = DQuickLTFit_4_2
 TEMPLATE = app
 
+#vectorized (SSE2/AVX2) model kernel with runtime dispatch (disable by: qmake CONFIG+=no_simd_kernel):
+!no_simd_kernel {
+DEFINES += __FIT_SIMD_KERNEL
+}
+
+#bit-identical results of the scalar and the vectorized kernel paths require IEEE-754 operations without contraction (FMA):
+!msvc {
+QMAKE_CXXFLAGS += -ffp-contract=off
+}
+
 win32{
 RC_FILE = myapp.rc
 }
@@ -49,9 +59,22 @@ SOURCES += main.cpp\
         Settings/projectmanager.cpp \
         Settings/projectsettingsmanager.cpp \
         Settings/settings.cpp \
+        Settings/asciidataimport.cpp \
+        Settings/listmodeimport.cpp \
+        Settings/spectrumwatcher.cpp \
+        Settings/spectrum.cpp \
+        Settings/projectbinaryfile.cpp \
         Fit/mpfit.c\
         Fit/lifetimedecayfit.cpp \
+        Fit/lifetimedecaybatchfit.cpp \
+        Fit/lifetimedecaypreview.cpp \
+        Fit/lifetimemodel.cpp \
+        Fit/fitthreadpool.cpp \
+        Fit/fitworkspace.cpp \
+        Fit/simdkernel.cpp \
         ltfitdlg.cpp \
+        ltfitcli.cpp \
+        ltfitservice.cpp \
         ltresultdlg.cpp \
         ltplotdlg.cpp \
         ltparameterlistview.cpp \
@@ -63,10 +86,24 @@ HEADERS  += \
                     Settings/projectmanager.h \
                     Settings/projectsettingsmanager.h \
                     Settings/settings.h \
+                    Settings/asciidataimport.h \
+                    Settings/listmodeimport.h \
+                    Settings/spectrumwatcher.h \
+                    Settings/spectrum.h \
+                    Settings/projectbinaryfile.h \
                     Fit/mpfit.h \
                     Fit/mpfit_DISCLAIMER \
                     Fit/lifetimedecayfit.h \
+                    Fit/lifetimedecaybatchfit.h \
+                    Fit/lifetimedecaypreview.h \
+                    Fit/lifetimemodel.h \
+                    Fit/fitthreadpool.h \
+                    Fit/fitworkspace.h \
+                    Fit/simdkernel.h \
+                    Fit/simdkernelimpl.h \
                     ltfitdlg.h \
+                    ltfitcli.h \
+                    ltfitservice.h \
                     ltresultdlg.h \
                     ltplotdlg.h \
                     ltparameterlistview.h \
@@ -98,6 +135,7 @@ CONFIG   += c++11
 HEADERS  += DLib/DLib.h\
             DLib/DTypes/defines.h\
             DLib/DTypes/types.h\
+            DLib/DTypes/latestrequest.h\
             DLib/DXML/simplexml.h\
             DLib/DGUI/svgbutton.h\
             DLib/DGUI/slider.h\
@@ -109,6 +147,7 @@ HEADERS  += DLib/DLib.h\
             DLib/DPlot/plot2DXCurve.h\
             DLib/DPlot/plot2DXAxis.h\
             DLib/DPlot/plot2DXCanvas.h\
+            DLib/DPlot/plot2DXRenderer.h\
             DLib/DCompression/compressionwrapper.h
 
 SOURCES  += DLib/DTypes/defines.cpp\
@@ -124,6 +163,7 @@ SOURCES  += DLib/DTypes/defines.cpp\
             DLib/DPlot/plot2DXCurve.cpp\
             DLib/DPlot/plot2DXAxis.cpp\
             DLib/DPlot/plot2DXCanvas.cpp\
+            DLib/DPlot/plot2DXRenderer.cpp\
             DLib/DCompression/miniz.c\
             DLib/DCompression/compressionwrapper.cpp
 
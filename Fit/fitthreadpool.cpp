@@ -0,0 +1,244 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+
+#include "fitthreadpool.h"
+
+#include <algorithm>
+
+/* pool and worker index of the calling thread (nullptr/-1 for threads outside a pool) */
+static thread_local const FitThreadPool *currentPool = nullptr;
+static thread_local int currentWorker = -1;
+
+FitThreadPool::FitThreadPool(int threadCnt) :
+    m_nextQueue(0),
+    m_pendingTasks(0),
+    m_activeTasks(0),
+    m_quit(false) {
+    const int workers = (threadCnt > 0) ? threadCnt : idealThreadCount();
+
+    for ( int i = 0 ; i < workers ; ++ i )
+        m_queues.push_back(std::unique_ptr<workerQueue>(new workerQueue));
+
+    for ( int i = 0 ; i < workers ; ++ i )
+        m_threads.push_back(std::thread(&FitThreadPool::run, this, i));
+}
+
+FitThreadPool::~FitThreadPool() {
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+
+    m_condition.notify_all();
+
+    for ( std::thread& thread : m_threads )
+        thread.join();
+}
+
+int FitThreadPool::threadCount() const {
+    return (int)m_threads.size();
+}
+
+int FitThreadPool::maxParticipants() const {
+    return threadCount() + 1;
+}
+
+int FitThreadPool::idealThreadCount() {
+    const int cores = (int)std::thread::hardware_concurrency();
+
+    return (cores > 0) ? cores : 1;
+}
+
+void FitThreadPool::start(const std::function<void()>& task) {
+    if ( m_threads.empty() ) { /* no workers => run on the calling thread */
+        task();
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        m_pendingTasks ++;
+        m_activeTasks ++;
+    }
+
+    if ( currentPool == this ) {
+        workerQueue *queue = m_queues[currentWorker].get();
+
+        std::unique_lock<std::mutex> lock(queue->mutex);
+        queue->tasks.push_front(task);
+    }
+    else {
+        workerQueue *queue = m_queues[(m_nextQueue++)%m_queues.size()].get();
+
+        std::unique_lock<std::mutex> lock(queue->mutex);
+        queue->tasks.push_back(task);
+    }
+
+    m_condition.notify_one();
+}
+
+void FitThreadPool::waitForDone() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_activeTasks == 0; });
+}
+
+bool FitThreadPool::takeTask(int worker, std::function<void()> *task) {
+    const int queueCnt = (int)m_queues.size();
+
+    /* own queue (front) */
+    {
+        workerQueue *queue = m_queues[worker].get();
+
+        std::unique_lock<std::mutex> lock(queue->mutex);
+
+        if ( !queue->tasks.empty() ) {
+            *task = queue->tasks.front();
+            queue->tasks.pop_front();
+
+            return true;
+        }
+    }
+
+    /* steal from the other queues (back) */
+    for ( int i = 1 ; i < queueCnt ; ++ i ) {
+        workerQueue *queue = m_queues[(worker + i)%queueCnt].get();
+
+        std::unique_lock<std::mutex> lock(queue->mutex);
+
+        if ( !queue->tasks.empty() ) {
+            *task = queue->tasks.back();
+            queue->tasks.pop_back();
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void FitThreadPool::run(int worker) {
+    currentPool = this;
+    currentWorker = worker;
+
+    for ( ;; ) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_quit || m_pendingTasks > 0; });
+
+            if ( !m_pendingTasks ) /* quit */
+                return;
+        }
+
+        std::function<void()> task;
+        if ( !takeTask(worker, &task) ) { /* counted, but not queued yet */
+            std::this_thread::yield();
+            continue;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_pendingTasks --;
+        }
+
+        task();
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_activeTasks --;
+
+            if ( !m_activeTasks )
+                m_done.notify_all();
+        }
+    }
+}
+
+namespace {
+struct parallelForState {
+    std::function<void(int, int)> func;
+
+    int taskCnt;
+
+    std::atomic<int> nextTask;
+    std::atomic<int> nextParticipant;
+
+    int finishedTasks;
+
+    std::mutex mutex;
+    std::condition_variable finished;
+};
+
+void processParallelFor(const std::shared_ptr<parallelForState>& state) {
+    const int participant = state->nextParticipant++;
+
+    int processed = 0;
+    for ( int task = state->nextTask++ ; task < state->taskCnt ; task = state->nextTask++ ) {
+        state->func(task, participant);
+        processed ++;
+    }
+
+    if ( !processed )
+        return;
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finishedTasks += processed;
+
+    if ( state->finishedTasks == state->taskCnt )
+        state->finished.notify_all();
+}
+}
+
+void FitThreadPool::parallelFor(int taskCnt, const std::function<void(int, int)>& func) {
+    if ( taskCnt <= 0 )
+        return;
+
+    if ( taskCnt == 1 || m_threads.empty() ) {
+        for ( int task = 0 ; task < taskCnt ; ++ task )
+            func(task, 0);
+
+        return;
+    }
+
+    /* the state is shared with helpers which may start after all tasks were processed */
+    std::shared_ptr<parallelForState> state = std::make_shared<parallelForState>();
+    state->func = func;
+    state->taskCnt = taskCnt;
+    state->nextTask = 0;
+    state->nextParticipant = 0;
+    state->finishedTasks = 0;
+
+    const int helpers = std::min(threadCount(), taskCnt - 1);
+    for ( int i = 0 ; i < helpers ; ++ i )
+        start([state] { processParallelFor(state); });
+
+    processParallelFor(state);
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&state] { return state->finishedTasks == state->taskCnt; });
+}
@@ -0,0 +1,103 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+
+#ifndef FITTHREADPOOL_H
+#define FITTHREADPOOL_H
+
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <deque>
+#include <vector>
+
+/*
+ * FitThreadPool - work-stealing worker threads shared by the fit engines:
+ *------------------------------------------------------------------------
+ *
+ * start(...) queues an independent task, parallelFor(...) distributes the tasks 0 ... taskCnt-1 across the workers and the
+ * calling thread. The calling thread takes part in the processing of its own tasks, so parallelFor(...) completes even if
+ * all workers are busy (e.g. nested calls from a task running on the pool).
+ *
+ * Each worker owns a task queue: tasks started from outside the pool are distributed round-robin, tasks started by a worker
+ * are queued in front of its own queue (LIFO). An idle worker takes from the front of its own queue or steals from the back
+ * of the queues of the other workers.
+ */
+
+class FitThreadPool
+{
+public:
+    /* threadCnt <= 0: one worker per (logical) core */
+    explicit FitThreadPool(int threadCnt = 0);
+    ~FitThreadPool();
+
+    int threadCount() const;
+
+    /* upper limit of the participant index passed to parallelFor(...) tasks (workers + calling thread) */
+    int maxParticipants() const;
+
+    void start(const std::function<void()>& task);
+
+    /* func(task, participant): participant in [0, maxParticipants()) is unique across concurrently executed tasks of this call */
+    void parallelFor(int taskCnt, const std::function<void(int, int)>& func);
+
+    /* blocks until all started tasks are finished */
+    void waitForDone();
+
+    static int idealThreadCount();
+
+private:
+    typedef struct {
+        std::mutex mutex;
+        std::deque<std::function<void()> > tasks;
+    } workerQueue;
+
+    void run(int worker);
+    bool takeTask(int worker, std::function<void()> *task);
+
+private:
+    std::vector<std::thread> m_threads;
+    std::vector<std::unique_ptr<workerQueue> > m_queues;
+
+    std::atomic<unsigned int> m_nextQueue;
+
+    /* queued (pending) and queued + running (active) tasks */
+    int m_pendingTasks;
+    int m_activeTasks;
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::condition_variable m_done;
+
+    bool m_quit;
+};
+
+#endif // FITTHREADPOOL_H
@@ -0,0 +1,163 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+
+#include "fitworkspace.h"
+
+FitWorkspace::FitWorkspace() :
+    m_dataCnt(0),
+    m_paramCnt(0),
+    m_runCnt(0),
+    m_paramStride(0),
+    m_dataStride(0) {}
+
+FitWorkspace::~FitWorkspace() {
+    for ( mp_workspace *ws : m_mpfitWorkspaces )
+        mp_workspace_free(ws);
+
+    for ( LifetimeModel *model : m_models )
+        delete model;
+}
+
+void FitWorkspace::reserve(int dataCnt, int paramCnt, int runCnt) {
+    if ( dataCnt > m_dataCnt ) {
+        m_dataCnt = dataCnt;
+
+        m_x.resize(m_dataCnt);
+        m_y.resize(m_dataCnt);
+        m_ey.resize(m_dataCnt);
+        m_modelCurve.resize(m_dataCnt);
+        m_residuals.resize(m_dataCnt);
+    }
+
+    if ( paramCnt > m_paramCnt ) {
+        m_paramCnt = paramCnt;
+
+        m_params.resize(m_paramCnt);
+        m_paramErrors.resize(m_paramCnt);
+        m_paramConstraints.resize(m_paramCnt);
+    }
+
+    if ( runCnt > m_runCnt ) {
+        for ( int r = m_runCnt ; r < runCnt ; ++ r )
+            m_mpfitWorkspaces.push_back(mp_workspace_new());
+
+        m_runCnt = runCnt;
+    }
+
+    m_paramStride = paramCnt;
+    m_dataStride = dataCnt;
+
+    if ( (int)m_runParams.size() < runCnt*paramCnt ) {
+        m_runParams.resize(runCnt*paramCnt);
+        m_runErrors.resize(runCnt*paramCnt);
+    }
+
+    if ( (int)m_runResiduals.size() < runCnt*dataCnt )
+        m_runResiduals.resize(runCnt*dataCnt);
+}
+
+int FitWorkspace::dataCapacity() const {
+    return m_dataCnt;
+}
+
+int FitWorkspace::paramCapacity() const {
+    return m_paramCnt;
+}
+
+int FitWorkspace::runCapacity() const {
+    return m_runCnt;
+}
+
+double *FitWorkspace::x() {
+    return m_x.data();
+}
+
+double *FitWorkspace::y() {
+    return m_y.data();
+}
+
+double *FitWorkspace::ey() {
+    return m_ey.data();
+}
+
+double *FitWorkspace::modelCurve() {
+    return m_modelCurve.data();
+}
+
+double *FitWorkspace::params() {
+    return m_params.data();
+}
+
+double *FitWorkspace::paramErrors() {
+    return m_paramErrors.data();
+}
+
+double *FitWorkspace::residuals() {
+    return m_residuals.data();
+}
+
+mp_par *FitWorkspace::paramConstraints() {
+    return m_paramConstraints.data();
+}
+
+double *FitWorkspace::runParams(int run) {
+    return m_runParams.data() + run*m_paramStride;
+}
+
+double *FitWorkspace::runErrors(int run) {
+    return m_runErrors.data() + run*m_paramStride;
+}
+
+double *FitWorkspace::runResiduals(int run) {
+    return m_runResiduals.data() + run*m_dataStride;
+}
+
+mp_workspace *FitWorkspace::mpfitWorkspace(int run) {
+    return m_mpfitWorkspaces[run];
+}
+
+LifetimeModel *FitWorkspace::model(int index, int componentCnt, int gaussianCnt) {
+    if ( index >= (int)m_models.size() )
+        m_models.resize(index + 1, nullptr);
+
+    LifetimeModel *model = m_models[index];
+
+    if ( model
+         && (model->componentCount() != componentCnt || model->gaussianCount() != gaussianCnt) ) {
+        delete model;
+        model = nullptr;
+    }
+
+    if ( !model ) {
+        model = new LifetimeModel(componentCnt, gaussianCnt);
+        m_models[index] = model;
+    }
+
+    return model;
+}
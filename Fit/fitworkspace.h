@@ -0,0 +1,111 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+
+#ifndef FITWORKSPACE_H
+#define FITWORKSPACE_H
+
+#include <vector>
+
+#include "mpfit.h"
+#include "lifetimemodel.h"
+
+/*
+ * FitWorkspace - reusable buffers of LifeTimeDecayFitEngine::fit():
+ *------------------------------------------------------------------
+ *
+ * The buffers (data, parameters, residuals, multi-start runs), the model engines and the temporary arrays of mpfit_ws(...) are
+ * sized on reserve(...) and only grow, so repeated fits of the same problem shape (restarts, refits, batch jobs) do not
+ * allocate. A workspace must not be used by concurrent fits.
+ */
+
+class FitWorkspace
+{
+public:
+    FitWorkspace();
+    ~FitWorkspace();
+
+    /* dataCnt: residuals (incl. constraint), paramCnt: parameters, runCnt: multi-start runs (sets the strides of the run buffers) */
+    void reserve(int dataCnt, int paramCnt, int runCnt = 1);
+
+    int dataCapacity() const;
+    int paramCapacity() const;
+    int runCapacity() const;
+
+    double *x();
+    double *y();
+    double *ey();
+    double *modelCurve();
+
+    double *params();
+    double *paramErrors();
+    double *residuals();
+    mp_par *paramConstraints();
+
+    /* multi-start run 0 ... runCnt-1 (contiguous: runParams(r) = runParams(0) + r*paramCnt) */
+    double *runParams(int run);
+    double *runErrors(int run);
+    double *runResiduals(int run);
+
+    /* temporary arrays of mpfit_ws(...) of a run */
+    mp_workspace *mpfitWorkspace(int run);
+
+    /* model engine (re-created if the shape differs) */
+    LifetimeModel *model(int index, int componentCnt, int gaussianCnt);
+
+private:
+    FitWorkspace(const FitWorkspace&) = delete;
+    FitWorkspace& operator=(const FitWorkspace&) = delete;
+
+private:
+    int m_dataCnt;
+    int m_paramCnt;
+    int m_runCnt;
+
+    int m_paramStride;
+    int m_dataStride;
+
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<double> m_ey;
+    std::vector<double> m_modelCurve;
+
+    std::vector<double> m_params;
+    std::vector<double> m_paramErrors;
+    std::vector<double> m_residuals;
+    std::vector<mp_par> m_paramConstraints;
+
+    std::vector<double> m_runParams;
+    std::vector<double> m_runErrors;
+    std::vector<double> m_runResiduals;
+
+    std::vector<mp_workspace*> m_mpfitWorkspaces;
+    std::vector<LifetimeModel*> m_models;
+};
+
+#endif // FITWORKSPACE_H
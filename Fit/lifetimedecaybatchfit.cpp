@@ -0,0 +1,441 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+
+#include "lifetimedecaybatchfit.h"
+
+LifeTimeDecayBatchFitEngine::LifeTimeDecayBatchFitEngine() :
+    QObject(),
+    m_template(nullptr),
+    m_templateProject(nullptr),
+    m_threadCnt(0),
+    m_fitThreadCnt(1),
+    m_multiStartCnt(1),
+    m_numericalDerivatives(false),
+    m_canceled(false),
+    m_finishedFits(0),
+    m_throughput(0.0f) {}
+
+LifeTimeDecayBatchFitEngine::~LifeTimeDecayBatchFitEngine()
+{
+    DDELETE_SAFETY(m_templateProject);
+
+    qDeleteAll(m_workspaces);
+}
+
+void LifeTimeDecayBatchFitEngine::setTemplate(const PALSFitSet *fitSet)
+{
+    m_template = fitSet;
+}
+
+void LifeTimeDecayBatchFitEngine::addSpectrum(const QString &fileName, int binFactor)
+{
+    PALSBatchSpectrum spectrum;
+
+    spectrum.name = QFileInfo(fileName).fileName();
+    spectrum.fileName = fileName;
+    spectrum.binFactor = binFactor;
+
+    m_spectra.append(spectrum);
+}
+
+void LifeTimeDecayBatchFitEngine::addSpectrum(const QString &name, const PALSSpectrum &dataSet)
+{
+    PALSBatchSpectrum spectrum;
+
+    spectrum.name = name;
+    spectrum.binFactor = 1;
+    spectrum.dataSet = dataSet;
+
+    m_spectra.append(spectrum);
+}
+
+void LifeTimeDecayBatchFitEngine::clearSpectra()
+{
+    m_spectra.clear();
+}
+
+int LifeTimeDecayBatchFitEngine::spectraCount() const
+{
+    return m_spectra.size();
+}
+
+void LifeTimeDecayBatchFitEngine::setResultFileName(const QString &fileName)
+{
+    m_resultFileName = fileName;
+}
+
+void LifeTimeDecayBatchFitEngine::setThreadCount(int threadCnt)
+{
+    m_threadCnt = qMax(0, threadCnt);
+}
+
+void LifeTimeDecayBatchFitEngine::setMultiStartCount(int startCnt)
+{
+    m_multiStartCnt = qMax(1, startCnt);
+}
+
+void LifeTimeDecayBatchFitEngine::setNumericalDerivatives(bool on)
+{
+    m_numericalDerivatives = on;
+}
+
+double LifeTimeDecayBatchFitEngine::throughput() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_throughput;
+}
+
+QList<PALSBatchFitResult> LifeTimeDecayBatchFitEngine::results() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_results;
+}
+
+void LifeTimeDecayBatchFitEngine::run()
+{
+    m_canceled = false;
+
+    m_mutex.lock();
+    m_results.clear();
+    m_finishedFits = 0;
+    m_throughput = 0.0f;
+    m_mutex.unlock();
+
+    if ( !m_template
+         || m_spectra.isEmpty() ) {
+        emit finished();
+        return;
+    }
+
+    /* private copy of the template: the caller might change its fit set while the batch is running */
+    DDELETE_SAFETY(m_templateProject);
+    m_templateProject = new PALSProject;
+
+    PALSDataStructure *templateStructure = new PALSDataStructure(m_templateProject);
+    copyFitSet(m_template, templateStructure->getFitSetPtr());
+
+    if ( !m_resultFileName.isEmpty() ) {
+        m_resultFile.setFileName(m_resultFileName);
+
+        if ( m_resultFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text) ) {
+            m_resultStream.setDevice(&m_resultFile);
+            m_resultStream << resultHeader(templateStructure->getFitSetPtr()) << endl;
+        }
+    }
+
+    m_timer.start();
+
+    /* nothing to distribute across the fits: the model evaluation (and the Jacobian columns) of the single fit run in parallel */
+    m_fitThreadCnt = (m_spectra.size() == 1)?m_threadCnt:1;
+
+    {
+        FitThreadPool pool((m_spectra.size() == 1)?1:m_threadCnt);
+
+        for ( int i = 0 ; i < m_spectra.size() ; ++ i )
+            pool.start([this, i] { fitSpectrum(i); });
+
+        pool.waitForDone();
+    }
+
+    m_mutex.lock();
+    m_throughput = (m_timer.elapsed() > 0)?(1000.0f*(double)m_finishedFits/(double)m_timer.elapsed()):0.0f;
+    m_mutex.unlock();
+
+#ifdef __BATCHFIT_DEBUG
+    qDebug() << "batch-fit: " << m_finishedFits << " fits in " << m_timer.elapsed() << " ms (" << m_throughput << " fits/s)";
+#endif
+
+    if ( m_resultFile.isOpen() ) {
+        m_resultStream.setDevice(nullptr);
+        m_resultFile.close();
+    }
+
+    DDELETE_SAFETY(m_templateProject);
+
+    emit finished();
+}
+
+void LifeTimeDecayBatchFitEngine::cancel()
+{
+    m_canceled = true;
+}
+
+void LifeTimeDecayBatchFitEngine::fitSpectrum(int index)
+{
+    const PALSBatchSpectrum& spectrum = m_spectra.at(index);
+
+    PALSBatchFitResult result;
+
+    if ( m_canceled ) {
+        result.status = BATCH_ERR_CANCELED;
+        result.chiSquare = 0.0f;
+        result.fitTime = 0.0f;
+    }
+    else {
+        FitWorkspace *workspace = acquireWorkspace();
+
+        result = fitSpectrum(m_templateProject->getDataStructureAt(0)->getFitSetPtr(), spectrum, m_multiStartCnt, workspace,
+                             m_fitThreadCnt, m_numericalDerivatives);
+
+        releaseWorkspace(workspace);
+    }
+
+    result.index = index;
+    result.name = spectrum.name;
+
+    writeResult(result);
+}
+
+PALSBatchFitResult LifeTimeDecayBatchFitEngine::fitSpectrum(const PALSFitSet *fitSet, const PALSBatchSpectrum &spectrum, int multiStartCnt, FitWorkspace *workspace,
+                                                             int threadCnt, bool numericalDerivatives)
+{
+    QElapsedTimer fitTimer;
+    fitTimer.start();
+
+    PALSBatchFitResult result;
+
+    result.index = 0;
+    result.name = spectrum.name;
+    result.chiSquare = 0.0f;
+
+    PALSSpectrum dataSet;
+    int minChannel = 0, maxChannel = 0;
+
+    if ( !spectrum.fileName.isEmpty() ) {
+        PALSASCIIData data;
+
+        if ( PALSASCIIDataImport::importFile(spectrum.fileName, spectrum.binFactor, &data, 1 /* the spectra are imported concurrently */) != asciiImportStatus::ok_ImportStatus ) {
+            result.status = BATCH_ERR_IMPORT;
+            result.fitTime = (double)fitTimer.nsecsElapsed()*1E-9;
+
+            return result;
+        }
+
+        dataSet = data.dataSet;
+        minChannel = data.minChannel;
+        maxChannel = data.maxChannel;
+    }
+    else {
+        dataSet = spectrum.dataSet;
+
+        if ( dataSet.isEmpty() ) {
+            result.status = MP_ERR_NO_DATA;
+            result.fitTime = (double)fitTimer.nsecsElapsed()*1E-9;
+
+            return result;
+        }
+
+        minChannel = (int)dataSet.channelAt(0);
+        maxChannel = (int)dataSet.channelAt(dataSet.size() - 1);
+    }
+
+    /* each fit works on its own project (data structure) */
+    PALSProject project;
+    PALSDataStructure *dataStructure = new PALSDataStructure(&project);
+    PALSFitSet *privateFitSet = dataStructure->getFitSetPtr();
+
+    copyFitSet(fitSet, privateFitSet);
+
+    privateFitSet->setStartChannel(qBound(minChannel, privateFitSet->getStartChannel(), maxChannel));
+    privateFitSet->setStopChannel(qBound(minChannel, privateFitSet->getStopChannel(), maxChannel));
+
+    dataStructure->getDataSetPtr()->setLifeTimeData(dataSet);
+    dataStructure->getDataSetPtr()->setBinFactor(qMax(1, spectrum.binFactor));
+
+    LifeTimeDecayFitEngine engine;
+
+    engine.setThreadCount(threadCnt);
+    engine.setMultiStartCount(multiStartCnt);
+    engine.setNumericalDerivatives(numericalDerivatives);
+    engine.setWorkspace(workspace);
+    engine.init(dataStructure);
+    engine.fit();
+
+    result.status = privateFitSet->getFitFinishCodeValue();
+    result.chiSquare = privateFitSet->getChiSquareAfterFit();
+
+    for ( int i = 0 ; i < (int)privateFitSet->getSourceParamPtr()->getSize() ; ++ i ) {
+        result.values.append(privateFitSet->getSourceParamPtr()->getParameterAt(i)->getFitValue());
+        result.errors.append(privateFitSet->getSourceParamPtr()->getParameterAt(i)->getFitValueError());
+    }
+
+    for ( int i = 0 ; i < (int)privateFitSet->getLifeTimeParamPtr()->getSize() ; ++ i ) {
+        result.values.append(privateFitSet->getLifeTimeParamPtr()->getParameterAt(i)->getFitValue());
+        result.errors.append(privateFitSet->getLifeTimeParamPtr()->getParameterAt(i)->getFitValueError());
+    }
+
+    for ( int i = 0 ; i < (int)privateFitSet->getDeviceResolutionParamPtr()->getSize() ; ++ i ) {
+        result.values.append(privateFitSet->getDeviceResolutionParamPtr()->getParameterAt(i)->getFitValue());
+        result.errors.append(privateFitSet->getDeviceResolutionParamPtr()->getParameterAt(i)->getFitValueError());
+    }
+
+    result.values.append(privateFitSet->getBackgroundParamPtr()->getParameter()->getFitValue());
+    result.errors.append(privateFitSet->getBackgroundParamPtr()->getParameter()->getFitValueError());
+
+    result.values.append(privateFitSet->getAverageLifeTime());
+    result.errors.append(privateFitSet->getAverageLifeTimeError());
+
+    result.fitTime = (double)fitTimer.nsecsElapsed()*1E-9;
+
+    return result;
+}
+
+FitWorkspace *LifeTimeDecayBatchFitEngine::acquireWorkspace()
+{
+    QMutexLocker locker(&m_workspaceMutex);
+
+    if ( !m_idleWorkspaces.isEmpty() )
+        return m_idleWorkspaces.takeLast();
+
+    FitWorkspace *workspace = new FitWorkspace;
+    m_workspaces.append(workspace);
+
+    return workspace;
+}
+
+void LifeTimeDecayBatchFitEngine::releaseWorkspace(FitWorkspace *workspace)
+{
+    QMutexLocker locker(&m_workspaceMutex);
+
+    m_idleWorkspaces.append(workspace);
+}
+
+void LifeTimeDecayBatchFitEngine::writeResult(const PALSBatchFitResult &result)
+{
+    m_mutex.lock();
+
+    if ( m_resultFile.isOpen() ) {
+        m_resultStream << resultRow(result) << endl; /* flushed: the rows of finished fits are kept if the batch is aborted */
+    }
+
+    m_results.append(result);
+
+    m_finishedFits ++;
+    m_throughput = (m_timer.elapsed() > 0)?(1000.0f*(double)m_finishedFits/(double)m_timer.elapsed()):0.0f;
+
+    const int finishedFits = m_finishedFits;
+    const double throughput = m_throughput;
+
+    m_mutex.unlock();
+
+    emit fitFinished(result.index, result.name, result.status, result.fitTime);
+    emit progress(finishedFits, m_spectra.size(), throughput);
+}
+
+QStringList LifeTimeDecayBatchFitEngine::parameterNames(const PALSFitSet *fitSet)
+{
+    QStringList names;
+
+    if ( !fitSet )
+        return names;
+
+    for ( int i = 0 ; i < (int)fitSet->getSourceParamPtr()->getSize() ; ++ i )
+        names.append(((i%2)?"source_I_":"source_tau_") + QVariant(i/2+1).toString());
+
+    for ( int i = 0 ; i < (int)fitSet->getLifeTimeParamPtr()->getSize() ; ++ i )
+        names.append(((i%2)?"I_":"tau_") + QVariant(i/2+1).toString());
+
+    for ( int i = 0 ; i < (int)fitSet->getDeviceResolutionParamPtr()->getSize() ; ++ i ) {
+        switch ( i%3 ) {
+        case 0:
+            names.append("irf_fwhm_" + QVariant(i/3+1).toString());
+            break;
+
+        case 1:
+            names.append("irf_t0_" + QVariant(i/3+1).toString());
+            break;
+
+        default:
+            names.append("irf_I_" + QVariant(i/3+1).toString());
+            break;
+        }
+    }
+
+    names.append("background");
+    names.append("average_lifetime");
+
+    return names;
+}
+
+QString LifeTimeDecayBatchFitEngine::resultHeader(const PALSFitSet *fitSet)
+{
+    QString header("name;status;reduced_chi_square;fit_time");
+
+    for ( const QString& name : parameterNames(fitSet) )
+        header.append(";" + name + ";" + name + "_error");
+
+    return header;
+}
+
+QString LifeTimeDecayBatchFitEngine::resultRow(const PALSBatchFitResult &result)
+{
+    QString row = result.name % ";" % QString::number(result.status) % ";" % QString::number(result.chiSquare, 'g', 17) % ";" % QString::number(result.fitTime, 'g', 6);
+
+    for ( int i = 0 ; i < result.values.size() ; ++ i )
+        row.append(";" % QString::number(result.values.at(i), 'g', 17) % ";" % QString::number(result.errors.at(i), 'g', 17));
+
+    return row;
+}
+
+void LifeTimeDecayBatchFitEngine::copyFitSet(const PALSFitSet *source, PALSFitSet *target)
+{
+    if ( !source
+         || !target )
+        return;
+
+    target->setStartChannel(source->getStartChannel());
+    target->setStopChannel(source->getStopChannel());
+    target->setChannelResolution(source->getChannelResolution());
+    target->setMaximumIterations(source->getMaximumIterations());
+
+    auto copyParameter = [](const PALSFitParameter *from, PALSFitParameter *to) {
+        to->setActive(from->isActive());
+        to->setName(from->getName());
+        to->setAlias(from->getAlias());
+        to->setStartValue(from->getStartValue());
+        to->setUpperBoundingValue(from->getUpperBoundingValue());
+        to->setUpperBoundingEnabled(from->isUpperBoundingEnabled());
+        to->setLowerBoundingValue(from->getLowerBoundingValue());
+        to->setLowerBoundingEnabled(from->isLowerBoundingEnabled());
+        to->setAsFixed(from->isFixed());
+    };
+
+    for ( int i = 0 ; i < (int)source->getSourceParamPtr()->getSize() ; ++ i )
+        copyParameter(source->getSourceParamPtr()->getParameterAt(i), new PALSFitParameter(target->getSourceParamPtr()));
+
+    for ( int i = 0 ; i < (int)source->getLifeTimeParamPtr()->getSize() ; ++ i )
+        copyParameter(source->getLifeTimeParamPtr()->getParameterAt(i), new PALSFitParameter(target->getLifeTimeParamPtr()));
+
+    for ( int i = 0 ; i < (int)source->getDeviceResolutionParamPtr()->getSize() ; ++ i )
+        copyParameter(source->getDeviceResolutionParamPtr()->getParameterAt(i), new PALSFitParameter(target->getDeviceResolutionParamPtr()));
+
+    copyParameter(source->getBackgroundParamPtr()->getParameter(), target->getBackgroundParamPtr()->getParameter());
+}
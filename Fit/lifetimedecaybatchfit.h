@@ -0,0 +1,178 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+#ifndef LIFETIMEDECAYBATCHFIT_H
+#define LIFETIMEDECAYBATCHFIT_H
+
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QMutex>
+#include <QFile>
+#include <QTextStream>
+
+#include <atomic>
+
+#include "lifetimedecayfit.h"
+#include "fitthreadpool.h"
+
+#include "../Settings/asciidataimport.h"
+
+//#define __BATCHFIT_DEBUG
+
+/* spectrum of a batch: imported from an ASCII file (fileName, binFactor) or given in memory (dataSet) */
+typedef struct {
+    QString name;
+    QString fileName;
+    int binFactor;
+
+    PALSSpectrum dataSet;
+} PALSBatchSpectrum;
+
+/* result of a single fit of the batch */
+typedef struct {
+    int index;
+    QString name;
+
+    int status; /* mpfit status (see PALSFitErrorCodeStringBuilder) or import error (see batchFitStatus) */
+
+    double chiSquare; /* reduced chi-square */
+    double fitTime; /* [s] incl. import */
+
+    QList<double> values; /* fit values in the order of the CSV columns */
+    QList<double> errors;
+} PALSBatchFitResult;
+
+/* additional status codes of a batch fit */
+#define BATCH_ERR_IMPORT (-70) /* ASCII import failed */
+#define BATCH_ERR_CANCELED (-71) /* batch was canceled before the fit started */
+
+/*
+ * LifeTimeDecayBatchFitEngine - fits a list of spectra concurrently:
+ *-------------------------------------------------------------------
+ *
+ * Each spectrum is fitted independently (LifeTimeDecayFitEngine) using a private copy of the template fit set. The fits are
+ * scheduled on a work-stealing FitThreadPool, each fit runs serially on its worker (a batch of a single spectrum: the fit
+ * itself uses the threads). The results are appended to the result
+ * file (CSV: one row per spectrum in the order of completion) as soon as a fit is finished.
+ *
+ * The fit workspaces (FitWorkspace) are pooled: a worker takes an idle workspace for each fit and returns it afterwards, so
+ * the buffers are allocated once per concurrent fit and reused by the following jobs (and batches).
+ */
+
+class LifeTimeDecayBatchFitEngine : public QObject
+{
+    Q_OBJECT
+public:
+    LifeTimeDecayBatchFitEngine();
+    virtual ~LifeTimeDecayBatchFitEngine();
+
+    /* the template is copied on run() */
+    void setTemplate(const PALSFitSet *fitSet);
+
+    void addSpectrum(const QString& fileName, int binFactor = 1);
+    void addSpectrum(const QString& name, const PALSSpectrum& dataSet);
+    void clearSpectra();
+
+    int spectraCount() const;
+
+    void setResultFileName(const QString& fileName);
+
+    /* concurrent fits (0: one per core) */
+    void setThreadCount(int threadCnt);
+
+    /* Levenberg-Marquardt starts of each fit (see LifeTimeDecayFitEngine::setMultiStartCount(...)) */
+    void setMultiStartCount(int startCnt);
+
+    /* finite-difference Jacobian (see LifeTimeDecayFitEngine::setNumericalDerivatives(...)) */
+    void setNumericalDerivatives(bool on);
+
+    /* fits per second of the last/running batch */
+    double throughput() const;
+
+    QList<PALSBatchFitResult> results() const;
+
+    /* identifiers of the result values (tau_1, I_1, ..., background, average_lifetime) in the order of PALSBatchFitResult::values */
+    static QStringList parameterNames(const PALSFitSet *fitSet);
+
+    /* CSV (';' separated) */
+    static QString resultHeader(const PALSFitSet *fitSet);
+    static QString resultRow(const PALSBatchFitResult& result);
+
+    /* single fit of a spectrum on a private copy of fitSet (thread-safe): status, chi-square, values and fit time of the result
+     * threadCnt: threads of the fit itself (1: serial, 0: one per core) */
+    static PALSBatchFitResult fitSpectrum(const PALSFitSet *fitSet, const PALSBatchSpectrum& spectrum, int multiStartCnt, FitWorkspace *workspace,
+                                          int threadCnt = 1, bool numericalDerivatives = false);
+
+    static void copyFitSet(const PALSFitSet *source, PALSFitSet *target);
+
+public slots:
+    void run();
+    void cancel();
+
+signals:
+    void fitFinished(int index, const QString& name, int status, double fitTime);
+    void progress(int finishedFits, int fitCnt, double fitsPerSecond);
+    void finished();
+
+private:
+    void fitSpectrum(int index);
+    void writeResult(const PALSBatchFitResult& result);
+
+    FitWorkspace *acquireWorkspace();
+    void releaseWorkspace(FitWorkspace *workspace);
+
+private:
+    const PALSFitSet *m_template;
+    PALSProject *m_templateProject; /* private copy of the template during run() */
+
+    QList<PALSBatchSpectrum> m_spectra;
+    QList<PALSBatchFitResult> m_results;
+
+    QString m_resultFileName;
+    QFile m_resultFile;
+    QTextStream m_resultStream;
+
+    int m_threadCnt;
+    int m_fitThreadCnt; /* threads of each fit during run() */
+    int m_multiStartCnt;
+    bool m_numericalDerivatives;
+
+    std::atomic<bool> m_canceled;
+
+    QElapsedTimer m_timer;
+    int m_finishedFits;
+    double m_throughput;
+
+    mutable QMutex m_mutex;
+
+    QList<FitWorkspace*> m_idleWorkspaces;
+    QList<FitWorkspace*> m_workspaces;
+    QMutex m_workspaceMutex;
+};
+
+#endif // LIFETIMEDECAYBATCHFIT_H
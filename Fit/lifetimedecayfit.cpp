@@ -37,89 +37,271 @@
  * ltFitParamArray - array of lifetime (tau and I) and IRF parameter (incl. background)
  *
  * dy - array of (weighted) residuals to be returned
- * vars - private data (struct values *) containing the x/y-values and the y-uncertainties (Poisson nois/statistical error)
+ * dvec - analytic partial derivatives d(dy)/d(param) requested by mpfit (side = 3): dvec[param] != 0 for each free parameter (or dvec = 0 if not requested)
+ * vars - private data (struct values *) containing the x/y-values, the y-uncertainties (Poisson nois/statistical error) and the model engine
  *
  * returns 1 for success (and 0 for failed <= it never fails)
  */
 
 int multiExpDecay(int dataCnt, int paramCnt, double *fitParamArray, double *dy, double **dvec, void *vars) {
-        DUNUSED_PARAM(dvec);
+        DUNUSED_PARAM(paramCnt);
 
         values *v = (values*) vars;
 
-        double *x = v->x;
-        double *y = v->y;
-        double *ey = v->ey;
+        v->model->residuals(dataCnt, fitParamArray, dy, dvec);
 
-        const int cntGaussian = v->countOfDeviceResolutionParams;
-        const double bkgrd = fitParamArray[paramCnt-1];
+        return 1;
+}
 
-        const double roi = (v->stopChannel - v->startChannel + 1);
-        const double bkgrdArea = roi*bkgrd;
-        const double area = (double)v->integralCountsInROI;
-        const double areaWithoutBkgrd = (area - bkgrdArea);
+/*
+ * multi-start: mpfit iteration callback (vars: struct values *)
+ *---------------------------------------------------------------
+ *
+ * stops a run (MP_ERR_DOMINATED) whose chi-square exceeds the best chi-square of the finished runs by __MULTI_START_DOMINANCE_FACTOR
+ */
 
-        const int reducedDataCnt = (dataCnt - 2);
-        const int reducedParamCount = (paramCnt - 1);
-        const int reducedDevCount = (paramCnt - cntGaussian - 1);
+int multiStartDominance(int iter, double chiSquare, int paramCnt, const double *fitParamArray, void *vars) {
+        DUNUSED_PARAM(paramCnt);
+        DUNUSED_PARAM(fitParamArray);
 
-        for ( int i = 0 ; i < reducedDataCnt ; ++ i ) {
-            double f = 0.0;
+        const values *v = (const values*) vars;
 
-            x[i] -= v->startChannel;
-            x[i+1] -= v->startChannel;
+        if ( !v->bestChiSquare
+             || iter < __MULTI_START_MIN_ITERATIONS )
+            return 0;
 
-            for ( int device = reducedDevCount ; device < reducedParamCount ; device += 3 ) {
-                const double gaussianSigma = fitParamArray[device]/(2*sqrt(log(2))); /* transform FWHM to 1-sigma uncertainty */
-                const double gaussianMu = fitParamArray[device+1];
+        return (chiSquare > __MULTI_START_DOMINANCE_FACTOR*v->bestChiSquare->load()) ? MP_ERR_DOMINATED : 0;
+}
 
-                const double gaussianIntensity = fitParamArray[device+2]; /* IRF contribution/intensity */
+/*
+ * parallel loop of mpfit (finite-difference Jacobian columns) on the FitThreadPool:
+ *----------------------------------------------------------------------------------
+ *
+ * the participant index of the pool is the worker index of mpfit (selects the private copy of the struct values)
+ */
 
-                double valF = 0.0;
+void mpfitParallelFor(int taskCnt, mp_parfortask task, void *taskData, void *threadPool) {
+        FitThreadPool *pool = (FitThreadPool*) threadPool;
 
-                /* Kirkegaard and Eldrup (1972) */
-                for ( int param = 0 ; param <  reducedDevCount ; param += 2 ) { /* 1st param[0] = tau; 2nd param[1] = Intensity */
-                    const double yji = exp(-(x[i]-gaussianMu-(gaussianSigma*gaussianSigma)/(4*fitParamArray[param]))/fitParamArray[param])*(1-erf((0.5*gaussianSigma/fitParamArray[param])-(x[i]-gaussianMu)/gaussianSigma));
-                    const double yji_plus_1 = exp(-(x[i+1]-gaussianMu-(gaussianSigma*gaussianSigma)/(4*fitParamArray[param]))/fitParamArray[param])*(1-erf((0.5*gaussianSigma/fitParamArray[param])-(x[i+1]-gaussianMu)/gaussianSigma));
+        pool->parallelFor(taskCnt, [task, taskData](int index, int participant) {
+            task(index, participant, taskData);
+        });
+}
 
-                    valF += 0.5*fitParamArray[param+1]*(yji-yji_plus_1-erf((x[i]-gaussianMu)/gaussianSigma)+erf((x[i+1]-gaussianMu)/gaussianSigma));
-                }
+LifeTimeDecayFitEngine::LifeTimeDecayFitEngine() :
+    m_dataStructure(nullptr),
+    m_threadCnt(1),
+    m_multiStartCnt(1),
+#ifndef __FIT_NUMERICAL_DERIVATIVES
+    m_numericalDerivatives(false),
+#else
+    m_numericalDerivatives(true),
+#endif
+    m_workspace(&m_privateWorkspace),
+    m_warmStart(false),
+    m_warmStartResolution(0.0) {}
 
-                valF *= gaussianIntensity; /* account for multiple Gaussian IRFs forming the final IRF */
-                f += valF;
-            }
+void LifeTimeDecayFitEngine::init(PALSDataStructure *dataStructure)
+{
+    m_dataStructure = dataStructure;
+}
+
+void LifeTimeDecayFitEngine::setThreadCount(int threadCnt)
+{
+    m_threadCnt = (threadCnt < 0) ? 0 : threadCnt;
+}
+
+int LifeTimeDecayFitEngine::threadCount() const
+{
+    return m_threadCnt;
+}
+
+void LifeTimeDecayFitEngine::setMultiStartCount(int startCnt)
+{
+    m_multiStartCnt = qBound(1, startCnt, __MAX_NUMBER_OF_MULTI_STARTS);
+}
 
-            x[i] += v->startChannel;
-            x[i+1] += v->startChannel;
+int LifeTimeDecayFitEngine::multiStartCount() const
+{
+    return m_multiStartCnt;
+}
+
+void LifeTimeDecayFitEngine::setNumericalDerivatives(bool on)
+{
+    m_numericalDerivatives = on;
+}
+
+bool LifeTimeDecayFitEngine::isNumericalDerivatives() const
+{
+    return m_numericalDerivatives;
+}
+
+void LifeTimeDecayFitEngine::setWorkspace(FitWorkspace *workspace)
+{
+    m_workspace = workspace ? workspace : &m_privateWorkspace;
+}
+
+FitWorkspace *LifeTimeDecayFitEngine::workspace() const
+{
+    return m_workspace;
+}
 
-            f *= areaWithoutBkgrd;
-            f += bkgrd;
+void LifeTimeDecayFitEngine::setWarmStart(bool on)
+{
+    m_warmStart = on;
+}
 
-            /* weighted residual calculation: note: ey[...] is already calculated as = 1/sqrt(y[i]) */
-            dy[i] = ey[i]*(y[i]-f);
+bool LifeTimeDecayFitEngine::isWarmStart() const
+{
+    return m_warmStart;
+}
+
+void LifeTimeDecayFitEngine::resetWarmStart()
+{
+    m_warmStartParams.clear();
+    m_warmStartResolution = 0.0;
+}
+
+int LifeTimeDecayFitEngine::optimize(int dataCnt, int paramCnt, double *params, mp_par *paramContraints, mp_config *config, values *v, mp_result *result, mp_workspace *ws)
+{
+    /* calculate the correct reduced chi square on start (orignorm) */
+    v->chiSquareOrig = v->model->chiSquare(params); /* initial residuals/chi-square */
+
+    /* auto optimize chi-square : fit-values turn to start-values until chi-square convergence */
+    double currentChiSquare = v->chiSquareOrig;
+    double chiSquareMem = v->chiSquareOrig;
+
+    int fitRun = 0;
+    int stat = MP_ERR_INPUT;
+#ifdef __FITQUEUE_DEBUG
+            qDebug() << "******* mpfit started *********";
+#endif
+    v->chiSquareStart[fitRun] = v->chiSquareOrig;
+
+    do {
+        /* run mpfit least-square minimization */
+        stat = mpfit_ws(multiExpDecay,
+                        dataCnt,
+                        paramCnt,
+                        params,
+                        paramContraints,
+                        config,
+                        (void*) v,
+                        result,
+                        ws);
+
+        /* calculate the correct residuals and finally the correct reduced chi-square */
+        const double chiResiduals = v->model->chiSquare(params);
+
+        chiSquareMem = v->chiSquareStart[fitRun];
+        currentChiSquare = chiResiduals;
+
+        v->chiSquareFinal[fitRun] = currentChiSquare;
+        v->chiSquareStart[fitRun+1] = v->chiSquareFinal[fitRun];
+
+        v->niter[fitRun] = result->niter;
+
+        fitRun ++;
+        v->mpfitRuns ++;
+
+#ifdef __FITQUEUE_DEBUG
+            qDebug() << "run: " % QVariant(fitRun).toString();
+            qDebug() << "chi-square: " % QVariant(currentChiSquare).toString() % QString(" (") % QVariant(chiSquareMem).toString() % QString(")");
+            qDebug() << "niterations: " % QVariant(v->niter[fitRun-1]).toString();
+            qDebug() << "status: " % QVariant(stat).toString() % " (" % PALSFitErrorCodeStringBuilder::errorString(stat) % ")";
+#endif
+
+        /* maximum exceeded ? */
+        if ( fitRun == __MAX_NUMBER_OF_FIT_RUNS ) {
+#ifdef __FITQUEUE_DEBUG
+            qDebug() << "LIMIT EXCEEDED";
+#endif
+            break;
         }
 
-        /* constraint: sum of all (Gaussian) IRFs be equal 1 */
-        if (cntGaussian > 1) {
-            double sumGaussianContribution = 0.0;
-            for ( int device = reducedDevCount ; device < reducedParamCount ; device += 3 ) {
-                sumGaussianContribution += fitParamArray[device+2];
-            }
+        if (stat < MP_OK_CHI) {
+#ifdef __FITQUEUE_DEBUG
+            qDebug() << "FIT STATUS: ! (not) OK";
+#endif
+            break;
+        }
 
-            dy[reducedDataCnt-1] = (sumGaussianContribution - 1)*1E4; /* 1E4 represents a tolarance factor to balance the satisfaction (sum IRFs = 1) of the constraint vs. the tolerance of the fitting parameters */
+        /* multi-start: a dominated run is not restarted */
+        if ( v->bestChiSquare
+             && result->bestnorm > __MULTI_START_DOMINANCE_FACTOR*v->bestChiSquare->load() ) {
+            stat = MP_ERR_DOMINATED;
+            break;
         }
-        else
-            dy[reducedDataCnt-1] = 0.0;
 
-        return 1;
+#ifdef __FITQUEUE_DEBUG
+            qDebug() << "";
+#endif
+    }
+    while (chiSquareMem - currentChiSquare > 1E-5);
+#ifdef __FITQUEUE_DEBUG
+            qDebug() << "******* mpfit finished *********";
+#endif
+
+
+    /* multi-start: the chi-square of a finished run bounds the other runs */
+    if ( v->bestChiSquare
+         && stat >= MP_OK_CHI ) {
+        double bestChiSquare = v->bestChiSquare->load();
+
+        while ( result->bestnorm < bestChiSquare
+                && !v->bestChiSquare->compare_exchange_weak(bestChiSquare, result->bestnorm) ) {}
+    }
+
+    return stat;
 }
 
-LifeTimeDecayFitEngine::LifeTimeDecayFitEngine() :
-    m_dataStructure(nullptr) {}
+/*
+ * multi-start vectors (startCnt x paramCnt):
+ *-------------------------------------------
+ *
+ * vector 0 contains the start values, the vectors 1 ... startCnt-1 are a Latin-hypercube sample of the free parameters (except the background):
+ * within the bounds if both are enabled, otherwise within +/-__MULTI_START_PERTURBATION of the start value (clipped by a single bound)
+ */
 
-void LifeTimeDecayFitEngine::init(PALSDataStructure *dataStructure)
+void LifeTimeDecayFitEngine::multiStartVectors(int startCnt, int paramCnt, const double *params, const mp_par *paramContraints, int bkgrdIndex, double *startParams)
 {
-    m_dataStructure = dataStructure;
+    for ( int r = 0 ; r < startCnt ; ++ r )
+        memcpy(startParams + r*paramCnt, params, paramCnt*sizeof(double));
+
+    const int sampleCnt = startCnt - 1;
+
+    if ( sampleCnt < 1 )
+        return;
+
+    std::mt19937 generator(__MULTI_START_SEED);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    std::vector<int> strata(sampleCnt);
+
+    for ( int p = 0 ; p < paramCnt ; ++ p ) {
+        if ( paramContraints[p].fixed
+             || p == bkgrdIndex )
+            continue;
+
+        double lower = params[p] - __MULTI_START_PERTURBATION*fabs(params[p]);
+        double upper = params[p] + __MULTI_START_PERTURBATION*fabs(params[p]);
+
+        if ( paramContraints[p].limited[0] && paramContraints[p].limited[1] ) {
+            lower = paramContraints[p].limits[0];
+            upper = paramContraints[p].limits[1];
+        }
+        else if ( paramContraints[p].limited[0] )
+            lower = qMax(lower, paramContraints[p].limits[0]);
+        else if ( paramContraints[p].limited[1] )
+            upper = qMin(upper, paramContraints[p].limits[1]);
+
+        /* one sample per stratum, strata randomly assigned to the runs */
+        std::iota(strata.begin(), strata.end(), 0);
+        std::shuffle(strata.begin(), strata.end(), generator);
+
+        for ( int r = 1 ; r < startCnt ; ++ r )
+            startParams[r*paramCnt + p] = lower + (upper - lower)*(((double)strata[r-1] + uniform(generator))/(double)sampleCnt);
+    }
 }
 
 void LifeTimeDecayFitEngine::fit()
@@ -151,41 +333,55 @@ void LifeTimeDecayFitEngine::fit()
 
      const int dataCntInRange = (stopChannel-startChannel+1) + 1; /* ROI + ( +1 = constraint for multiple Gaussian IRFs) */
 
-     double *x = new double[dataCntInRange];
-     double *y = new double[dataCntInRange];
-     double *ey = new double[dataCntInRange];
+     /* warm start: the result of the last fit replaces the multi-start */
+     const bool warmStart = m_warmStart
+             && (int)m_warmStartParams.size() == paramCnt
+             && m_warmStartResolution == channelResolution;
+
+     /* the buffers of the fit are taken from the workspace (no allocations on repeated fits of the same shape) */
+     const int startCnt = warmStart ? 1 : qBound(1, m_multiStartCnt, __MAX_NUMBER_OF_MULTI_STARTS);
+
+     FitWorkspace *ws = m_workspace;
+     ws->reserve(dataCntInRange, paramCnt, startCnt);
+
+     double *x = ws->x();
+     double *y = ws->y();
+     double *ey = ws->ey();
 
      int inRangeCnt = 0;
      int integralCountROI = 0;
 
-     int channelCnt = 0;
+     /* contiguous arrays of the spectrum (ascending channels): ROI = [lowerBound(start), lowerBound(stop + 1)) */
+     const PALSSpectrum spectrum = dataStructure->getDataSetPtr()->getLifeTimeData();
+
+     const double *channels = spectrum.channels();
+     const double *counts = spectrum.counts();
 
-     for ( QPointF p : dataStructure->getDataSetPtr()->getLifeTimeData() ) {
-         if ( ((int)p.x()) >= ((int)startChannel) && ((int)p.x()) <= ((int)stopChannel) ) { /* ROI? */
-             x[inRangeCnt] = p.x();
-             y[inRangeCnt] = p.y();
+     const int firstIndex = spectrum.lowerBound((double)(int)startChannel);
+     const int lastIndex = qMin(spectrum.lowerBound((double)((int)stopChannel + 1)), firstIndex + dataCntInRange - 1);
 
-             /* calculate error (weighting) (Poisson noise/statistical error) */
-             ey[inRangeCnt] = 1.0/sqrt(p.y() + 1.0); // prevent zero division
+     for ( int index = firstIndex ; index < lastIndex ; ++ index ) {
+         x[inRangeCnt] = channels[index];
+         y[inRangeCnt] = counts[index];
 
-             integralCountROI += (int)p.y();
+         /* calculate error (weighting) (Poisson noise/statistical error) */
+         ey[inRangeCnt] = 1.0/sqrt(counts[index] + 1.0); // prevent zero division
 
-             if ( ((int)p.x()) == ((int)startChannel) )
-                 startChannelIndex = channelCnt;
+         integralCountROI += (int)counts[index];
 
-             if ( ((int)p.x()) == ((int)stopChannel) )
-                 stopChannelIndex = channelCnt;
+         if ( ((int)channels[index]) == ((int)startChannel) )
+             startChannelIndex = index;
 
-             if ( ((int)p.y()) > ((int)countsInPeak) ) {
-                 countsInPeak = p.y();
-                 peakChannel = p.x();
-                 peakChannelIndex = channelCnt;
-             }
+         if ( ((int)channels[index]) == ((int)stopChannel) )
+             stopChannelIndex = index;
 
-             inRangeCnt ++;
+         if ( ((int)counts[index]) > ((int)countsInPeak) ) {
+             countsInPeak = counts[index];
+             peakChannel = channels[index];
+             peakChannelIndex = index;
          }
 
-         channelCnt ++;
+         inRangeCnt ++;
      }
 
      /* additional residual to account for constraint regarding sum of multiple IRFs = 1 (0.0 = placeholder) */
@@ -194,10 +390,23 @@ void LifeTimeDecayFitEngine::fit()
      ey[inRangeCnt] = 0.0f;
 
      inRangeCnt ++;
-     channelCnt ++;
 
 
+     /* model engine: bins between the edges x[0] ... x[ROI-1] */
+     LifetimeModel &model = *ws->model(0, dataStructure->getFitSetPtr()->getComponentsCount()/2, dataStructure->getFitSetPtr()->getDeviceResolutionParamPtr()->getSize()/3);
+     model.setData(x, y, ey, dataCntInRange - 2, startChannel, (double)integralCountROI, (stopChannel - startChannel + 1));
+
+     /* parallel evaluation of the channel range (the calling thread takes part => threads - 1 workers) */
+     const int threadCnt = (m_threadCnt > 0) ? m_threadCnt : FitThreadPool::idealThreadCount();
+
+     FitThreadPool *threadPool = nullptr;
+     if ( threadCnt > 1 && model.binCount() > __LIFETIME_MODEL_BLOCK_SIZE ) {
+         threadPool = new FitThreadPool(threadCnt - 1);
+         model.setThreadPool(threadPool);
+     }
+
      values v;
+     memset(&v, 0, sizeof(values));
 
      v.x = x;
      v.y = y;
@@ -218,14 +427,19 @@ void LifeTimeDecayFitEngine::fit()
 
      v.weighting = residualWeighting::yerror_Weighting; /* fixed */
 
+     v.model = &model;
+     v.multiStartRuns = 1;
+
 
-    mp_par *paramContraints = new mp_par[paramCnt];
+    mp_par *paramContraints = ws->paramConstraints();
 
     for ( int t = 0 ; t < paramCnt ; ++ t ) {
         paramContraints[t] = {0};
+        paramContraints[t].side = m_numericalDerivatives ? 0 /* one-sided finite differences */
+                                                         : 3 /* analytic derivatives provided by multiExpDecay(...) */;
     }
 
-    double *params = new double[paramCnt]; /* following order: source => sample => gaussian => bkgrd */
+    double *params = ws->params(); /* following order: source => sample => gaussian => bkgrd */
 
     int i = 0;
     for ( i = 0 ; i < dataStructure->getFitSetPtr()->getSourceParamPtr()->getSize() ; i+=2 ) {
@@ -672,54 +886,67 @@ void LifeTimeDecayFitEngine::fit()
     else
         paramContraints[bkgrdIndex].limited[1] = 0;
 
+#ifdef __FITDERIV_DEBUG
+    /* cross-check the analytic derivatives against two-sided numerical ones (mpfit console output) */
+    for ( int t = 0 ; t < paramCnt ; ++ t ) {
+        paramContraints[t].side = 2;
+        paramContraints[t].deriv_debug = 1;
+    }
+#endif
 
-    /* calculate the correct reduced chi square on start (orignorm) */
-    double residuals = 0.0;
-    const int reducedCntInRange = (dataCntInRange - 2);
-    const int reducedDevCount = (paramCnt - cntGaussian - 1);
-    const int reducedParamCount = (paramCnt - 1);
-    const double integralCountsWithoutBkgrd = (double)v.integralCountsInROI-(double)(dataCntInRange-1)*params[bkgrdIndex];
+    /* finite-difference Jacobian: the columns are evaluated in parallel, each worker evaluates its own copy of the model
+     * multi-start: the runs are executed in parallel on the same pool */
+    bool numericalDerivatives = false;
+    for ( int t = 0 ; t < paramCnt ; ++ t ) {
+        if ( paramContraints[t].side != 3 && !paramContraints[t].fixed )
+            numericalDerivatives = true;
+    }
 
-    for ( int i = 0 ; i < reducedCntInRange ; ++ i ) {
-        double f = 0.0;
+    if ( warmStart ) {
+        /* the fixed parameters keep their start values, the free ones are clipped by their bounds */
+        for ( int t = 0 ; t < paramCnt ; ++ t ) {
+            if ( paramContraints[t].fixed )
+                continue;
 
-        x[i] -= startChannel;
-        const double x_plus_1 = x[i+1]-startChannel;
+            double value = m_warmStartParams[t];
 
-        for ( int device = reducedDevCount ; device < reducedParamCount ; device += 3 ) {
-            const double gaussianSigmaVal = params[device]/(2*sqrt(log(2))); /* transform FWHM to 1-sigma uncertainty */
-            const double gaussianMuVal = params[device+1];
+            if ( paramContraints[t].limited[0] )
+                value = qMax(value, paramContraints[t].limits[0]);
 
-            const double gaussianIntensity = params[device+2]; /* IRF contribution */
+            if ( paramContraints[t].limited[1] )
+                value = qMin(value, paramContraints[t].limits[1]);
 
-            double valF = 0.0;
+            params[t] = value;
+        }
 
-            /* Kirkegaard and Eldrup (1972) */
-            for ( int param = 0 ; param <  reducedDevCount ; param += 2 ) { /* 1st param[0] = tau; 2nd param[1] = Intensity */
-                const double yji = exp(-(x[i]-gaussianMuVal-(gaussianSigmaVal*gaussianSigmaVal)/(4*params[param]))/params[param])*(1-erf((0.5*gaussianSigmaVal/params[param])-(x[i]-gaussianMuVal)/gaussianSigmaVal));
-                const double yji_plus_1 = exp(-(x_plus_1-gaussianMuVal-(gaussianSigmaVal*gaussianSigmaVal)/(4*params[param]))/params[param])*(1-erf((0.5*gaussianSigmaVal/params[param])-(x_plus_1-gaussianMuVal)/gaussianSigmaVal));
+#ifdef __FITQUEUE_DEBUG
+        qDebug() << "warm start from the last fit";
+#endif
+    }
 
-                valF += 0.5*params[param+1]*(yji-yji_plus_1-erf((x[i]-gaussianMuVal)/gaussianSigmaVal)+erf((x_plus_1-gaussianMuVal)/gaussianSigmaVal));
-            }
+    if ( (numericalDerivatives || startCnt > 1) && threadCnt > 1 && !threadPool )
+        threadPool = new FitThreadPool(threadCnt - 1);
 
-            valF *= gaussianIntensity;
-            f += valF;
-        }
+    const int workerCnt = (numericalDerivatives && threadPool) ? threadPool->maxParticipants() : 0;
 
-        x[i] += startChannel;
+    values *workerValues = new values[workerCnt];
+    LifetimeModel **workerModels = new LifetimeModel*[workerCnt];
+    void **workerPrivate = new void*[workerCnt];
 
-        f *= integralCountsWithoutBkgrd;
-        f += params[bkgrdIndex];
+    for ( int w = 0 ; w < workerCnt ; ++ w ) {
+        workerModels[w] = ws->model(startCnt + w, model.componentCount(), model.gaussianCount());
+        workerModels[w]->setData(x, y, ey, model.binCount(), startChannel, (double)integralCountROI, (stopChannel - startChannel + 1));
 
-        residuals += (y[i]-f)*(y[i]-f)*ey[i]*ey[i];
-    }
+        workerValues[w] = v;
+        workerValues[w].model = workerModels[w];
 
-    v.chiSquareOrig = residuals; /* initial residuals/chi-square */
+        workerPrivate[w] = &workerValues[w];
+    }
 
 
     /* returned parameter uncertainties (1-sigma): */
-    double *paramErrors = new double[paramCnt];
-    double *finalResiduals = new double[dataCntInRange];
+    double *paramErrors = ws->paramErrors();
+    double *finalResiduals = ws->residuals();
 
     mp_result result;
     memset(&result,0,sizeof(result));
@@ -732,128 +959,155 @@ void LifeTimeDecayFitEngine::fit()
 
     config.maxiter = dataStructure->getFitSetPtr()->getMaximumIterations();
 
+    if ( workerCnt > 0 ) {
+        config.parfor = mpfitParallelFor;
+        config.parfor_data = threadPool;
+        config.nworkers = workerCnt;
+        config.worker_private = workerPrivate;
+    }
 
-    /* auto optimize chi-square : fit-values turn to start-values until chi-square convergence */
-    double currentChiSquare = v.chiSquareOrig;
-    double chiSquareMem = v.chiSquareOrig;
 
-    int fitRun = 0;
-#ifdef __FITQUEUE_DEBUG
-            qDebug() << "******* mpfit started *********";
-#endif
-    v.chiSquareStart[fitRun] = v.chiSquareOrig;
+    if ( startCnt == 1 ) {
+        optimize(dataCntInRange, paramCnt, params, paramContraints, &config, &v, &result, ws->mpfitWorkspace(0));
+    }
+    else {
+        /* multi-start: run 0 starts from the start values of the fit set, the others from Latin-hypercube samples */
+        std::atomic<double> bestChiSquare(std::numeric_limits<double>::max());
 
-    do {
-        /* run mpfit least-square minimization */
-        const int stat = mpfit(multiExpDecay,
-                                  dataCntInRange,
-                                  paramCnt,
-                                  params,
-                                  paramContraints,
-                                  &config,
-                                  (void*) &v,
-                                  &result);
+        double *startParams = ws->runParams(0);
+        multiStartVectors(startCnt, paramCnt, params, paramContraints, bkgrdIndex, startParams);
 
-        /* calculate the correct residuals and finally the correct reduced chi-square */
-        const int reducedCntInRange = (dataCntInRange - 2);
-        const int reducedDevCount = (paramCnt - cntGaussian - 1);
-        const int reducedParamCount = (paramCnt - 1);
-        const double integralCountsWithoutBkgrd = (double)v.integralCountsInROI-(double)(dataCntInRange-1)*params[bkgrdIndex];
+        values *runValues = new values[startCnt];
+        mp_result *runResults = new mp_result[startCnt];
+        int *runStatus = new int[startCnt];
 
-        double chiResiduals = 0.0;
+        for ( int r = 0 ; r < startCnt ; ++ r ) {
+            runValues[r] = v;
+            runValues[r].bestChiSquare = &bestChiSquare;
 
-        for ( int i = 0 ; i < reducedCntInRange ; ++ i ) {
-            double f = 0.0;
+            /* run 0 evaluates the model of the fit (parallel channel range/Jacobian columns), the others are serial */
+            if ( r > 0 ) {
+                LifetimeModel *runModel = ws->model(r, model.componentCount(), model.gaussianCount());
+                runModel->setData(x, y, ey, model.binCount(), startChannel, (double)integralCountROI, (stopChannel - startChannel + 1));
 
-            x[i] -= startChannel;
-            const double x_plus_1 = x[i+1]-startChannel;
+                runValues[r].model = runModel;
+            }
+
+            memset(&runResults[r], 0, sizeof(mp_result));
+
+            runResults[r].xerror = ws->runErrors(r);
+            runResults[r].resid = ws->runResiduals(r);
+        }
 
-            for ( int device = reducedDevCount ; device < reducedParamCount ; device += 3 ) {
-                const double gaussianSigmaVal = params[device]/(2*sqrt(log(2))); /* transform FWHM to 1-sigma uncertainty */
-                const double gaussianMuVal = params[device+1];
+        mp_config runConfig = config;
+        runConfig.iterproc = multiStartDominance;
 
-                const double gaussianIntensity = params[device+2]; /* IRF contribution */
+        mp_config serialRunConfig = runConfig;
+        serialRunConfig.parfor = nullptr;
+        serialRunConfig.parfor_data = nullptr;
+        serialRunConfig.nworkers = 0;
+        serialRunConfig.worker_private = nullptr;
 
-                double valF = 0.0;
+        auto run = [&](int r) {
+            runStatus[r] = optimize(dataCntInRange, paramCnt, startParams + r*paramCnt, paramContraints, (r == 0)?&runConfig:&serialRunConfig, &runValues[r], &runResults[r], ws->mpfitWorkspace(r));
+        };
+
+        if ( threadPool )
+            threadPool->parallelFor(startCnt, [&run](int r, int) { run(r); });
+        else {
+            for ( int r = 0 ; r < startCnt ; ++ r )
+                run(r);
+        }
 
-                /* Kirkegaard and Eldrup (1972) */
-                for ( int param = 0 ; param <  reducedDevCount ; param += 2 ) { /* 1st param[0] = tau; 2nd param[1] = Intensity */
-                    const double yji = exp(-(x[i]-gaussianMuVal-(gaussianSigmaVal*gaussianSigmaVal)/(4*params[param]))/params[param])*(1-erf((0.5*gaussianSigmaVal/params[param])-(x[i]-gaussianMuVal)/gaussianSigmaVal));
-                    const double yji_plus_1 = exp(-(x_plus_1-gaussianMuVal-(gaussianSigmaVal*gaussianSigmaVal)/(4*params[param]))/params[param])*(1-erf((0.5*gaussianSigmaVal/params[param])-(x_plus_1-gaussianMuVal)/gaussianSigmaVal));
+        /* keep the best finished run (or run 0 if none has finished) */
+        int bestRun = -1;
+        int dominatedRuns = 0;
 
-                    valF += 0.5*params[param+1]*(yji-yji_plus_1-erf((x[i]-gaussianMuVal)/gaussianSigmaVal)+erf((x_plus_1-gaussianMuVal)/gaussianSigmaVal));
-                }
+        std::vector<double> minima;
 
-                valF *= gaussianIntensity;
-                f += valF;
+        for ( int r = 0 ; r < startCnt ; ++ r ) {
+            if ( runStatus[r] == MP_ERR_DOMINATED ) {
+                dominatedRuns ++;
+                continue;
             }
 
-            x[i] += startChannel;
+            if ( runStatus[r] < MP_OK_CHI )
+                continue;
 
-            f *= integralCountsWithoutBkgrd;
-            f += params[bkgrdIndex];
+            const double chiSquare = runValues[r].chiSquareFinal[runValues[r].mpfitRuns-1];
 
-            chiResiduals += (y[i]-f)*(y[i]-f)*ey[i]*ey[i];
+            if ( bestRun < 0
+                 || chiSquare < runValues[bestRun].chiSquareFinal[runValues[bestRun].mpfitRuns-1] )
+                bestRun = r;
+
+            minima.push_back(chiSquare);
         }
 
-        chiSquareMem = v.chiSquareStart[fitRun];
-        currentChiSquare = chiResiduals;
+        if ( bestRun < 0 )
+            bestRun = 0;
 
-        v.chiSquareFinal[fitRun] = currentChiSquare;
-        v.chiSquareStart[fitRun+1] = v.chiSquareFinal[fitRun];
+        memcpy(params, startParams + bestRun*paramCnt, paramCnt*sizeof(double));
+        memcpy(paramErrors, ws->runErrors(bestRun), paramCnt*sizeof(double));
+        memcpy(finalResiduals, ws->runResiduals(bestRun), dataCntInRange*sizeof(double));
 
-        v.niter[fitRun] = result.niter;
+        result = runResults[bestRun];
+        result.xerror = paramErrors;
+        result.resid = finalResiduals;
 
-        fitRun ++;
-        v.mpfitRuns ++;
+        v = runValues[bestRun];
+        v.model = &model;
+        v.bestChiSquare = nullptr;
 
-#ifdef __FITQUEUE_DEBUG
-            qDebug() << "run: " % QVariant(fitRun).toString();
-            qDebug() << "chi-square: " % QVariant(currentChiSquare).toString() % QString(" (") % QVariant(chiSquareMem).toString() % QString(")");
-            qDebug() << "niterations: " % QVariant(v.niter[fitRun-1]).toString();
-            qDebug() << "status: " % QVariant(stat).toString() % " (" % PALSFitErrorCodeStringBuilder::errorString(stat) % ")";
-#endif
+        /* spread of the minima */
+        std::sort(minima.begin(), minima.end());
 
-        /* maximum exceeded ? */
-        if ( fitRun == __MAX_NUMBER_OF_FIT_RUNS ) {
-#ifdef __FITQUEUE_DEBUG
-            qDebug() << "LIMIT EXCEEDED";
-#endif
-            break;
+        v.multiStartRuns = startCnt;
+        v.multiStartBestRun = bestRun;
+        v.multiStartDominatedRuns = dominatedRuns;
+        v.multiStartMinima = minima.empty() ? 0 : 1;
+
+        for ( int m = 1 ; m < (int)minima.size() ; ++ m ) {
+            if ( minima[m] - minima[m-1] > __MULTI_START_MINIMA_TOLERANCE*minima[m-1] )
+                v.multiStartMinima ++;
         }
 
-        if (stat < MP_OK_CHI) {
-#ifdef __FITQUEUE_DEBUG
-            qDebug() << "FIT STATUS: ! (not) OK";
-#endif
-            break;
+        if ( !minima.empty() ) {
+            v.multiStartChiSquareMin = minima.front();
+            v.multiStartChiSquareMedian = minima[minima.size()/2];
+            v.multiStartChiSquareMax = minima.back();
         }
 
 #ifdef __FITQUEUE_DEBUG
-            qDebug() << "";
+        qDebug() << "multi-start: best run " % QVariant(bestRun).toString() % "/" % QVariant(startCnt).toString() % ", dominated: " % QVariant(dominatedRuns).toString() % ", distinct minima: " % QVariant(v.multiStartMinima).toString();
 #endif
+
+        delete [] runValues;
+        delete [] runResults;
+        delete [] runStatus;
     }
-    while (chiSquareMem - currentChiSquare > 1E-5);
-#ifdef __FITQUEUE_DEBUG
-            qDebug() << "******* mpfit finished *********";
-#endif
 
-    updateDataStructureFromResult(dataStructure, &result, &v, params);
+    /* start vector of the next warm-started fit: converged fits only (not MP_MAXITER or a tolerance stop), and only fits with
+     * warm start enabled, so a fit started from the fit set in between (e.g. a manual fit during watch mode) keeps it */
+    if ( m_warmStart
+         && result.status >= MP_OK_CHI
+         && result.status <= MP_OK_DIR ) {
+        m_warmStartParams.assign(params, params + paramCnt);
+        m_warmStartResolution = channelResolution;
+    }
 
-    delete [] x;
-    delete [] y;
-    delete [] ey;
+    updateDataStructureFromResult(dataStructure, &result, &v, params);
 
-    delete [] params;
-    delete [] paramContraints;
+    delete [] workerModels;
+    delete [] workerValues;
+    delete [] workerPrivate;
 
-    delete [] paramErrors;
-    delete [] finalResiduals;
+    model.setThreadPool(nullptr);
+    delete threadPool;
 
     emit finished();
 }
 
-QList<QPointF> LifeTimeDecayFitEngine::getFitPlotPoints() const {
+PALSSpectrum LifeTimeDecayFitEngine::getFitPlotPoints() const {
     return m_fitPlotSet;
 }
 
@@ -867,7 +1121,6 @@ void LifeTimeDecayFitEngine::updateDataStructureFromResult(PALSDataStructure *da
     dataStructure->getFitSetPtr()->setFitFinishCode(PALSFitErrorCodeStringBuilder::errorString(result->status));
 
     const double channelResolution = dataStructure->getFitSetPtr()->getChannelResolution();
-    const int paramCnt = dataStructure->getFitSetPtr()->getComponentsCount() + dataStructure->getFitSetPtr()->getDeviceResolutionParamPtr()->getSize() + 1; // incl. background
 
     double sumOfIntensities = 0.0f;
     double sumErrorOfIntensities = 0.0f;
@@ -952,66 +1205,45 @@ void LifeTimeDecayFitEngine::updateDataStructureFromResult(PALSDataStructure *da
 
     dataStructure->getFitSetPtr()->setPeakToBackgroundRatio(v->peakToBackgroundRatio);
 
-    QList<QPointF> residuals;
+    PALSSpectrum residuals(v->model->binCount());
+    m_fitPlotSet = PALSSpectrum(v->model->binCount());
+
+    double *fitChannels = m_fitPlotSet.channelData();
+    double *fitCounts = m_fitPlotSet.countsData();
+    double *residualChannels = residuals.channelData();
+    double *residualValues = residuals.countsData();
 
-    const double bkgrdVal = params[bkgrdIndex];
-    double intergralCountsWithoutBkgrd = ((double)v->integralCountsInROI)-(v->stopChannel-v->startChannel+1)*bkgrdVal;
-    const int reducedDataCnt = (v->dataCnt - 2);
-    const int reducedDevCount = (paramCnt - cntGaussian - 1);
-    const int reducedParamCnt = (paramCnt - 1);
     double tZeroChannel = 0;
     int tZeroIndex = 0;
     double maxf = -1;
-    double chiSquare = 0.0;
-
-    for ( int i = 0 ; i < reducedDataCnt ; ++ i ) {
-        double f = 0.0;
-        double x = v->x[i]-v->startChannel;
-        double x_plus_1 = v->x[i+1]-v->startChannel;
-
-        for ( int device = reducedDevCount ; device < reducedParamCnt ; device += 3 ) {
-            const double gaussianSigmaVal = params[device]/(2*sqrt(log(2)));
-            const double gaussianMuVal = params[device+1];
-            const double gaussianIntensity = params[device+2];
 
-            double valF = 0.0;
+    double *f = m_workspace->modelCurve();
+    double chiSquare = v->model->chiSquare(params, f);
 
-            for ( int param = 0 ; param <  reducedDevCount ; param += 2 ) { /* 1st param[0] = tau; 2nd param[1] = intensity */
-                const double yji = exp(-(x-gaussianMuVal-(gaussianSigmaVal*gaussianSigmaVal)/(4*params[param]))/params[param])*(1-erf((0.5*gaussianSigmaVal/params[param])-(x-gaussianMuVal)/gaussianSigmaVal));
-                const double yji_plus_1 = exp(-(x_plus_1-gaussianMuVal-(gaussianSigmaVal*gaussianSigmaVal)/(4*params[param]))/params[param])*(1-erf((0.5*gaussianSigmaVal/params[param])-(x_plus_1-gaussianMuVal)/gaussianSigmaVal));
+    for ( int i = 0 ; i < v->model->binCount() ; ++ i ) {
+        const double x = v->x[i];
 
-                valF += 0.5*params[param+1]*(yji-yji_plus_1-erf((x-gaussianMuVal)/gaussianSigmaVal)+erf((x_plus_1-gaussianMuVal)/gaussianSigmaVal));
-            }
-
-            valF *= gaussianIntensity;
-            f += valF;
-        }
-
-        x += v->startChannel;
-
-        f *=  intergralCountsWithoutBkgrd;
-        f += bkgrdVal;
-
-        if (f > maxf) {
-            maxf = f;
+        if (f[i] > maxf) {
+            maxf = f[i];
             tZeroChannel = x;
             tZeroIndex = i;
         }
 
-        chiSquare += (v->y[i]-f)*(v->y[i]-f)*v->ey[i]*v->ey[i];
-
         const double res = result->resid[i]; /* weighted to v->ey[i] => 1/sqrt(y[i]) */
 
-        m_fitPlotSet.append(QPointF(x, f));
-        residuals.append(QPointF(x, res));
+        fitChannels[i] = x;
+        fitCounts[i] = f[i];
+
+        residualChannels[i] = x;
+        residualValues[i] = res;
     }
 
     /* center of mass (spectral centroid) */
     double tCenter = 0.0;
     double sumOfCounts = 0.0;
     for ( int i = tZeroIndex ; i < m_fitPlotSet.size()-1 ; ++ i ) {
-        const double time = ((m_fitPlotSet.at(i).x()-tZeroChannel) + 0.5)*channelResolution;
-        const double counts = 0.5*(m_fitPlotSet.at(i).y()+m_fitPlotSet.at(i+1).y());
+        const double time = ((fitChannels[i]-tZeroChannel) + 0.5)*channelResolution;
+        const double counts = 0.5*(fitCounts[i]+fitCounts[i+1]);
 
         tCenter += time*counts;
         sumOfCounts += counts;
@@ -1028,6 +1260,11 @@ void LifeTimeDecayFitEngine::updateDataStructureFromResult(PALSDataStructure *da
         v->chiSquareFinal[i] /= (double)(v->dataCnt - result->nfree);
     }
 
+    /* the minima of the multi-start runs are compared (__MULTI_START_MINIMA_TOLERANCE: relative) on the chi-square itself */
+    v->multiStartChiSquareMin /= (double)(v->dataCnt - result->nfree);
+    v->multiStartChiSquareMedian /= (double)(v->dataCnt - result->nfree);
+    v->multiStartChiSquareMax /= (double)(v->dataCnt - result->nfree);
+
     dataStructure->getFitSetPtr()->setChiSquareOnStart(chiSquareOnStart);
     dataStructure->getFitSetPtr()->setChiSquareAfterFit(chiSquare);
 
@@ -1097,6 +1334,9 @@ void LifeTimeDecayFitEngine::createResultString(PALSDataStructure *dataStructure
     const QString fitRuns("<nobr><b>Fit-Runs:</b></nobr>");
     QString fitRunsVal = QString("<nobr><b>" % info2Html % QVariant(v->mpfitRuns).toString() % "/" % QVariant(__MAX_NUMBER_OF_FIT_RUNS).toString() % endHtml % "</b></nobr>");
 
+    const QString multiStart("<nobr><b>Multi-Start:</b></nobr>");
+    const QString multiStartVal("<nobr><b>" % info2Html % "run " % QVariant(v->multiStartBestRun+1).toString() % "/" % QVariant(v->multiStartRuns).toString() % endHtml % "</b> (distinct minima: <b>" % QVariant(v->multiStartMinima).toString() % "</b>, dominated runs: <b>" % QVariant(v->multiStartDominatedRuns).toString() % "</b>, &#935;<sub>&#957;</sub><sup>2</sup> [min/median/max]: " % QString::number(v->multiStartChiSquareMin, 'g', 4) % "/" % QString::number(v->multiStartChiSquareMedian, 'g', 4) % "/" % QString::number(v->multiStartChiSquareMax, 'g', 4) % ")</nobr>");
+
     const QString binFac("<nobr>Bin-Factor:</nobr>");
     const QString binFacVal("<nobr><b>" % QVariant(dataStructure->getDataSetPtr()->getBinFactor()).toString() % " </b></nobr>");
 
@@ -1161,6 +1401,10 @@ void LifeTimeDecayFitEngine::createResultString(PALSDataStructure *dataStructure
 
     /*fit-runs:*/resultString = resultString % startRow % startContent % fitRuns % finishContent % startContent % fitRunsVal % finishContent % finishRow % lineBreak;
 
+    if ( v->multiStartRuns > 1 ) {
+        /*multi-start:*/resultString = resultString % startRow % startContent % multiStart % finishContent % startContent % multiStartVal % finishContent % finishRow % lineBreak;
+    }
+
     resultString = resultString % tableBorderStart;
 
     /* header: */
@@ -30,21 +30,41 @@
 #define LIFETIMEDECAYFIT_H
 
 #include <cmath>
+#include <atomic>
+#include <limits>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <numeric>
 
 #include "../Settings/projectmanager.h"
 #include "../Settings/settings.h"
 
 #include "mpfit.h"
+#include "lifetimemodel.h"
+#include "fitthreadpool.h"
+#include "fitworkspace.h"
 
 //#define __FITPARAM_DEBUG
 //#define __FITQUEUE_DEBUG
+//#define __FITDERIV_DEBUG
+//#define __FIT_NUMERICAL_DERIVATIVES /* default of setNumericalDerivatives(...) */
 
 #define __MAX_NUMBER_OF_FIT_RUNS 20
 
+/* multi-start: concurrent Levenberg-Marquardt runs from Latin-hypercube start vectors */
+#define __MAX_NUMBER_OF_MULTI_STARTS 64
+#define __MULTI_START_PERTURBATION 0.5 /* relative sampling range around the start value of parameters without both bounds */
+#define __MULTI_START_DOMINANCE_FACTOR 2.0 /* a run is stopped if its chi-square exceeds the best chi-square of the finished runs by this factor ... */
+#define __MULTI_START_MIN_ITERATIONS 5 /* ... after this number of iterations */
+#define __MULTI_START_MINIMA_TOLERANCE 1E-4 /* relative chi-square difference of distinct minima */
+#define __MULTI_START_SEED 5489u /* fixed seed: reproducible start vectors */
+
 //additional error-enums for the mpfit.h
 #define MP_ERR_NULLPTR_DATASTRUCTURE (-60) /*PALSDataStructure = nullptr;*/
 #define MP_ERR_NULLPTR_FITSET_DATASET (-61) /*PALSFitSet || PALSDataSet = nullptr;*/
 #define MP_ERR_NO_DATA (-62) /*no data to fit*/
+#define MP_ERR_DOMINATED (-63) /*multi-start run stopped: dominated by another run*/
 
 typedef enum : int {
     yerror_Weighting = 1 /* assumption: Poisson noise */
@@ -80,9 +100,23 @@ typedef struct {
   double chiSquareStart[__MAX_NUMBER_OF_FIT_RUNS];
   double chiSquareFinal[__MAX_NUMBER_OF_FIT_RUNS];
 
+  LifetimeModel *model; /* model engine of multiExpDecay(...) */
+
+  std::atomic<double> *bestChiSquare; /* multi-start: best chi-square (mpfit norm) of the finished runs (nullptr: single start) */
+
+  int multiStartRuns; /* 1: single start */
+  int multiStartBestRun;
+  int multiStartDominatedRuns;
+  int multiStartMinima; /* distinct minima of the finished runs */
+  double multiStartChiSquareMin; /* chi-square of the finished runs (reduced by updateDataStructureFromResult(...)) */
+  double multiStartChiSquareMedian;
+  double multiStartChiSquareMax;
+
 } values;
 
 int multiExpDecay(int dataCnt, int ltParam, double *ltFitParamArray, double *dy, double **dvec, void *vars);
+int multiStartDominance(int iter, double chiSquare, int ltParam, const double *ltFitParamArray, void *vars);
+void mpfitParallelFor(int taskCnt, mp_parfortask task, void *taskData, void *threadPool);
 
 class LifeTimeDecayFitEngine : public QObject
 {
@@ -95,9 +129,36 @@ public slots:
     void fit();
 
 public:
-    QList<QPointF> getFitPlotPoints() const;
+    PALSSpectrum getFitPlotPoints() const;
+
+    /* threads of the model evaluation within a single fit (1: serial, 0: one per core) */
+    void setThreadCount(int threadCnt);
+    int threadCount() const;
+
+    /* concurrent Levenberg-Marquardt runs (1: start values of the fit set only), the best chi-square is kept */
+    void setMultiStartCount(int startCnt);
+    int multiStartCount() const;
+
+    /* finite-difference Jacobian instead of the analytic derivatives: the columns are evaluated in parallel (thread count > 1),
+     * e.g. to cross-check the analytic model */
+    void setNumericalDerivatives(bool on);
+    bool isNumericalDerivatives() const;
+
+    /* buffers reused across the fits of this engine (nullptr: private workspace), e.g. shared by the consecutive fits of a batch worker */
+    void setWorkspace(FitWorkspace *workspace);
+    FitWorkspace *workspace() const;
+
+    /* warm start: the free parameters start from the result of the last converged (mpfit status 1 ... 4) warm-started fit of
+     * this engine (same parameter count and channel resolution) instead of the start values of the fit set, e.g. refits of a
+     * growing spectrum (single start). Fits with warm start disabled neither use nor replace that result. */
+    void setWarmStart(bool on);
+    bool isWarmStart() const;
+    void resetWarmStart();
 
 private:
+    static int optimize(int dataCnt, int paramCnt, double *params, mp_par *paramContraints, mp_config *config, values *v, mp_result *result, mp_workspace *ws);
+    static void multiStartVectors(int startCnt, int paramCnt, const double *params, const mp_par *paramContraints, int bkgrdIndex, double *startParams);
+
     void updateDataStructureFromResult(PALSDataStructure *dataStructure, mp_result *result, values *v, double *params);
     void createResultString(PALSDataStructure *dataStructure, values *v);
 
@@ -105,8 +166,18 @@ signals:
     void finished();
 
 private:
-    QList<QPointF> m_fitPlotSet;
+    PALSSpectrum m_fitPlotSet;
     PALSDataStructure *m_dataStructure;
+    int m_threadCnt;
+    int m_multiStartCnt;
+    bool m_numericalDerivatives;
+
+    FitWorkspace m_privateWorkspace;
+    FitWorkspace *m_workspace;
+
+    bool m_warmStart;
+    std::vector<double> m_warmStartParams; /* of the last converged warm-started fit */
+    double m_warmStartResolution;
 };
 
 class PALSFitErrorCodeStringBuilder
@@ -198,6 +269,10 @@ public:
             return QString("Error: Internal Nullptr.");
             break;
 
+        case -63:
+            return QString("Error. Run dominated by another Start.");
+            break;
+
         default:
             return QString("");
             break;
@@ -0,0 +1,145 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+
+#include "lifetimedecaypreview.h"
+
+#include <QDebug>
+
+#include <climits>
+#include <cstring>
+
+LifeTimeDecayPreviewEngine::LifeTimeDecayPreviewEngine() :
+    QObject()
+{
+    qRegisterMetaType<PALSPreviewResult>("PALSPreviewResult");
+}
+
+LifeTimeDecayPreviewEngine::~LifeTimeDecayPreviewEngine() {}
+
+void LifeTimeDecayPreviewEngine::requestPreview(const PALSPreviewRequest &request)
+{
+    if ( m_request.post(request, request.generation) )
+        QMetaObject::invokeMethod(this, "processRequests", Qt::QueuedConnection);
+}
+
+int LifeTimeDecayPreviewEngine::latestGeneration() const
+{
+    return m_request.latestGeneration();
+}
+
+void LifeTimeDecayPreviewEngine::processRequests()
+{
+    PALSPreviewRequest request;
+
+    while ( m_request.take(&request) ) {
+        PALSPreviewResult result;
+        evaluate(request, &result);
+
+        /* stale: a newer request arrived during the evaluation */
+        if ( m_request.isStale(request.generation) ) {
+#ifdef __PREVIEW_DEBUG
+            qDebug() << "preview: result " << request.generation << " dropped";
+#endif
+            continue;
+        }
+
+        emit previewReady(result);
+    }
+}
+
+void LifeTimeDecayPreviewEngine::evaluate(const PALSPreviewRequest &request, PALSPreviewResult *result)
+{
+    result->generation = request.generation;
+    result->startChannel = request.startChannel;
+    result->stopChannel = request.stopChannel;
+    result->integralCounts = 0;
+    result->tZero = 0.0f;
+    result->chiSquare = -1;
+
+    const int dataCntInRange = (request.stopChannel-request.startChannel+1);
+
+    if ( dataCntInRange <= 0 )
+        return;
+
+    m_workspace.reserve(dataCntInRange, request.params.size());
+
+    double *x = m_workspace.x();
+    double *y = m_workspace.y();
+    double *ey = m_workspace.ey();
+
+    double countsInPeak = -(double)INT_MAX;
+
+    int inRangeCnt = 0;
+    int integralCounts = 0;
+    int tZero = 0;
+
+    const double *channels = request.dataSet.channels();
+    const double *counts = request.dataSet.counts();
+
+    const int firstIndex = request.dataSet.lowerBound((double)(int)request.startChannel);
+    const int lastIndex = qMin(request.dataSet.lowerBound((double)((int)request.stopChannel + 1)), firstIndex + dataCntInRange);
+
+    for ( int index = firstIndex ; index < lastIndex ; ++ index ) {
+        x[inRangeCnt] = channels[index];
+        y[inRangeCnt] = counts[index];
+
+        /* calculate error (weighting) (statistical weighting) */
+        ey[inRangeCnt] = 1.0/sqrt(counts[index] + 1.0); //prevent zero division
+
+        integralCounts += (int)counts[index];
+
+        if ( ((int)counts[index]) > ((int)countsInPeak) ) {
+            countsInPeak = counts[index];
+            tZero = channels[index];
+        }
+
+        inRangeCnt ++;
+    }
+
+    result->integralCounts = integralCounts;
+    result->tZero = (tZero - request.startChannel)*request.channelResolution;
+
+    if ( inRangeCnt < 2 )
+        return;
+
+    LifetimeModel *model = m_workspace.model(0, request.componentCnt, request.gaussianCnt);
+    model->setData(x, y, ey, (inRangeCnt - 1), request.startChannel, (double)integralCounts, (double)dataCntInRange);
+
+    double *f = m_workspace.modelCurve();
+
+    const double chiSquare = model->chiSquare(request.params.constData(), f);
+
+    result->dataSet = PALSSpectrum(model->binCount());
+
+    memcpy(result->dataSet.channelData(), x, model->binCount()*sizeof(double));
+    memcpy(result->dataSet.countsData(), f, model->binCount()*sizeof(double));
+
+    /*approximated reduced chi-square (number of free parameters is not taken into account) */
+    result->chiSquare = chiSquare/((double)dataCntInRange);
+}
@@ -0,0 +1,115 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+
+#ifndef LIFETIMEDECAYPREVIEW_H
+#define LIFETIMEDECAYPREVIEW_H
+
+#include <QObject>
+#include <QVector>
+#include <QMetaType>
+
+#include "lifetimemodel.h"
+#include "fitworkspace.h"
+
+#include "../Settings/spectrum.h"
+
+#include "../DLib/DTypes/latestrequest.h"
+
+//#define __PREVIEW_DEBUG
+
+/* snapshot of the start values (taken on the GUI thread) */
+typedef struct {
+    int generation;
+
+    PALSSpectrum dataSet; /* implicitly shared with the data set of the project */
+
+    double channelResolution; /* [ps/chn] */
+    double startChannel;
+    double stopChannel;
+
+    int componentCnt; /* source + sample */
+    int gaussianCnt;
+
+    QVector<double> params; /* parameter layout of LifetimeModel (tau, FWHM and mu in units of channels) */
+} PALSPreviewRequest;
+
+typedef struct {
+    int generation;
+
+    PALSSpectrum dataSet; /* model curve of the start values */
+
+    double startChannel;
+    double stopChannel;
+
+    int integralCounts; /* in ROI */
+    double tZero; /* [ps] estimated from the peak channel */
+    double chiSquare; /* approximated reduced chi-square (-1: no data in ROI) */
+} PALSPreviewResult;
+
+Q_DECLARE_METATYPE(PALSPreviewResult)
+
+/*
+ * LifeTimeDecayPreviewEngine - model curve of the start values off the GUI thread:
+ *----------------------------------------------------------------------------------
+ *
+ * requestPreview(...) can be called at any rate from the GUI thread: the requests are passed through a DLatestRequest slot,
+ * so only the latest one is evaluated on the thread of the engine and results of requests which became stale during their
+ * evaluation are not emitted. The buffers and the model engine are
+ * reused across the previews (FitWorkspace).
+ */
+
+class LifeTimeDecayPreviewEngine : public QObject
+{
+    Q_OBJECT
+public:
+    LifeTimeDecayPreviewEngine();
+    virtual ~LifeTimeDecayPreviewEngine();
+
+    /* thread-safe */
+    void requestPreview(const PALSPreviewRequest& request);
+
+    /* generation of the latest request */
+    int latestGeneration() const;
+
+signals:
+    void previewReady(const PALSPreviewResult& result);
+
+private slots:
+    void processRequests();
+
+private:
+    void evaluate(const PALSPreviewRequest& request, PALSPreviewResult *result);
+
+private:
+    DLatestRequest<PALSPreviewRequest> m_request;
+
+    FitWorkspace m_workspace;
+};
+
+#endif // LIFETIMEDECAYPREVIEW_H
@@ -0,0 +1,469 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+
+#include "lifetimemodel.h"
+
+#include <algorithm>
+
+/* bin-edge terms: erf(u/sigma), 2/sqrt(pi)*exp(-u²/sigma²) (optional) and exp(-(u - sigma²/(4tau))/tau)*erfc(sigma/(2tau) - u/sigma) with u = x - xOffset - mu */
+static inline void irfEdgeTerms(int edgeCnt, const double *x, double xOffset, double mu, double sigma, double *erfEdge, double *gaussEdge) {
+#ifdef __FIT_SIMD_KERNEL
+    simdIRFEdgeTerms(edgeCnt, x, xOffset, mu, sigma, erfEdge, gaussEdge);
+#else
+    const double twoDivSqrtPi = 1.1283791670955126; /* 2/sqrt(pi) */
+
+    for ( int e = 0 ; e < edgeCnt ; ++ e ) {
+        const double u = x[e] - xOffset - mu;
+
+        erfEdge[e] = erf(u/sigma);
+
+        if ( gaussEdge )
+            gaussEdge[e] = twoDivSqrtPi*exp(-(u*u)/(sigma*sigma));
+    }
+#endif
+}
+
+static inline void lifetimeEdgeTerms(int edgeCnt, const double *x, double xOffset, double mu, double sigma, double tau, double *yEdge) {
+#ifdef __FIT_SIMD_KERNEL
+    simdLifetimeEdgeTerms(edgeCnt, x, xOffset, mu, sigma, tau, yEdge);
+#else
+    for ( int e = 0 ; e < edgeCnt ; ++ e ) {
+        const double u = x[e] - xOffset - mu;
+
+        yEdge[e] = exp(-(u-(sigma*sigma)/(4*tau))/tau)*(1-erf((0.5*sigma/tau)-u/sigma));
+    }
+#endif
+}
+
+/*
+ * closed-form partial derivatives of yji = exp(P)*erfc(Q) with P = -(u - sigma²/(4tau))/tau and Q = sigma/(2tau) - u/sigma (u = x - mu):
+ *
+ * d(yji)/dz = yji*dP/dz - 2/sqrt(pi)*exp(-u²/sigma²)*dQ/dz  (note: exp(P - Q²) = exp(-u²/sigma²) is independent of tau)
+ */
+static inline void lifetimeEdgeDerivatives(double u, double yji, double gauss, double tau, double sigma, double *dTau, double *dMu, double *dSigma) {
+    const double tauSquare = tau*tau;
+    const double sigmaSquare = sigma*sigma;
+
+    *dTau = yji*(u/tauSquare - sigmaSquare/(2*tauSquare*tau)) + 0.5*gauss*sigma/tauSquare;
+    *dMu = yji/tau - gauss/sigma;
+    *dSigma = yji*sigma/(2*tauSquare) - gauss*(0.5/tau + u/sigmaSquare);
+}
+
+LifetimeModel::LifetimeModel(int componentCnt, int gaussianCnt) :
+    m_componentCnt(componentCnt),
+    m_gaussianCnt(gaussianCnt),
+    m_x(nullptr),
+    m_y(nullptr),
+    m_ey(nullptr),
+    m_binCnt(0),
+    m_xOffset(0.0),
+    m_area(0.0),
+    m_roi(0.0),
+    m_threadPool(nullptr),
+    m_edgeBuffer(nullptr),
+    m_edgeBufferSize(0),
+    m_binBuffer(nullptr),
+    m_bufferCapacity(0),
+    m_blockSums(nullptr),
+    m_blockCapacity(0) {
+    m_kernel = selectKernel(componentCnt, gaussianCnt);
+}
+
+LifetimeModel::~LifetimeModel() {
+    delete [] m_edgeBuffer;
+    delete [] m_binBuffer;
+    delete [] m_blockSums;
+}
+
+void LifetimeModel::setData(const double *x, const double *y, const double *ey, int binCnt, double xOffset, double area, double roi) {
+    m_x = x;
+    m_y = y;
+    m_ey = ey;
+
+    m_binCnt = (binCnt > 0) ? binCnt : 0;
+    m_xOffset = xOffset;
+    m_area = area;
+    m_roi = roi;
+
+    reserveBuffers();
+}
+
+void LifetimeModel::setThreadPool(FitThreadPool *pool) {
+    m_threadPool = pool;
+
+    reserveBuffers();
+}
+
+FitThreadPool *LifetimeModel::threadPool() const {
+    return m_threadPool;
+}
+
+int LifetimeModel::componentCount() const {
+    return m_componentCnt;
+}
+
+int LifetimeModel::gaussianCount() const {
+    return m_gaussianCnt;
+}
+
+int LifetimeModel::paramCount() const {
+    return 2*m_componentCnt + 3*m_gaussianCnt + 1;
+}
+
+int LifetimeModel::binCount() const {
+    return m_binCnt;
+}
+
+int LifetimeModel::blockCount() const {
+    return (m_binCnt + __LIFETIME_MODEL_BLOCK_SIZE - 1)/__LIFETIME_MODEL_BLOCK_SIZE;
+}
+
+void LifetimeModel::reserveBuffers() {
+    const int participants = m_threadPool ? m_threadPool->maxParticipants() : 1;
+    const int blockBins = std::min(m_binCnt, __LIFETIME_MODEL_BLOCK_SIZE);
+
+    /* per participant: erf + Gaussian + one edge term per component (blockBins+1 edges each) + derivative terms of the previous edge (3 per component) */
+    const int edgeBufferSize = participants*((2 + m_componentCnt)*(blockBins + 1) + 3*m_componentCnt);
+
+    if ( edgeBufferSize > m_edgeBufferSize ) {
+        delete [] m_edgeBuffer;
+
+        m_edgeBufferSize = edgeBufferSize;
+        m_edgeBuffer = new double[m_edgeBufferSize];
+    }
+
+    if ( m_binCnt > m_bufferCapacity ) {
+        delete [] m_binBuffer;
+
+        m_bufferCapacity = m_binCnt;
+        m_binBuffer = new double[m_bufferCapacity];
+    }
+
+    if ( blockCount() > m_blockCapacity ) {
+        delete [] m_blockSums;
+
+        m_blockCapacity = blockCount();
+        m_blockSums = new double[m_blockCapacity];
+    }
+}
+
+/*
+ * calls func(block, begin, end, edgeBuffer) for the bin blocks [begin, end) of __LIFETIME_MODEL_BLOCK_SIZE bins:
+ *
+ * The block boundaries do not depend on the number of threads and each block is evaluated independently (its bin edges
+ * are evaluated by the block itself), thus the results are bit-identical for the serial and the parallel evaluation.
+ */
+void LifetimeModel::forEachBlock(const std::function<void(int, int, int, double*)>& func) {
+    const int blockCnt = blockCount();
+    const int participants = m_threadPool ? m_threadPool->maxParticipants() : 1;
+    const int edgeBufferSize = m_edgeBufferSize/participants;
+
+    const int binCnt = m_binCnt;
+    double *edgeBuffer = m_edgeBuffer;
+
+    auto block = [&func, binCnt, edgeBuffer, edgeBufferSize](int block, int participant) {
+        const int begin = block*__LIFETIME_MODEL_BLOCK_SIZE;
+        const int end = std::min(begin + __LIFETIME_MODEL_BLOCK_SIZE, binCnt);
+
+        func(block, begin, end, edgeBuffer + participant*edgeBufferSize);
+    };
+
+    if ( m_threadPool && blockCnt > 1 )
+        m_threadPool->parallelFor(blockCnt, block);
+    else {
+        for ( int i = 0 ; i < blockCnt ; ++ i )
+            block(i, 0);
+    }
+}
+
+/* pairwise summation of the block sums: the rounding error grows with O(log(n)) instead of O(n) */
+double LifetimeModel::pairwiseSum(const double *values, int cnt) {
+    if ( cnt <= 0 )
+        return 0.0;
+
+    if ( cnt == 1 )
+        return values[0];
+
+    const int half = cnt/2;
+
+    return pairwiseSum(values, half) + pairwiseSum(values + half, cnt - half);
+}
+
+/*
+ * normalized model per bin (area = 1, without background) and (optional) its partial derivatives dBins[param] (background excluded):
+ *
+ * The terms of each bin edge are evaluated once and the bins are formed by differencing. The tau-independent IRF terms
+ * erf((x-mu)/sigma) are evaluated once per Gaussian, their contribution reduces to the sum of the intensities.
+ */
+template <int COMPONENTS, int GAUSSIANS>
+void LifetimeModel::evaluateKernel(const LifetimeModel *model, const double *params, int begin, int end, double *bins, double **dBins, double *edgeBuffer) {
+    const int componentCnt = (COMPONENTS > 0) ? COMPONENTS : model->m_componentCnt;
+    const int gaussianCnt = (GAUSSIANS > 0) ? GAUSSIANS : model->m_gaussianCnt;
+
+    /* bins [begin, end) of the data set: edges x[begin] ... x[end] */
+    const int binCnt = (end - begin);
+    const int edgeCnt = (binCnt + 1);
+
+    const double *x = model->m_x + begin;
+    const double xOffset = model->m_xOffset;
+
+    const double fwhmToSigma = 1.0/(2*sqrt(log(2)));
+
+    bins += begin;
+
+    double *erfEdge = edgeBuffer;
+    double *gaussEdge = erfEdge + edgeCnt;
+    double *yEdge = gaussEdge + edgeCnt;
+    double *carry = yEdge + componentCnt*edgeCnt;
+
+    memset(bins, 0, binCnt*sizeof(double));
+
+    if ( dBins ) {
+        for ( int param = 0 ; param < 2*componentCnt + 3*gaussianCnt ; ++ param ) {
+            if ( dBins[param] )
+                memset(dBins[param] + begin, 0, binCnt*sizeof(double));
+        }
+    }
+
+    double sumOfIntensities = 0.0;
+    for ( int component = 0 ; component < componentCnt ; ++ component )
+        sumOfIntensities += params[2*component+1];
+
+    for ( int gaussian = 0 ; gaussian < gaussianCnt ; ++ gaussian ) {
+        const int device = 2*componentCnt + 3*gaussian;
+
+        const double gaussianSigma = params[device]*fwhmToSigma; /* transform FWHM to 1-sigma uncertainty */
+        const double gaussianMu = params[device+1];
+
+        const double gaussianIntensity = params[device+2]; /* IRF contribution/intensity */
+
+        irfEdgeTerms(edgeCnt, x, xOffset, gaussianMu, gaussianSigma, erfEdge, dBins ? gaussEdge : nullptr);
+
+        /* Kirkegaard and Eldrup (1972) */
+        for ( int component = 0 ; component < componentCnt ; ++ component )
+            lifetimeEdgeTerms(edgeCnt, x, xOffset, gaussianMu, gaussianSigma, params[2*component], yEdge + component*edgeCnt);
+
+        for ( int i = 0 ; i < binCnt ; ++ i ) {
+            double valF = 0.5*sumOfIntensities*(erfEdge[i+1]-erfEdge[i]);
+
+            for ( int component = 0 ; component < componentCnt ; ++ component )
+                valF += 0.5*params[2*component+1]*(yEdge[component*edgeCnt+i]-yEdge[component*edgeCnt+i+1]);
+
+            bins[i] += gaussianIntensity*valF; /* account for multiple Gaussian IRFs forming the final IRF */
+        }
+
+        if ( !dBins )
+            continue;
+
+        const double sigmaSquare = gaussianSigma*gaussianSigma;
+
+        /* derivative terms of the first edge (carried from edge i+1 to the next bin) */
+        for ( int component = 0 ; component < componentCnt ; ++ component )
+            lifetimeEdgeDerivatives(x[0] - xOffset - gaussianMu, yEdge[component*edgeCnt], gaussEdge[0], params[2*component], gaussianSigma, &carry[3*component], &carry[3*component+1], &carry[3*component+2]);
+
+        for ( int i = 0 ; i < binCnt ; ++ i ) {
+            const double ui = x[i] - xOffset - gaussianMu;
+            const double ui_plus_1 = x[i+1] - xOffset - gaussianMu;
+
+            const double erfDiff = erfEdge[i+1]-erfEdge[i];
+
+            /* d(erf(u/sigma))/d(mu) = -g/sigma and d(erf(u/sigma))/d(sigma) = -g*u/sigma² */
+            double dValFdSigma = 0.5*sumOfIntensities*(gaussEdge[i]*ui-gaussEdge[i+1]*ui_plus_1)/sigmaSquare;
+            double dValFdMu = 0.5*sumOfIntensities*(gaussEdge[i]-gaussEdge[i+1])/gaussianSigma;
+            double valF = 0.5*sumOfIntensities*erfDiff;
+
+            for ( int component = 0 ; component < componentCnt ; ++ component ) {
+                const int param = 2*component;
+
+                const double tau = params[param];
+                const double intensity = params[param+1];
+
+                const double yji = yEdge[component*edgeCnt+i];
+                const double yji_plus_1 = yEdge[component*edgeCnt+i+1];
+
+                double dTau_plus_1, dMu_plus_1, dSigma_plus_1;
+                lifetimeEdgeDerivatives(ui_plus_1, yji_plus_1, gaussEdge[i+1], tau, gaussianSigma, &dTau_plus_1, &dMu_plus_1, &dSigma_plus_1);
+
+                if ( dBins[param] )
+                    dBins[param][begin+i] += gaussianIntensity*0.5*intensity*(carry[3*component]-dTau_plus_1);
+
+                if ( dBins[param+1] )
+                    dBins[param+1][begin+i] += gaussianIntensity*0.5*(yji-yji_plus_1+erfDiff);
+
+                dValFdMu += 0.5*intensity*(carry[3*component+1]-dMu_plus_1);
+                dValFdSigma += 0.5*intensity*(carry[3*component+2]-dSigma_plus_1);
+                valF += 0.5*intensity*(yji-yji_plus_1);
+
+                carry[3*component] = dTau_plus_1;
+                carry[3*component+1] = dMu_plus_1;
+                carry[3*component+2] = dSigma_plus_1;
+            }
+
+            if ( dBins[device] )
+                dBins[device][begin+i] += gaussianIntensity*dValFdSigma*fwhmToSigma;
+
+            if ( dBins[device+1] )
+                dBins[device+1][begin+i] += gaussianIntensity*dValFdMu;
+
+            if ( dBins[device+2] )
+                dBins[device+2][begin+i] += valF;
+        }
+    }
+}
+
+LifetimeModel::kernelFunc LifetimeModel::selectKernel(int componentCnt, int gaussianCnt) {
+    static const kernelFunc kernels[4][3] = {
+        { &evaluateKernel<1, 1>, &evaluateKernel<1, 2>, &evaluateKernel<1, 3> },
+        { &evaluateKernel<2, 1>, &evaluateKernel<2, 2>, &evaluateKernel<2, 3> },
+        { &evaluateKernel<3, 1>, &evaluateKernel<3, 2>, &evaluateKernel<3, 3> },
+        { &evaluateKernel<4, 1>, &evaluateKernel<4, 2>, &evaluateKernel<4, 3> }
+    };
+
+    if ( componentCnt >= 1 && componentCnt <= 4
+         && gaussianCnt >= 1 && gaussianCnt <= 3 )
+        return kernels[componentCnt-1][gaussianCnt-1];
+
+    return &evaluateKernel<0, 0>; /* generic */
+}
+
+void LifetimeModel::residuals(int m, const double *params, double *dy, double **dvec) {
+    const int paramCnt = paramCount();
+    const int binCnt = m_binCnt;
+
+    const double bkgrd = params[paramCnt-1];
+    const double areaWithoutBkgrd = (m_area - m_roi*bkgrd);
+
+    const double *y = m_y;
+    const double *ey = m_ey;
+    const double roi = m_roi;
+
+    const kernelFunc kernel = m_kernel;
+    const LifetimeModel *model = this;
+
+    forEachBlock([=](int, int begin, int end, double *edgeBuffer) {
+        /* normalized model per bin => dy[i] and its partial derivatives => dvec[param][i] */
+        kernel(model, params, begin, end, dy, dvec, edgeBuffer);
+
+        for ( int i = begin ; i < end ; ++ i ) {
+            const double f = dy[i];
+
+            /* d(dy)/d(param) = -ey*d(f)/d(param) */
+            if ( dvec ) {
+                const double scaling = -ey[i]*areaWithoutBkgrd;
+
+                for ( int param = 0 ; param < paramCnt - 1 ; ++ param ) {
+                    if ( dvec[param] )
+                        dvec[param][i] *= scaling;
+                }
+
+                /* background enters the model twice: f = (area - roi*bkgrd)*f' + bkgrd */
+                if ( dvec[paramCnt-1] )
+                    dvec[paramCnt-1][i] = -ey[i]*(1.0 - roi*f);
+            }
+
+            /* weighted residual calculation: note: ey[...] is already calculated as = 1/sqrt(y[i]) */
+            dy[i] = ey[i]*(y[i]-(f*areaWithoutBkgrd + bkgrd));
+        }
+    });
+
+    /* the residuals beyond the constraint are not part of the model (keep them defined for mpfit) */
+    for ( int i = binCnt ; i < m ; ++ i )
+        dy[i] = 0.0;
+
+    if ( binCnt <= 0 )
+        return;
+
+    if ( dvec ) {
+        for ( int param = 0 ; param < paramCnt ; ++ param ) {
+            if ( !dvec[param] )
+                continue;
+
+            for ( int i = binCnt - 1 ; i < m ; ++ i )
+                dvec[param][i] = 0.0;
+        }
+    }
+
+    /* constraint (replaces the last bin): sum of all (Gaussian) IRFs be equal 1 (for a single Gaussian its intensity is kept at 1) */
+    double sumGaussianContribution = 0.0;
+    for ( int gaussian = 0 ; gaussian < m_gaussianCnt ; ++ gaussian ) {
+        const int device = 2*m_componentCnt + 3*gaussian;
+
+        sumGaussianContribution += params[device+2];
+
+        if ( dvec && dvec[device+2] )
+            dvec[device+2][binCnt-1] = 1E4;
+    }
+
+    dy[binCnt-1] = (sumGaussianContribution - 1)*1E4; /* 1E4 represents a tolarance factor to balance the satisfaction (sum IRFs = 1) of the constraint vs. the tolerance of the fitting parameters */
+}
+
+void LifetimeModel::modelCurve(const double *params, double *f) {
+    const double bkgrd = params[paramCount()-1];
+    const double areaWithoutBkgrd = (m_area - m_roi*bkgrd);
+
+    const kernelFunc kernel = m_kernel;
+    const LifetimeModel *model = this;
+
+    forEachBlock([=](int, int begin, int end, double *edgeBuffer) {
+        kernel(model, params, begin, end, f, nullptr, edgeBuffer);
+
+        for ( int i = begin ; i < end ; ++ i )
+            f[i] = f[i]*areaWithoutBkgrd + bkgrd;
+    });
+}
+
+double LifetimeModel::chiSquare(const double *params, double *f) {
+    double *curve = f ? f : m_binBuffer;
+
+    const double bkgrd = params[paramCount()-1];
+    const double areaWithoutBkgrd = (m_area - m_roi*bkgrd);
+
+    const double *y = m_y;
+    const double *ey = m_ey;
+    double *blockSums = m_blockSums;
+
+    const kernelFunc kernel = m_kernel;
+    const LifetimeModel *model = this;
+
+    /* blocked pairwise summation: deterministic and independent of the number of threads */
+    forEachBlock([=](int block, int begin, int end, double *edgeBuffer) {
+        kernel(model, params, begin, end, curve, nullptr, edgeBuffer);
+
+        double sum = 0.0;
+        for ( int i = begin ; i < end ; ++ i ) {
+            curve[i] = curve[i]*areaWithoutBkgrd + bkgrd;
+
+            sum += (y[i]-curve[i])*(y[i]-curve[i])*ey[i]*ey[i];
+        }
+
+        blockSums[block] = sum;
+    });
+
+    return pairwiseSum(m_blockSums, blockCount());
+}
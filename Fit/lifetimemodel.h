@@ -0,0 +1,125 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+
+#ifndef LIFETIMEMODEL_H
+#define LIFETIMEMODEL_H
+
+#include <cmath>
+#include <cstring>
+#include <functional>
+
+#include "simdkernel.h"
+#include "fitthreadpool.h"
+
+/* bins per block of the (parallel) model evaluation */
+#define __LIFETIME_MODEL_BLOCK_SIZE 2048
+
+/*
+ * LifetimeModel - evaluation engine of the Kirkegaard and Eldrup (1972) model:
+ *-----------------------------------------------------------------------------
+ *
+ * parameter layout: [(tau, I) x componentCnt (source + sample)][(FWHM, mu, I) x gaussianCnt][background] (tau, FWHM and mu in units of channels)
+ *
+ * f(bin) = (area - roi*background)*sum_gaussian I_gaussian*sum_component 0.5*I*(y(x[i]) - y(x[i+1]) - erf(x[i]) + erf(x[i+1])) + background
+ *
+ * The bin i spans the edges x[i] and x[i+1]. The evaluation kernel is specialized on the number of components (1-4) and
+ * Gaussians (1-3), all other combinations are evaluated by the generic kernel.
+ *
+ * The bins are evaluated in blocks of __LIFETIME_MODEL_BLOCK_SIZE, which are distributed across the threads of the pool
+ * (if set). The results do not depend on the number of threads.
+ */
+
+class LifetimeModel
+{
+public:
+    LifetimeModel(int componentCnt, int gaussianCnt);
+    ~LifetimeModel();
+
+    /* x: binCnt+1 bin edges, y/ey: counts and weights (1/sqrt(y+1)) of the bins, xOffset: start channel, area: integral counts in ROI, roi: channels in ROI */
+    void setData(const double *x, const double *y, const double *ey, int binCnt, double xOffset, double area, double roi);
+
+    /* parallel evaluation on the pool (nullptr: serial evaluation on the calling thread) */
+    void setThreadPool(FitThreadPool *pool);
+    FitThreadPool *threadPool() const;
+
+    int componentCount() const;
+    int gaussianCount() const;
+    int paramCount() const;
+    int binCount() const;
+
+    /* weighted residuals dy[0..m-1] incl. the constraint of the Gaussian intensities (sum = 1) and (optional) analytic derivatives dvec[param][0..m-1] (mpfit: side = 3) */
+    void residuals(int m, const double *params, double *dy, double **dvec);
+
+    /* model curve f[0..binCnt-1] */
+    void modelCurve(const double *params, double *f);
+
+    /* chi-square (not reduced) and (optional) the model curve f[0..binCnt-1] */
+    double chiSquare(const double *params, double *f = nullptr);
+
+private:
+    typedef void (*kernelFunc)(const LifetimeModel *model, const double *params, int begin, int end, double *bins, double **dBins, double *edgeBuffer);
+
+    template <int COMPONENTS, int GAUSSIANS>
+    static void evaluateKernel(const LifetimeModel *model, const double *params, int begin, int end, double *bins, double **dBins, double *edgeBuffer);
+
+    static kernelFunc selectKernel(int componentCnt, int gaussianCnt);
+
+    int blockCount() const;
+    void reserveBuffers();
+    void forEachBlock(const std::function<void(int, int, int, double*)>& func);
+
+    static double pairwiseSum(const double *values, int cnt);
+
+private:
+    int m_componentCnt;
+    int m_gaussianCnt;
+
+    const double *m_x;
+    const double *m_y;
+    const double *m_ey;
+
+    int m_binCnt;
+    double m_xOffset;
+    double m_area;
+    double m_roi;
+
+    kernelFunc m_kernel;
+
+    FitThreadPool *m_threadPool;
+
+    /* scratch buffers (bin-edge terms per participant of the block evaluation, the model per bin and the chi-square per block) */
+    double *m_edgeBuffer;
+    int m_edgeBufferSize;
+    double *m_binBuffer;
+    int m_bufferCapacity;
+    double *m_blockSums;
+    int m_blockCapacity;
+};
+
+#endif // LIFETIMEMODEL_H
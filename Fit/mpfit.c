@@ -23,6 +23,23 @@
 #include <string.h>
 #include "mpfit.h"
 
+/* Workspace of mpfit_ws(): one block, carved into the temporary arrays of a fit */
+struct mp_workspace_struct {
+  char *buffer;
+  size_t capacity;
+  size_t used;
+};
+
+/* Scratch arrays of mp_fdjac2() (taken from the workspace once per fit) */
+struct mp_fdjac2_scratch {
+  double **dvec;  /* npar */
+  int *column;    /* npar */
+  int *iflag;     /* npar */
+  int *nfev;      /* npar */
+  double *wa;     /* nworkers x m */
+  double *xw;     /* nworkers x npar */
+};
+
 /* Forward declarations of functions in this module */
 static int mp_fdjac2(mp_func funct,
 	      int m, int n, int *ifree, int npar, double *x, double *fvec,
@@ -30,7 +47,14 @@ static int mp_fdjac2(mp_func funct,
 	      double *wa, void *priv, int *nfev,
 	      double *step, double *dstep, int *dside,
 	      int *qulimited, double *ulimit,
-	      int *ddebug, double *ddrtol, double *ddatol);
+	      int *ddebug, double *ddrtol, double *ddatol,
+	      mp_config *conf, struct mp_fdjac2_scratch *scratch);
+static int mp_fdjac2_parallel(mp_func funct,
+	      int m, int n, int *ifree, int npar, double *x, double *fvec,
+	      double *fjac, double eps, int *nfev,
+	      double *step, double *dstep, int *dside,
+	      int *qulimited, double *ulimit,
+	      mp_config *conf, struct mp_fdjac2_scratch *scratch);
 static void mp_qrfac(int m, int n, double *a, int lda, 
 	      int pivot, int *ipvt, int lipvt,
 	      double *rdiag, double *acnorm, double *wa);
@@ -48,9 +72,9 @@ static int mp_covar(int n, double *r, int ldr, int *ipvt, double tol, double *wa
 /* Macro to call user function */
 #define mp_call(funct, m, n, x, fvec, dvec, priv) (*(funct))(m,n,x,fvec,dvec,priv)
 
-/* Macro to safely allocate memory */
+/* Macro to safely allocate memory (from the workspace ws if given) */
 #define mp_malloc(dest,type,size) \
-  dest = (type *) malloc( sizeof(type)*size ); \
+  dest = (type *) mp_workspace_take(ws, sizeof(type)*(size)); \
   if (dest == 0) { \
     info = MP_ERR_MEMORY; \
     goto CLEANUP; \
@@ -59,6 +83,93 @@ static int mp_covar(int n, double *r, int ldr, int *ipvt, double tol, double *wa
     for (_k=0; _k<(size); _k++) dest[_k] = 0; \
   } 
 
+/* Macro to release memory of mp_malloc (owned by the workspace ws if given) */
+#define mp_release(ptr) \
+  if (!ws && (ptr)) free(ptr);
+
+#define MP_WS_ALIGN(bytes) ((((size_t)(bytes)) + 15) & ~((size_t)15))
+
+/* Bytes of the workspace required by a fit of m residuals, npar parameters and
+   nworkers parallel derivative workers */
+static size_t mp_workspace_bytes(int m, int npar, int nworkers)
+{
+  size_t bytes = 0;
+
+  bytes += 10*MP_WS_ALIGN(sizeof(double)*npar);  /* step ... ddatol, ulim, llim, qtf, x, xnew, diag */
+  bytes += 3*MP_WS_ALIGN(sizeof(double)*npar);   /* wa1 ... wa3 */
+  bytes += 7*MP_WS_ALIGN(sizeof(int)*npar);      /* pfixed, mpside, ddebug, ifree, qulim, qllim, ipvt */
+  bytes += 2*MP_WS_ALIGN(sizeof(double)*m);      /* fvec, wa4 */
+  bytes += MP_WS_ALIGN(sizeof(double)*m*npar);   /* fjac */
+
+  /* mp_fdjac2 */
+  bytes += MP_WS_ALIGN(sizeof(double *)*npar);
+  bytes += 3*MP_WS_ALIGN(sizeof(int)*npar);
+  bytes += MP_WS_ALIGN(sizeof(double)*m*(nworkers > 0 ? nworkers : 1));
+  bytes += MP_WS_ALIGN(sizeof(double)*npar*(nworkers > 0 ? nworkers : 1));
+
+  return bytes;
+}
+
+/* Grows the buffer of the workspace to at least bytes, resets its allocations */
+static int mp_workspace_reserve(mp_workspace *ws, size_t bytes)
+{
+  if (ws->capacity < bytes) {
+    char *buffer = (char *) malloc(bytes);
+
+    if (buffer == 0) return MP_ERR_MEMORY;
+
+    free(ws->buffer);
+
+    ws->buffer = buffer;
+    ws->capacity = bytes;
+  }
+
+  ws->used = 0;
+
+  return 0;
+}
+
+/* Takes bytes from the workspace (or from the heap without workspace) */
+static void *mp_workspace_take(mp_workspace *ws, size_t bytes)
+{
+  void *ptr;
+
+  if (!ws) return malloc(bytes);
+
+  if (ws->used + MP_WS_ALIGN(bytes) > ws->capacity) return 0;
+
+  ptr = ws->buffer + ws->used;
+  ws->used += MP_WS_ALIGN(bytes);
+
+  return ptr;
+}
+
+mp_workspace *mp_workspace_new(void)
+{
+  mp_workspace *ws = (mp_workspace *) malloc(sizeof(mp_workspace));
+
+  if (ws) {
+    ws->buffer = 0;
+    ws->capacity = 0;
+    ws->used = 0;
+  }
+
+  return ws;
+}
+
+void mp_workspace_free(mp_workspace *ws)
+{
+  if (!ws) return;
+
+  free(ws->buffer);
+  free(ws);
+}
+
+size_t mp_workspace_capacity(const mp_workspace *ws)
+{
+  return ws ? ws->capacity : 0;
+}
+
 /*
 *     **********
 *
@@ -277,6 +388,19 @@ int mpfit(mp_func funct,
           mp_config *config,
            void *private_data,
       mp_result *result)
+{
+  return mpfit_ws(funct, m, npar, xall, pars, config, private_data, result, 0);
+}
+
+int mpfit_ws(mp_func funct,
+          int m,
+          int npar,
+          double *xall,
+          mp_par *pars,
+          mp_config *config,
+          void *private_data,
+          mp_result *result,
+          mp_workspace *ws)
 {
   mp_config conf;
   int i, j, info, iflag, nfree, npegged, iter;
@@ -305,6 +429,9 @@ int mpfit(mp_func funct,
   double *wa1 = 0, *wa2 = 0, *wa3 = 0, *wa4 = 0;
   int *ipvt = 0;
 
+  struct mp_fdjac2_scratch scratch;
+  struct mp_fdjac2_scratch *pscratch = 0;
+
   int ldfjac;
 
   /* Default configuration */
@@ -320,6 +447,11 @@ int mpfit(mp_func funct,
   conf.maxfev = 0;
   conf.covtol = 1e-14;
   conf.nofinitecheck = 0;
+  conf.parfor = 0;
+  conf.parfor_data = 0;
+  conf.nworkers = 0;
+  conf.worker_private = 0;
+  conf.iterproc = 0;
   
   if (config) {
     /* Transfer any user-specified configurations */
@@ -334,6 +466,13 @@ int mpfit(mp_func funct,
     if (config->covtol > 0) conf.covtol = config->covtol;
     if (config->nofinitecheck > 0) conf.nofinitecheck = config->nofinitecheck;
     conf.maxfev = config->maxfev;
+    if (config->parfor && config->nworkers > 0 && config->worker_private) {
+      conf.parfor = config->parfor;
+      conf.parfor_data = config->parfor_data;
+      conf.nworkers = config->nworkers;
+      conf.worker_private = config->worker_private;
+    }
+    conf.iterproc = config->iterproc;
   }
 
   info = 0;
@@ -353,6 +492,11 @@ int mpfit(mp_func funct,
     return MP_ERR_NFREE;
   }
 
+  /* All temporary arrays are taken from the workspace (no heap allocation if it is large enough) */
+  if (ws && mp_workspace_reserve(ws, mp_workspace_bytes(m, npar, conf.nworkers)) < 0) {
+    return MP_ERR_MEMORY;
+  }
+
   fnorm = -1.0;
   fnorm1 = -1.0;
   xnorm = -1.0;
@@ -450,6 +594,16 @@ int mpfit(mp_func funct,
   mp_malloc(wa4, double, m);
   mp_malloc(ipvt, int, npar);
 
+  if (ws) {
+    mp_malloc(scratch.dvec, double *, npar);
+    mp_malloc(scratch.column, int, npar);
+    mp_malloc(scratch.iflag, int, npar);
+    mp_malloc(scratch.nfev, int, npar);
+    mp_malloc(scratch.wa, double, m*((conf.nworkers > 0) ? conf.nworkers : 1));
+    mp_malloc(scratch.xw, double, npar*((conf.nworkers > 0) ? conf.nworkers : 1));
+    pscratch = &scratch;
+  }
+
   /* Evaluate user function with initial parameter values */
   iflag = mp_call(funct, m, npar, xall, fvec, 0, private_data);
   nfev += 1;
@@ -484,13 +638,16 @@ int mpfit(mp_func funct,
     xnew[ifree[i]] = x[i];
   }
   
-  /* XXX call iterproc */
+  if (conf.iterproc) {
+    iflag = conf.iterproc(iter, fnorm*fnorm, npar, xnew, private_data);
+    if (iflag < 0) goto L300;
+  }
 
   /* Calculate the jacobian matrix */
   iflag = mp_fdjac2(funct, m, nfree, ifree, npar, xnew, fvec, fjac, ldfjac,
 		    conf.epsfcn, wa4, private_data, &nfev,
 		    step, dstep, mpside, qulim, ulim,
-		    ddebug, ddrtol, ddatol);
+		    ddebug, ddrtol, ddatol, &conf, pscratch);
   if (iflag < 0) {
     goto CLEANUP;
   }
@@ -949,29 +1106,29 @@ int mpfit(mp_func funct,
 
 
  CLEANUP:
-  if (fvec) free(fvec);
-  if (qtf)  free(qtf);
-  if (x)    free(x);
-  if (xnew) free(xnew);
-  if (fjac) free(fjac);
-  if (diag) free(diag);
-  if (wa1)  free(wa1);
-  if (wa2)  free(wa2);
-  if (wa3)  free(wa3);
-  if (wa4)  free(wa4);
-  if (ipvt) free(ipvt);
-  if (pfixed) free(pfixed);
-  if (step) free(step);
-  if (dstep) free(dstep);
-  if (mpside) free(mpside);
-  if (ddebug) free(ddebug);
-  if (ddrtol) free(ddrtol);
-  if (ddatol) free(ddatol);
-  if (ifree) free(ifree);
-  if (qllim) free(qllim);
-  if (qulim) free(qulim);
-  if (llim)  free(llim);
-  if (ulim)  free(ulim);
+  mp_release(fvec);
+  mp_release(qtf);
+  mp_release(x);
+  mp_release(xnew);
+  mp_release(fjac);
+  mp_release(diag);
+  mp_release(wa1);
+  mp_release(wa2);
+  mp_release(wa3);
+  mp_release(wa4);
+  mp_release(ipvt);
+  mp_release(pfixed);
+  mp_release(step);
+  mp_release(dstep);
+  mp_release(mpside);
+  mp_release(ddebug);
+  mp_release(ddrtol);
+  mp_release(ddatol);
+  mp_release(ifree);
+  mp_release(qllim);
+  mp_release(qulim);
+  mp_release(llim);
+  mp_release(ulim);
 
 
   return info;
@@ -987,7 +1144,8 @@ int mp_fdjac2(mp_func funct,
 	      double *wa, void *priv, int *nfev,
 	      double *step, double *dstep, int *dside,
 	      int *qulimited, double *ulimit,
-	      int *ddebug, double *ddrtol, double *ddatol)
+	      int *ddebug, double *ddrtol, double *ddatol,
+	      mp_config *conf, struct mp_fdjac2_scratch *scratch)
 {
 /*
 *     **********
@@ -1079,7 +1237,7 @@ int mp_fdjac2(mp_func funct,
   ij = 0;
   ldfjac = 0; /* Prevents compiler warning */
 
-  dvec = (double **) malloc(sizeof(double **)*npar);
+  dvec = (scratch) ? scratch->dvec : (double **) malloc(sizeof(double **)*npar);
   if (dvec == 0) return MP_ERR_MEMORY;
   for (j=0; j<npar; j++) dvec[j] = 0;
 
@@ -1118,7 +1276,14 @@ int mp_fdjac2(mp_func funct,
 	   "IPNT", "FUNC", "DERIV_U", "DERIV_N", "DIFF_ABS", "DIFF_REL");
   }
 
-  /* Any parameters requiring numerical derivatives */
+  /* Any parameters requiring numerical derivatives: evaluated in 
+     parallel (if configured) unless they are debugged */
+  if (has_numerical_deriv && !has_debug_deriv && conf && conf->parfor) {
+    iflag = mp_fdjac2_parallel(funct, m, n, ifree, npar, x, fvec, fjac, eps, nfev,
+			       step, dstep, dside, qulimited, ulimit, conf, scratch);
+    goto DONE;
+  }
+
   if (has_numerical_deriv) for (j=0; j<n; j++) {  /* Loop thru free parms */
     int dsidei = (dside)?(dside[ifree[j]]):(0);
     int debug  = ddebug[ifree[j]];
@@ -1132,6 +1297,9 @@ int mp_fdjac2(mp_func funct,
     /* Skip parameters already done by user-computed partials */
     if (dside && dsidei == 3) continue;
 
+    /* Column index of fjac: analytic columns are skipped above */
+    ij = j*m;
+
     temp = x[ifree[j]];
     h = eps * fabs(temp);
     if (step  &&  step[ifree[j]] > 0) h = step[ifree[j]];
@@ -1213,7 +1381,7 @@ int mp_fdjac2(mp_func funct,
   }
 
  DONE:
-  if (dvec) free(dvec);
+  if (dvec && !scratch) free(dvec);
   if (iflag < 0) return iflag;
   return 0; 
   /*
@@ -1222,6 +1390,170 @@ int mp_fdjac2(mp_func funct,
 }
 
 
+/*
+ * Parallel evaluation of the numerical derivative columns:
+ *
+ * Each column (free parameter) is one task of conf->parfor. A task 
+ * perturbs a private copy of the parameters and evaluates the user 
+ * function into the private work array of its worker using the 
+ * private data of the worker, thus x is not modified. The columns of 
+ * fjac are disjoint. The step sizes and the results are identical to 
+ * the serial evaluation in mp_fdjac2.
+ */
+struct mp_fdjac2_task_struct {
+  mp_func funct;
+  int m, npar;
+  int *ifree;
+  double *x, *fvec, *fjac;
+  double eps;
+  double *step, *dstep;
+  int *dside, *qulimited;
+  double *ulimit;
+
+  int *column;   /* free parameter index of each task */
+  double *wa;    /* nworkers x m */
+  double *xw;    /* nworkers x npar */
+  void **worker_private;
+
+  int *iflag;    /* status of each task */
+  int *nfev;     /* function evaluations of each task */
+};
+
+static 
+void mp_fdjac2_column(int itask, int iworker, void *task_data)
+{
+  struct mp_fdjac2_task_struct *t = (struct mp_fdjac2_task_struct *) task_data;
+  int i, j = t->column[itask], ij = j*t->m;
+  int m = t->m;
+  int dsidei = (t->dside)?(t->dside[t->ifree[j]]):(0);
+  double *wa = t->wa + iworker*m;
+  double *xw = t->xw + iworker*t->npar;
+  void *priv = t->worker_private[iworker];
+  double h, temp;
+  int iflag;
+
+  for (i=0; i<t->npar; i++) xw[i] = t->x[i];
+
+  temp = xw[t->ifree[j]];
+  h = t->eps * fabs(temp);
+  if (t->step  &&  t->step[t->ifree[j]] > 0) h = t->step[t->ifree[j]];
+  if (t->dstep && t->dstep[t->ifree[j]] > 0) h = fabs(t->dstep[t->ifree[j]]*temp);
+  if (h == 0.0)                             h = t->eps;
+
+  /* If negative step requested, or we are against the upper limit */
+  if ((t->dside && dsidei == -1) || 
+      (t->dside && dsidei == 0 && 
+       t->qulimited && t->ulimit && t->qulimited[j] && 
+       (temp > (t->ulimit[j]-h)))) {
+    h = -h;
+  }
+
+  xw[t->ifree[j]] = temp + h;
+  iflag = mp_call(t->funct, m, t->npar, xw, wa, 0, priv);
+  t->nfev[itask] = 1;
+  t->iflag[itask] = iflag;
+  if (iflag < 0) return;
+
+  if (dsidei <= 1) {
+    /* COMPUTE THE ONE-SIDED DERIVATIVE */
+    for (i=0; i<m; i++, ij++) {
+      t->fjac[ij] = (wa[i] - t->fvec[i])/h; /* fjac[i+m*j] */
+    }
+  } else {
+    /* COMPUTE THE TWO-SIDED DERIVATIVE */
+    for (i=0; i<m; i++) {
+      t->fjac[ij+i] = wa[i];    /* Store temp data: fjac[i+m*j] */
+    }
+
+    /* Evaluate at x - h */
+    xw[t->ifree[j]] = temp - h;
+    iflag = mp_call(t->funct, m, t->npar, xw, wa, 0, priv);
+    t->nfev[itask] = 2;
+    t->iflag[itask] = iflag;
+    if (iflag < 0) return;
+
+    /* Now compute derivative as (f(x+h) - f(x-h))/(2h) */
+    for (i=0; i<m; i++, ij++) {
+      t->fjac[ij] = (t->fjac[ij] - wa[i])/(2*h); /* fjac[i+m*j] */
+    }
+  }
+}
+
+static 
+int mp_fdjac2_parallel(mp_func funct,
+	      int m, int n, int *ifree, int npar, double *x, double *fvec,
+	      double *fjac, double eps, int *nfev,
+	      double *step, double *dstep, int *dside,
+	      int *qulimited, double *ulimit,
+	      mp_config *conf, struct mp_fdjac2_scratch *scratch)
+{
+  struct mp_fdjac2_task_struct t;
+  int j, ntasks = 0, iflag = 0;
+
+  t.funct = funct;
+  t.m = m;
+  t.npar = npar;
+  t.ifree = ifree;
+  t.x = x;
+  t.fvec = fvec;
+  t.fjac = fjac;
+  t.eps = eps;
+  t.step = step;
+  t.dstep = dstep;
+  t.dside = dside;
+  t.qulimited = qulimited;
+  t.ulimit = ulimit;
+  t.worker_private = conf->worker_private;
+
+  if (scratch) {
+    t.column = scratch->column;
+    t.iflag = scratch->iflag;
+    t.nfev = scratch->nfev;
+    t.wa = scratch->wa;
+    t.xw = scratch->xw;
+  } else {
+    t.column = (int *) malloc(sizeof(int)*n);
+    t.iflag = (int *) malloc(sizeof(int)*n);
+    t.nfev = (int *) malloc(sizeof(int)*n);
+    t.wa = (double *) malloc(sizeof(double)*m*conf->nworkers);
+    t.xw = (double *) malloc(sizeof(double)*npar*conf->nworkers);
+  }
+
+  if (!t.column || !t.iflag || !t.nfev || !t.wa || !t.xw) {
+    iflag = MP_ERR_MEMORY;
+    goto DONE;
+  }
+
+  /* Skip parameters already done by user-computed partials */
+  for (j=0; j<n; j++) {
+    if (dside && dside[ifree[j]] == 3) continue;
+
+    t.column[ntasks] = j;
+    t.iflag[ntasks] = 0;
+    t.nfev[ntasks] = 0;
+    ntasks ++;
+  }
+
+  if (ntasks > 0) (*(conf->parfor))(ntasks, mp_fdjac2_column, &t, conf->parfor_data);
+
+  for (j=0; j<ntasks; j++) {
+    if (nfev) *nfev = *nfev + t.nfev[j];
+    if (t.iflag[j] < 0 && iflag == 0) iflag = t.iflag[j];
+  }
+
+ DONE:
+  if (!scratch) {
+    if (t.column) free(t.column);
+    if (t.iflag) free(t.iflag);
+    if (t.nfev) free(t.nfev);
+    if (t.wa) free(t.wa);
+    if (t.xw) free(t.xw);
+  }
+
+  return iflag;
+}
+
+
 /************************qrfac.c*************************/
  
 static 
@@ -19,6 +19,8 @@
 #ifndef MPFIT_H
 #define MPFIT_H
 
+#include <stddef.h>
+
 /* This is a C library.
  * Allows compilation with a C++ compiler
  */
@@ -85,8 +87,17 @@ struct mp_par_struct {
                         */
 };
 
-/* Just a placeholder - do not use!! */
-typedef void (*mp_iterproc)(void);
+/* Called before each iteration with the current chi-square (sum of squared residuals)
+   and parameters x (npar elements); a return value < 0 terminates the fit with that 
+   value as status */
+typedef int (*mp_iterproc)(int iter, double chisq, int npar, const double *x, void *private_data);
+
+/* Parallel loop over the numerical derivative columns (see mp_config.parfor):
+   task(itask, iworker, task_data) must be executed once for each itask = 0 ... ntasks-1 
+   (possibly concurrently) before returning; iworker in [0, nworkers) has to be unique 
+   across the concurrently executed tasks */
+typedef void (*mp_parfortask)(int itask, int iworker, void *task_data);
+typedef void (*mp_parfor)(int ntasks, mp_parfortask task, void *task_data, void *parfor_data);
 
 /*
  * Definition of MPFIT configuration structure
@@ -137,7 +148,21 @@ struct mp_config_struct {
                         1 = perform check
                       */
 
-  mp_iterproc iterproc; /* Placeholder pointer - must set to 0 */
+  mp_iterproc iterproc; /* Iteration callback (see mp_iterproc);
+                           Default: 0 (none) */
+
+  mp_parfor parfor;   /* Evaluates the numerical derivative columns in parallel 
+                         (ignored for debugged derivatives);
+                         Default: 0 (serial evaluation) */
+
+  void *parfor_data;  /* I - passed to parfor */
+
+  int nworkers;       /* Number of worker indices used by parfor */
+
+  void **worker_private; /* I/O - private data of each worker (nworkers entries), 
+                            passed to the user function instead of private_data.
+                            The user function is called concurrently, each worker
+                            requires its own copy of the private data. */
 };
 
 /*
@@ -182,6 +207,9 @@ typedef struct mp_par_struct mp_par;
 typedef struct mp_config_struct mp_config;
 typedef struct mp_result_struct mp_result;
 
+/* Reusable temporary storage of mpfit_ws() (opaque) */
+typedef struct mp_workspace_struct mp_workspace;
+
 /*
  * Enforce type of fitting function
  */
@@ -255,6 +283,27 @@ extern int mpfit( mp_func funct,
                   mp_result *result
                   );
 
+/*
+ * Reentrant variant of mpfit(): the temporary arrays are taken from the
+ * workspace ws, which grows to the largest problem passed and is reused by
+ * the following calls (ws = 0: heap allocation as mpfit()). A workspace must
+ * not be used by concurrent calls.
+ */
+extern int mpfit_ws( mp_func funct,
+                     int m,
+                     int npar,
+                     double *xall,
+                     mp_par *pars,
+                     mp_config *config,
+                     void *private_data,
+                     mp_result *result,
+                     mp_workspace *ws
+                     );
+
+extern mp_workspace *mp_workspace_new(void);
+extern void mp_workspace_free(mp_workspace *ws);
+extern size_t mp_workspace_capacity(const mp_workspace *ws);
+
 
 /*
  * C99 uses isfinite() instead of finite()
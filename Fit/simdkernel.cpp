@@ -0,0 +1,303 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+
+#include "simdkernel.h"
+
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define __SIMD_KERNEL_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+#endif
+
+namespace simdkernel {
+    const double log2e = 1.4426950408889634; /* 1/ln(2) */
+    const double ln2Hi = 6.93147180369123816490e-01; /* ln(2) split (Cody and Waite): n*ln2Hi is exact for |n| < 2^20 */
+    const double ln2Lo = 1.90821492927058770002e-10;
+    const double roundingShift = 6755399441055744.0; /* 1.5*2^52: (x + shift) - shift rounds x to the nearest integer */
+
+    const double twoDivSqrtPi = 1.1283791670955126; /* 2/sqrt(pi) */
+
+    const double erfSaturation = 8.0; /* erfc(8) < 1E-29 */
+    const double expUnderflowSqrt = 27.0; /* exp(-27²) underflows (< exp(-708)) */
+
+    /* 1/k! */
+    const double expTaylorCoefficients[14] = { 1.0,
+                                               1.0,
+                                               1.0/2.0,
+                                               1.0/6.0,
+                                               1.0/24.0,
+                                               1.0/120.0,
+                                               1.0/720.0,
+                                               1.0/5040.0,
+                                               1.0/40320.0,
+                                               1.0/362880.0,
+                                               1.0/3628800.0,
+                                               1.0/39916800.0,
+                                               1.0/479001600.0,
+                                               1.0/6227020800.0 };
+
+    /* Chebyshev coefficients of h(t) = ln(erfc(z)/t) + z² on ty = 4t-2 with t = 2/(2+z) (truncation error < 1E-17) */
+    const int erfcChebyshevCoefficientsCnt = 28;
+    const double erfcChebyshevCoefficients[28] = { -1.3026537197817094, 0.6419697923564902, 0.019476473204185836, -0.009561514786808632,
+                                                   -0.0009465953444820369, 0.00036683949785276145, 4.252332480690777e-05, -2.0278578112534242e-05,
+                                                   -1.6242900046470256e-06, 1.3036558355805232e-06, 1.5626441722066142e-08, -8.523809591492654e-08,
+                                                   6.5290544390988515e-09, 5.059343495551469e-09, -9.91364156493033e-10, -2.273651222931836e-10,
+                                                   9.646791102015527e-11, 2.3940380830391146e-12, -6.886027526497553e-12, 8.944879273090725e-13,
+                                                   3.130921399342958e-13, -1.1270822361367252e-13, 3.810905255189232e-16, 7.106097613609237e-15,
+                                                   -1.5230282014571043e-15, -9.457494571291233e-17, 1.210237189224279e-16, -2.816663087747177e-17 };
+}
+
+namespace simdkernel_scalar {
+    typedef double vdouble;
+    typedef bool vmask;
+
+    const int LANES = 1;
+
+    static inline vdouble vSet(double a) { return a; }
+    static inline vdouble vLoad(const double *p) { return *p; }
+    static inline void vStore(double *p, vdouble a) { *p = a; }
+
+    static inline vdouble vAdd(vdouble a, vdouble b) { return a + b; }
+    static inline vdouble vSub(vdouble a, vdouble b) { return a - b; }
+    static inline vdouble vMul(vdouble a, vdouble b) { return a * b; }
+    static inline vdouble vDiv(vdouble a, vdouble b) { return a / b; }
+
+    /* same operand semantics as minpd/maxpd */
+    static inline vdouble vMin(vdouble a, vdouble b) { return (a < b) ? a : b; }
+    static inline vdouble vMax(vdouble a, vdouble b) { return (a > b) ? a : b; }
+    static inline vdouble vAbs(vdouble a) { return std::fabs(a); }
+
+    static inline vmask vLess(vdouble a, vdouble b) { return (a < b); }
+    static inline vdouble vSelect(vmask m, vdouble a, vdouble b) { return m ? a : b; }
+    static inline bool vAll(vmask m) { return m; }
+
+    /* 2^n from kd = n + roundingShift */
+    static inline vdouble vPow2n(vdouble kd) {
+        int64_t kdBits, shiftBits;
+        std::memcpy(&kdBits, &kd, sizeof(double));
+        std::memcpy(&shiftBits, &simdkernel::roundingShift, sizeof(double));
+
+        const int64_t bits = ((kdBits - shiftBits) + 1023) << 52;
+
+        double result;
+        std::memcpy(&result, &bits, sizeof(double));
+
+        return result;
+    }
+
+#include "simdkernelimpl.h"
+}
+
+#ifdef __SIMD_KERNEL_X86
+namespace simdkernel_sse2 {
+    typedef __m128d vdouble;
+    typedef __m128d vmask;
+
+    const int LANES = 2;
+
+    static inline vdouble vSet(double a) { return _mm_set1_pd(a); }
+    static inline vdouble vLoad(const double *p) { return _mm_loadu_pd(p); }
+    static inline void vStore(double *p, vdouble a) { _mm_storeu_pd(p, a); }
+
+    static inline vdouble vAdd(vdouble a, vdouble b) { return _mm_add_pd(a, b); }
+    static inline vdouble vSub(vdouble a, vdouble b) { return _mm_sub_pd(a, b); }
+    static inline vdouble vMul(vdouble a, vdouble b) { return _mm_mul_pd(a, b); }
+    static inline vdouble vDiv(vdouble a, vdouble b) { return _mm_div_pd(a, b); }
+
+    static inline vdouble vMin(vdouble a, vdouble b) { return _mm_min_pd(a, b); }
+    static inline vdouble vMax(vdouble a, vdouble b) { return _mm_max_pd(a, b); }
+    static inline vdouble vAbs(vdouble a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+
+    static inline vmask vLess(vdouble a, vdouble b) { return _mm_cmplt_pd(a, b); }
+    static inline vdouble vSelect(vmask m, vdouble a, vdouble b) { return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b)); }
+    static inline bool vAll(vmask m) { return (_mm_movemask_pd(m) == 0x3); }
+
+    static inline vdouble vPow2n(vdouble kd) {
+        __m128i bits = _mm_sub_epi64(_mm_castpd_si128(kd), _mm_castpd_si128(_mm_set1_pd(simdkernel::roundingShift)));
+
+        bits = _mm_add_epi64(bits, _mm_set1_epi64x(1023));
+        bits = _mm_slli_epi64(bits, 52);
+
+        return _mm_castsi128_pd(bits);
+    }
+
+#include "simdkernelimpl.h"
+}
+
+/* the AVX2 path is compiled for the AVX2 target only (selected at runtime) */
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace simdkernel_avx2 {
+    typedef __m256d vdouble;
+    typedef __m256d vmask;
+
+    const int LANES = 4;
+
+    static inline vdouble vSet(double a) { return _mm256_set1_pd(a); }
+    static inline vdouble vLoad(const double *p) { return _mm256_loadu_pd(p); }
+    static inline void vStore(double *p, vdouble a) { _mm256_storeu_pd(p, a); }
+
+    static inline vdouble vAdd(vdouble a, vdouble b) { return _mm256_add_pd(a, b); }
+    static inline vdouble vSub(vdouble a, vdouble b) { return _mm256_sub_pd(a, b); }
+    static inline vdouble vMul(vdouble a, vdouble b) { return _mm256_mul_pd(a, b); }
+    static inline vdouble vDiv(vdouble a, vdouble b) { return _mm256_div_pd(a, b); }
+
+    static inline vdouble vMin(vdouble a, vdouble b) { return _mm256_min_pd(a, b); }
+    static inline vdouble vMax(vdouble a, vdouble b) { return _mm256_max_pd(a, b); }
+    static inline vdouble vAbs(vdouble a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+
+    static inline vmask vLess(vdouble a, vdouble b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+    static inline vdouble vSelect(vmask m, vdouble a, vdouble b) { return _mm256_blendv_pd(b, a, m); }
+    static inline bool vAll(vmask m) { return (_mm256_movemask_pd(m) == 0xf); }
+
+    static inline vdouble vPow2n(vdouble kd) {
+        __m256i bits = _mm256_sub_epi64(_mm256_castpd_si256(kd), _mm256_castpd_si256(_mm256_set1_pd(simdkernel::roundingShift)));
+
+        bits = _mm256_add_epi64(bits, _mm256_set1_epi64x(1023));
+        bits = _mm256_slli_epi64(bits, 52);
+
+        return _mm256_castsi256_pd(bits);
+    }
+
+#include "simdkernelimpl.h"
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+#endif // __SIMD_KERNEL_X86
+
+static simdInstructionSet detectInstructionSet() {
+#ifdef __SIMD_KERNEL_X86
+#if defined(__GNUC__)
+    __builtin_cpu_init();
+
+    if ( __builtin_cpu_supports("avx2") )
+        return simdInstructionSet::avx2_InstructionSet;
+#elif defined(_MSC_VER)
+    int info[4] = {0};
+
+    __cpuid(info, 0);
+
+    if ( info[0] >= 7 ) {
+        __cpuid(info, 1);
+
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const bool avx = (info[2] & (1 << 28)) != 0;
+
+        __cpuidex(info, 7, 0);
+
+        const bool avx2 = (info[1] & (1 << 5)) != 0;
+
+        if ( osxsave && avx && avx2 && ((_xgetbv(0) & 0x6) == 0x6) ) /* OS saves the YMM registers? */
+            return simdInstructionSet::avx2_InstructionSet;
+    }
+#endif
+
+    return simdInstructionSet::sse2_InstructionSet;
+#else
+    return simdInstructionSet::scalar_InstructionSet;
+#endif
+}
+
+simdInstructionSet simdKernelInstructionSet() {
+    static const simdInstructionSet instructionSet = detectInstructionSet();
+
+    return instructionSet;
+}
+
+void simdIRFEdgeTerms(int edgeCnt, const double *x, double xOffset, double mu, double sigma, double *erfEdge, double *gaussEdge) {
+    int e = 0;
+
+    switch ( simdKernelInstructionSet() ) {
+#ifdef __SIMD_KERNEL_X86
+    case simdInstructionSet::avx2_InstructionSet:
+        e = simdkernel_avx2::irfEdgeTerms(edgeCnt, x, xOffset, mu, sigma, erfEdge, gaussEdge);
+        break;
+
+    case simdInstructionSet::sse2_InstructionSet:
+        e = simdkernel_sse2::irfEdgeTerms(edgeCnt, x, xOffset, mu, sigma, erfEdge, gaussEdge);
+        break;
+#endif
+
+    default:
+        break;
+    }
+
+    /* remaining edges (bit-identical scalar path) */
+    simdkernel_scalar::irfEdgeTerms(edgeCnt - e, x + e, xOffset, mu, sigma, erfEdge + e, gaussEdge ? (gaussEdge + e) : nullptr);
+}
+
+void simdLifetimeEdgeTerms(int edgeCnt, const double *x, double xOffset, double mu, double sigma, double tau, double *yEdge) {
+    int e = 0;
+
+    switch ( simdKernelInstructionSet() ) {
+#ifdef __SIMD_KERNEL_X86
+    case simdInstructionSet::avx2_InstructionSet:
+        e = simdkernel_avx2::lifetimeEdgeTerms(edgeCnt, x, xOffset, mu, sigma, tau, yEdge);
+        break;
+
+    case simdInstructionSet::sse2_InstructionSet:
+        e = simdkernel_sse2::lifetimeEdgeTerms(edgeCnt, x, xOffset, mu, sigma, tau, yEdge);
+        break;
+#endif
+
+    default:
+        break;
+    }
+
+    /* remaining edges (bit-identical scalar path) */
+    simdkernel_scalar::lifetimeEdgeTerms(edgeCnt - e, x + e, xOffset, mu, sigma, tau, yEdge + e);
+}
+
+double simdExp(double x) {
+    return simdkernel_scalar::vExp(x);
+}
+
+double simdErfc(double x) {
+    if ( x < 0.0 )
+        return 2.0 - simdkernel_scalar::vErfcPositive(-x);
+
+    return simdkernel_scalar::vErfcPositive(x);
+}
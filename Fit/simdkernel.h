@@ -0,0 +1,79 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+
+#ifndef SIMDKERNEL_H
+#define SIMDKERNEL_H
+
+/*
+ * vectorized evaluation of the bin-edge terms of the Kirkegaard and Eldrup (1972) model:
+ *---------------------------------------------------------------------------------------
+ *
+ * The edge terms are evaluated 2 (SSE2) or 4 (AVX2) channels at once based on polynomial approximations of exp and erfc.
+ * The instruction set is chosen at runtime. The scalar fallback runs the identical sequence of IEEE-754 operations
+ * and therefore yields bit-identical results on every instruction set (requires -ffp-contract=off, see DQuickLTFit.pro).
+ *
+ * maximum error (double precision, measured against long double erfc/exp, checked by Tests/simdkernel):
+ *
+ * exp: Cody-Waite range reduction + degree 13 Taylor polynomial: <= 1 ulp for x in [-708, 709] (0 below, exp(709) above)
+ * erfc: Chebyshev approximation (28 terms) of erfc(z) = t*exp(-z² + h(t)) with t = 2/(2+z):
+ *       relative error < 7E-16 for |z| < 1, < 5E-15 for |z| < 5 and < 1.5E-13 in the tail up to z = 26.5 (measured 1.14E-13:
+ *       the exponent -z² is rounded to an ulp of up to 1.1E-13)
+ *
+ * The edge term exp(P)*erfc(Q) is evaluated as t*exp(-u²/sigma² + h) instead of exp(P)*(1 - erf(Q)), which avoids the
+ * cancellation of 1 - erf(Q) and the overflow of exp(P) on the leading edge (libm formula: up to 4E-5). Relative error
+ * (exact evaluation of the rounded u = x - xOffset - mu as reference): < 1E-14 for |u/sigma| < 5 and < 2.5E-13 in the tail
+ * up to |u/sigma| = 27 (measured 2.03E-13: rounding of u/sigma and of the exponent -u²/sigma²).
+ */
+
+/* documented bounds of the relative error (see above) */
+#define SIMD_KERNEL_ERFC_ERROR 5E-15 /* |z| < 5 */
+#define SIMD_KERNEL_ERFC_TAIL_ERROR 1.5E-13 /* 5 <= |z| <= 26.5 */
+#define SIMD_KERNEL_EDGE_ERROR 1E-14 /* |u/sigma| < 5 */
+#define SIMD_KERNEL_EDGE_TAIL_ERROR 2.5E-13 /* 5 <= |u/sigma| <= 27 */
+
+typedef enum : int {
+    scalar_InstructionSet = 0,
+    sse2_InstructionSet = 1,
+    avx2_InstructionSet = 2
+} simdInstructionSet;
+
+/* instruction set detected at runtime */
+simdInstructionSet simdKernelInstructionSet();
+
+/* erfEdge[e] = erf(u/sigma) and (optional) gaussEdge[e] = 2/sqrt(pi)*exp(-u²/sigma²) with u = x[e] - xOffset - mu */
+void simdIRFEdgeTerms(int edgeCnt, const double *x, double xOffset, double mu, double sigma, double *erfEdge, double *gaussEdge);
+
+/* yEdge[e] = exp(-(u - sigma²/(4tau))/tau)*erfc(sigma/(2tau) - u/sigma) with u = x[e] - xOffset - mu */
+void simdLifetimeEdgeTerms(int edgeCnt, const double *x, double xOffset, double mu, double sigma, double tau, double *yEdge);
+
+/* scalar approximations (bit-identical to the vectorized ones) */
+double simdExp(double x);
+double simdErfc(double x);
+
+#endif // SIMDKERNEL_H
@@ -0,0 +1,160 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+
+/*
+ * generic implementation of the edge terms (see simdkernel.cpp):
+ *
+ * This file has no include guard. It is included once per instruction set into a separate namespace,
+ * which provides the vector type (vdouble), its mask type (vmask), the number of lanes (LANES) and the elementary operations.
+ */
+
+static inline vdouble vExp(vdouble x) {
+    const vmask underflow = vLess(x, vSet(-708.0));
+
+    x = vMax(vMin(x, vSet(709.0)), vSet(-708.0));
+
+    /* x = n*ln(2) + r with |r| <= ln(2)/2 */
+    const vdouble kd = vAdd(vMul(x, vSet(simdkernel::log2e)), vSet(simdkernel::roundingShift));
+    const vdouble n = vSub(kd, vSet(simdkernel::roundingShift));
+    const vdouble r = vSub(vSub(x, vMul(n, vSet(simdkernel::ln2Hi))), vMul(n, vSet(simdkernel::ln2Lo)));
+
+    vdouble p = vSet(simdkernel::expTaylorCoefficients[13]);
+    for ( int k = 12 ; k >= 0 ; -- k )
+        p = vAdd(vMul(p, r), vSet(simdkernel::expTaylorCoefficients[k]));
+
+    return vSelect(underflow, vSet(0.0), vMul(p, vPow2n(kd)));
+}
+
+/* h(t) of erfc(z) = t*exp(-z² + h(t)) with t = 2/(2+z) (z >= 0) */
+static inline vdouble vErfcExponent(vdouble z, vdouble &t) {
+    t = vDiv(vSet(2.0), vAdd(vSet(2.0), z));
+
+    const vdouble ty = vSub(vMul(vSet(4.0), t), vSet(2.0));
+
+    vdouble d = vSet(0.0);
+    vdouble dd = vSet(0.0);
+
+    for ( int j = simdkernel::erfcChebyshevCoefficientsCnt - 1 ; j > 0 ; -- j ) {
+        const vdouble tmp = d;
+
+        d = vAdd(vSub(vSet(simdkernel::erfcChebyshevCoefficients[j]), dd), vMul(ty, d)); /* (c - dd) is off the critical path */
+        dd = tmp;
+    }
+
+    return vSub(vMul(vSet(0.5), vAdd(vSet(simdkernel::erfcChebyshevCoefficients[0]), vMul(ty, d))), dd);
+}
+
+/* erfc(z) for z >= 0 */
+static inline vdouble vErfcPositive(vdouble z) {
+    vdouble t;
+    const vdouble h = vErfcExponent(z, t);
+
+    return vMul(t, vExp(vAdd(vSub(vSet(0.0), vMul(z, z)), h)));
+}
+
+static inline vdouble vIRFEdgeTerm(vdouble x, vdouble xOffset, vdouble mu, vdouble sigma, vdouble *gauss) {
+    const vdouble a = vDiv(vSub(vSub(x, xOffset), mu), sigma);
+
+    if ( gauss )
+        *gauss = vMul(vSet(simdkernel::twoDivSqrtPi), vExp(vSub(vSet(0.0), vMul(a, a))));
+
+    /* |a| > 8: erfc(|a|) < 1E-29 => erf(a) = sign(a) (identical to the full evaluation below) */
+    if ( vAll(vLess(vSet(simdkernel::erfSaturation), vAbs(a))) )
+        return vSelect(vLess(a, vSet(0.0)), vSet(-1.0), vSet(1.0));
+
+    const vdouble e = vErfcPositive(vAbs(a));
+
+    return vSelect(vLess(a, vSet(0.0)), vSub(e, vSet(1.0)), vSub(vSet(1.0), e));
+}
+
+/*
+ * exp(P)*erfc(Q) with P = (sigma²/(4tau) - u)/tau and Q = sigma/(2tau) - u/sigma:
+ *
+ * Q >= 0: t*exp(P - Q² + h) = t*exp(-u²/sigma² + h) (no overflow of exp(P) and no cancellation of 1 - erf(Q))
+ * Q < 0: 2*exp(P) - t*exp(-u²/sigma² + h) (P < 0 for Q < 0)
+ */
+static inline vdouble vLifetimeEdgeTerm(vdouble x, vdouble xOffset, vdouble mu, vdouble sigma, vdouble tau, vdouble pOffset, vdouble qOffset) {
+    const vdouble u = vSub(vSub(x, xOffset), mu);
+    const vdouble a = vDiv(u, sigma);
+
+    const vdouble p = vDiv(vSub(pOffset, u), tau);
+    const vdouble q = vSub(qOffset, a);
+
+    /* the shortcuts below yield the identical result as the full evaluation (the omitted term is far below 1 ulp):
+     *
+     * decay (Q < -8): 2*exp(P) - exp(P)*erfc(|Q|) with erfc(|Q|) < 1E-29
+     * leading edge (u/sigma < -27): exp(-u²/sigma² + h) underflows to 0 (h <= 0) */
+    if ( vAll(vLess(q, vSet(-simdkernel::erfSaturation))) )
+        return vMul(vSet(2.0), vExp(vMin(p, vSet(0.0))));
+
+    if ( vAll(vLess(a, vSet(-simdkernel::expUnderflowSqrt))) )
+        return vSet(0.0);
+
+    vdouble t;
+    const vdouble h = vErfcExponent(vAbs(q), t);
+
+    const vdouble core = vMul(t, vExp(vSub(h, vMul(a, a))));
+
+    return vSelect(vLess(q, vSet(0.0)), vSub(vMul(vSet(2.0), vExp(vMin(p, vSet(0.0)))), core), core);
+}
+
+/* returns the number of edges evaluated (multiple of LANES) */
+static int irfEdgeTerms(int edgeCnt, const double *x, double xOffset, double mu, double sigma, double *erfEdge, double *gaussEdge) {
+    const vdouble xOffsetV = vSet(xOffset);
+    const vdouble muV = vSet(mu);
+    const vdouble sigmaV = vSet(sigma);
+
+    int e = 0;
+    for ( ; e + LANES <= edgeCnt ; e += LANES ) {
+        vdouble gauss;
+
+        vStore(erfEdge + e, vIRFEdgeTerm(vLoad(x + e), xOffsetV, muV, sigmaV, gaussEdge ? &gauss : nullptr));
+
+        if ( gaussEdge )
+            vStore(gaussEdge + e, gauss);
+    }
+
+    return e;
+}
+
+/* returns the number of edges evaluated (multiple of LANES) */
+static int lifetimeEdgeTerms(int edgeCnt, const double *x, double xOffset, double mu, double sigma, double tau, double *yEdge) {
+    const vdouble xOffsetV = vSet(xOffset);
+    const vdouble muV = vSet(mu);
+    const vdouble sigmaV = vSet(sigma);
+    const vdouble tauV = vSet(tau);
+    const vdouble pOffsetV = vSet((sigma*sigma)/(4*tau));
+    const vdouble qOffsetV = vSet(0.5*sigma/tau);
+
+    int e = 0;
+    for ( ; e + LANES <= edgeCnt ; e += LANES )
+        vStore(yEdge + e, vLifetimeEdgeTerm(vLoad(x + e), xOffsetV, muV, sigmaV, tauV, pOffsetV, qOffsetV));
+
+    return e;
+}
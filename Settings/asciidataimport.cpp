@@ -0,0 +1,405 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+
+#include "asciidataimport.h"
+
+static inline bool isBlank(char c) {
+    return (c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f');
+}
+
+/* [blanks][+|-]digits[blanks] (as QString::toInt(...)) */
+static inline bool parseInt(const char *begin, const char *end, int *value) {
+    while ( begin < end && isBlank(*begin) )
+        begin ++;
+
+    while ( end > begin && isBlank(*(end - 1)) )
+        end --;
+
+    bool negative = false;
+
+    if ( begin < end && (*begin == '-' || *begin == '+') ) {
+        negative = (*begin == '-');
+        begin ++;
+    }
+
+    if ( begin == end )
+        return false;
+
+    qint64 integer = 0;
+
+    for ( ; begin < end ; ++ begin ) {
+        const unsigned int digit = (unsigned int)(*begin - '0');
+
+        if ( digit > 9 )
+            return false;
+
+        integer = 10*integer + digit;
+
+        if ( integer > (qint64)INT_MAX + 1 )
+            return false;
+    }
+
+    integer = negative ? -integer : integer;
+
+    if ( integer > INT_MAX )
+        return false;
+
+    *value = (int)integer;
+
+    return true;
+}
+
+asciiImportStatus PALSASCIIDataImport::importFile(const QString &fileName, int binFac, PALSASCIIData *data, int threadCnt)
+{
+    QFile file(fileName);
+
+    if ( !file.open(QIODevice::ReadOnly) )
+        return asciiImportStatus::fileError_ImportStatus;
+
+    if ( binFac < 1 )
+        binFac = 1;
+
+    data->dataSet.clear();
+    data->minChannel = INT_MAX;
+    data->maxChannel = -INT_MAX;
+    data->minCounts = INT_MAX;
+    data->maxCounts = -INT_MAX;
+
+    /* memory-mapped (read as fallback) */
+    const qint64 size = file.size();
+
+    qint64 length = size;
+
+    QByteArray content;
+    const char *begin = (size > 0) ? (const char*)file.map(0, size) : nullptr;
+
+    if ( !begin && size > 0 ) {
+        content = file.readAll();
+
+        begin = content.constData();
+        length = content.size();
+    }
+
+    const char *end = begin + length;
+
+    const char delimiter = detectDelimiter(begin, end);
+
+    /* chunks at row boundaries */
+    int chunkCnt = 1;
+
+    if ( threadCnt != 1 && length >= PALS_ASCII_IMPORT_PARALLEL_SIZE ) {
+        chunkCnt = (threadCnt <= 0) ? FitThreadPool::idealThreadCount() : threadCnt;
+        chunkCnt = (int)qBound((qint64)1, qMin((qint64)chunkCnt, length/PALS_ASCII_IMPORT_MIN_CHUNK_SIZE), (qint64)256);
+    }
+
+    std::vector<const char*> chunkBegin(chunkCnt + 1, end);
+    chunkBegin[0] = begin;
+
+    for ( int i = 1 ; i < chunkCnt ; ++ i ) {
+        const char *pos = qMax(chunkBegin[i - 1], begin + (end - begin)*i/chunkCnt);
+
+        while ( pos < end && *pos != '\n' )
+            pos ++;
+
+        chunkBegin[i] = (pos < end) ? pos + 1 : end;
+    }
+
+    std::vector<std::vector<int> > rows(chunkCnt);
+
+    if ( chunkCnt == 1 ) {
+        parseRows(chunkBegin[0], chunkBegin[1], delimiter, &rows[0]);
+    }
+    else {
+        FitThreadPool threadPool(chunkCnt - 1);
+
+        threadPool.parallelFor(chunkCnt, [&](int chunk, int participant) {
+            DUNUSED_PARAM(participant);
+
+            parseRows(chunkBegin[chunk], chunkBegin[chunk + 1], delimiter, &rows[chunk]);
+        });
+    }
+
+    file.close();
+
+    /* binning */
+    size_t rowCnt = 0;
+    for ( int chunk = 0 ; chunk < chunkCnt ; ++ chunk )
+        rowCnt += rows[chunk].size();
+
+    data->dataSet.reserve((int)(rowCnt/binFac));
+
+    int channelCounter = 0;
+    int channel = 0;
+    int counts = 0;
+
+    for ( int chunk = 0 ; chunk < chunkCnt ; ++ chunk ) {
+        const std::vector<int>& chunkRows = rows[chunk];
+
+        for ( size_t i = 0 ; i < chunkRows.size() ; ++ i ) {
+            channelCounter ++;
+            counts += chunkRows[i];
+
+            data->maxChannel = qMax(channel, data->maxChannel);
+            data->minChannel = qMin(channel, data->minChannel);
+            data->maxCounts = qMax(counts, data->maxCounts);
+            data->minCounts = qMin(counts, data->minCounts);
+
+            if ( counts < 0 )
+                return asciiImportStatus::negativeCounts_ImportStatus;
+
+            if ( !(channelCounter%binFac) ) {
+                data->dataSet.append(channel, counts);
+                counts = 0;
+                channel ++;
+            }
+        }
+    }
+
+    if ( data->dataSet.size() <= 2 )
+        return asciiImportStatus::tooFewData_ImportStatus;
+
+    return asciiImportStatus::ok_ImportStatus;
+}
+
+char PALSASCIIDataImport::detectDelimiter(const char *begin, const char *end)
+{
+    int semicolonRows = 0, pipeRows = 0, blankRows = 0;
+
+    int rowCnt = 0;
+    const char *row = begin;
+
+    while ( row < end && rowCnt < PALS_ASCII_IMPORT_SAMPLE_ROWS ) {
+        const char *rowEnd = row;
+        while ( rowEnd < end && *rowEnd != '\n' )
+            rowEnd ++;
+
+        const QString rowString = QString::fromLocal8Bit(row, (int)(rowEnd - row));
+
+        /* rows with one or two values */
+        if ( !autoDetectDelimiter(rowString).isEmpty() ) {
+            if ( rowString.split(";").size() == 2 )
+                semicolonRows ++;
+            else if ( rowString.split("|").size() == 2 )
+                pipeRows ++;
+            else
+                blankRows ++;
+
+            rowCnt ++;
+        }
+
+        row = rowEnd + 1;
+    }
+
+    if ( semicolonRows > pipeRows && semicolonRows > blankRows )
+        return ';';
+    else if ( pipeRows > blankRows )
+        return '|';
+
+    return ' ';
+}
+
+void PALSASCIIDataImport::parseRows(const char *begin, const char *end, char delimiter, std::vector<int> *counts)
+{
+    counts->clear();
+    counts->reserve((end - begin)/8);
+
+    const char *row = begin;
+
+    while ( row < end ) {
+        const char *rowEnd = (const char*)memchr(row, '\n', end - row);
+        if ( !rowEnd )
+            rowEnd = end;
+
+        int channel = 0;
+        int value = 0;
+        bool ok = false;
+
+        const char *separator = (delimiter != ' ') ? (const char*)memchr(row, delimiter, rowEnd - row) : nullptr;
+
+        if ( separator ) {
+            /* <channel>;<counts> */
+            ok = parseInt(row, separator, &channel)
+                    && parseInt(separator + 1, rowEnd, &value);
+        }
+        else {
+            /* <channel> <counts> or <counts>: columns separated by blanks */
+            const char *token[2] = { nullptr, nullptr };
+            const char *tokenEnd[2] = { nullptr, nullptr };
+
+            int tokenCnt = 0;
+            const char *pos = row;
+
+            while ( pos < rowEnd && tokenCnt < 2 ) {
+                while ( pos < rowEnd && isBlank(*pos) )
+                    pos ++;
+
+                if ( pos == rowEnd )
+                    break;
+
+                token[tokenCnt] = pos;
+
+                while ( pos < rowEnd && !isBlank(*pos) )
+                    pos ++;
+
+                tokenEnd[tokenCnt] = pos;
+                tokenCnt ++;
+            }
+
+            if ( tokenCnt == 2 )
+                ok = parseInt(token[0], tokenEnd[0], &channel)
+                        && parseInt(token[1], tokenEnd[1], &value);
+            else if ( tokenCnt == 1 )
+                ok = parseInt(token[0], tokenEnd[0], &value);
+        }
+
+        if ( ok )
+            counts->push_back(value);
+
+        row = rowEnd + 1;
+    }
+}
+
+QStringList PALSASCIIDataImport::autoDetectDelimiter(const QString& row)
+{
+    if ( row.split(";").size() != 2 )
+    {
+        if ( row.split("|").size() != 2 )
+        {
+            if ( row.split("\t").size() < 2 )
+            {
+                if ( row.split(" ").size() >= 2 )
+                {
+                    QStringList returnList;
+                    const QStringList list = row.split(" ");
+                    const int splitSize = list.size();
+
+                    int cnt = 0;
+                    for ( int i = 0 ; i < splitSize ; ++ i )
+                    {
+                        if ( list.at(i).isEmpty() )
+                            continue;
+                        else
+                        {
+                            bool ok = false;
+                            const int value = (int)QVariant(list.at(i).trimmed()).toDouble(&ok);
+                            DUNUSED_PARAM(value);
+
+                            if ( ok )
+                            {
+                                returnList.append(list.at(i).trimmed());
+                                cnt ++;
+                            }
+
+                            if ( cnt == 2 )
+                                break;
+                        }
+                    }
+
+
+                    return returnList;
+                }
+                else
+                {
+                    QStringList returnList;
+
+                    bool ok = false;
+                    const int value = (int)QVariant(row.trimmed()).toDouble(&ok);
+                    DUNUSED_PARAM(value);
+
+                    if ( ok )
+                    {
+                        returnList.append(row.trimmed());
+                    }
+
+
+                    return returnList;
+                }
+            }
+            else
+            {
+                QStringList returnList;
+                const QStringList list = row.split("\t");
+                const int splitSize = list.size();
+
+                int cnt = 0;
+                for ( int i = 0 ; i < splitSize ; ++ i )
+                {
+                    if ( list.at(i).isEmpty() )
+                        continue;
+                    else
+                    {
+                        bool ok = false;
+                        const int value = (int)QVariant(list.at(i).trimmed()).toDouble(&ok);
+                        DUNUSED_PARAM(value);
+
+                        if ( ok )
+                        {
+                            returnList.append(list.at(i).trimmed());
+                            cnt ++;
+                        }
+
+                        if ( cnt == 2 )
+                            break;
+                    }
+                }
+
+
+                return returnList;
+            }
+        }
+        else
+        {
+            const QStringList list = row.split("|");
+            const QString value1 = list.at(0).trimmed();
+            const QString value2 = list.at(1).trimmed();
+
+            QStringList returnList;
+            returnList.append(value1);
+            returnList.append(value2);
+
+
+            return returnList;
+        }
+    }
+    else
+    {
+        const QStringList list = row.split(";");
+        const QString value1 = list.at(0).trimmed();
+        const QString value2 = list.at(1).trimmed();
+
+        QStringList returnList;
+        returnList.append(value1);
+        returnList.append(value2);
+
+
+        return returnList;
+    }
+
+    return QStringList();
+}
@@ -0,0 +1,86 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+
+#ifndef PALSASCIIDATAIMPORT_H
+#define PALSASCIIDATAIMPORT_H
+
+#include <vector>
+#include <cstring>
+
+#include "settings.h"
+
+#include "../Fit/fitthreadpool.h"
+
+#define PALS_ASCII_IMPORT_SAMPLE_ROWS 64 /* rows used to detect the delimiter */
+#define PALS_ASCII_IMPORT_PARALLEL_SIZE (16 << 20) /* [bytes] files from this size are parsed in parallel chunks */
+#define PALS_ASCII_IMPORT_MIN_CHUNK_SIZE (4 << 20) /* [bytes] */
+
+typedef enum : int {
+    ok_ImportStatus = 0,
+    fileError_ImportStatus = 1, /* file cannot be opened */
+    negativeCounts_ImportStatus = 2, /* values lower than 0 */
+    tooFewData_ImportStatus = 3, /* number of data-points too low (or bin-factor too high) */
+    invalidLayout_ImportStatus = 4 /* list-mode: invalid record layout or histogram settings */
+} asciiImportStatus;
+
+/* lifetime spectrum imported from an ASCII file: one row per channel ([channel] counts) */
+typedef struct {
+    PALSSpectrum dataSet; /* binned data */
+
+    int minChannel;
+    int maxChannel;
+    int minCounts;
+    int maxCounts;
+} PALSASCIIData;
+
+/*
+ * PALSASCIIDataImport - import of ASCII spectra:
+ *----------------------------------------------
+ *
+ * The file is memory-mapped. The delimiter is detected once from the first rows (autoDetectDelimiter(...) rules), then the
+ * rows are parsed in a single pass over the bytes: '<channel><delimiter><counts>' or '<counts>', rows with other content
+ * (header, comments) are skipped. Large files are split into chunks at row boundaries which are parsed concurrently.
+ */
+
+class PALSASCIIDataImport
+{
+public:
+    /* threadCnt: threads of the chunked parse of large files (0: one per core, 1: serial) */
+    static asciiImportStatus importFile(const QString& fileName, int binFac, PALSASCIIData *data, int threadCnt = 0);
+
+    static QStringList autoDetectDelimiter(const QString& row);
+
+    /* ';', '|' or ' ' (columns separated by spaces and/or tabs) */
+    static char detectDelimiter(const char *begin, const char *end);
+
+    /* counts of the rows within [begin, end) (e.g. the bytes appended to a growing file, see PALSSpectrumWatcher) */
+    static void parseRows(const char *begin, const char *end, char delimiter, std::vector<int> *counts);
+};
+
+#endif // PALSASCIIDATAIMPORT_H
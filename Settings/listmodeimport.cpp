@@ -0,0 +1,251 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+#include "listmodeimport.h"
+
+static inline quint64 readUnsigned(const uchar *src, int size) {
+    quint64 value = 0;
+
+    for ( int i = size - 1 ; i >= 0 ; -- i )
+        value = (value << 8) | src[i];
+
+    return value;
+}
+
+static inline bool isValidField(int offset, int size, int recordSize, bool optional) {
+    if ( optional && size == 0 )
+        return true;
+
+    return (size >= 1 && size <= 8 && offset >= 0 && offset + size <= recordSize);
+}
+
+/* event class of a record */
+static inline void classify(const uchar *record, const PALSListModeSettings& settings, bool *isStart, bool *isStop) {
+    const PALSListModeLayout& layout = settings.layout;
+
+    const qint64 detector = (layout.detectorSize > 0) ? (qint64)readUnsigned(record + layout.detectorOffset, layout.detectorSize) : -1;
+    const quint64 energy = (layout.energySize > 0) ? readUnsigned(record + layout.energyOffset, layout.energySize) : 0;
+
+    *isStart = (settings.startDetector < 0 || layout.detectorSize == 0 || detector == settings.startDetector)
+            && (layout.energySize == 0 || (energy >= settings.startEnergyMin && energy <= settings.startEnergyMax));
+
+    *isStop = (settings.stopDetector < 0 || layout.detectorSize == 0 || detector == settings.stopDetector)
+            && (layout.energySize == 0 || (energy >= settings.stopEnergyMin && energy <= settings.stopEnergyMax));
+}
+
+asciiImportStatus PALSListModeImport::importFile(const QString &fileName, const PALSListModeSettings &settings, PALSASCIIData *data, int threadCnt)
+{
+    if ( !isValid(settings) )
+        return asciiImportStatus::invalidLayout_ImportStatus;
+
+    QFile file(fileName);
+
+    if ( !file.open(QIODevice::ReadOnly) )
+        return asciiImportStatus::fileError_ImportStatus;
+
+    data->dataSet.clear();
+    data->minChannel = INT_MAX;
+    data->maxChannel = -INT_MAX;
+    data->minCounts = INT_MAX;
+    data->maxCounts = -INT_MAX;
+
+    /* memory-mapped (read as fallback) */
+    const qint64 size = file.size();
+    qint64 length = size;
+
+    QByteArray content;
+    const uchar *records = (size > 0) ? file.map(0, size) : nullptr;
+
+    if ( !records && size > 0 ) {
+        content = file.readAll();
+
+        records = (const uchar*)content.constData();
+        length = content.size();
+    }
+
+    const qint64 recordCnt = length/settings.layout.recordSize;
+
+    /* chunks of records */
+    int chunkCnt = 1;
+
+    if ( threadCnt != 1 && length >= PALS_LISTMODE_PARALLEL_SIZE ) {
+        chunkCnt = (threadCnt <= 0) ? FitThreadPool::idealThreadCount() : threadCnt;
+        chunkCnt = (int)qBound((qint64)1, qMin((qint64)chunkCnt, length/PALS_LISTMODE_MIN_CHUNK_SIZE), (qint64)256);
+    }
+
+    std::vector<std::vector<quint64> > counts(chunkCnt);
+
+    if ( chunkCnt == 1 ) {
+        histogram(records, 0, recordCnt, settings, &counts[0]);
+    }
+    else {
+        FitThreadPool threadPool(chunkCnt - 1);
+
+        threadPool.parallelFor(chunkCnt, [&](int chunk, int participant) {
+            DUNUSED_PARAM(participant);
+
+            histogram(records, recordCnt*chunk/chunkCnt, recordCnt*(chunk + 1)/chunkCnt, settings, &counts[chunk]);
+        });
+    }
+
+    file.close();
+
+    /* merge the private histograms */
+    quint64 eventCnt = 0;
+
+    data->dataSet.resize(settings.channelCnt);
+
+    double *channels = data->dataSet.channelData();
+    double *histogramCounts = data->dataSet.countsData();
+
+    for ( int channel = 0 ; channel < settings.channelCnt ; ++ channel ) {
+        quint64 channelCounts = 0;
+
+        for ( int chunk = 0 ; chunk < chunkCnt ; ++ chunk )
+            channelCounts += counts[chunk][channel];
+
+        eventCnt += channelCounts;
+
+        const int value = (int)qMin(channelCounts, (quint64)INT_MAX);
+
+        channels[channel] = channel;
+        histogramCounts[channel] = value;
+
+        data->minCounts = qMin(value, data->minCounts);
+        data->maxCounts = qMax(value, data->maxCounts);
+    }
+
+    data->minChannel = 0;
+    data->maxChannel = settings.channelCnt - 1;
+
+    if ( !eventCnt )
+        return asciiImportStatus::tooFewData_ImportStatus;
+
+    return asciiImportStatus::ok_ImportStatus;
+}
+
+bool PALSListModeImport::isValid(const PALSListModeSettings &settings)
+{
+    const PALSListModeLayout& layout = settings.layout;
+
+    return (layout.recordSize > 0
+            && isValidField(layout.timestampOffset, layout.timestampSize, layout.recordSize, false)
+            && isValidField(layout.detectorOffset, layout.detectorSize, layout.recordSize, true)
+            && isValidField(layout.energyOffset, layout.energySize, layout.recordSize, true)
+            && layout.timestampUnit > 0.0
+            && settings.coincidenceWindow > 0.0
+            && settings.binWidth > 0.0
+            && settings.channelCnt > 2);
+}
+
+PALSListModeSettings PALSListModeImport::defaultSettings()
+{
+    PALSListModeSettings settings;
+
+    settings.layout.recordSize = 8;
+    settings.layout.timestampOffset = 0;
+    settings.layout.timestampSize = 6;
+    settings.layout.timestampUnit = 1.0;
+    settings.layout.detectorOffset = 6;
+    settings.layout.detectorSize = 1;
+    settings.layout.energyOffset = 7;
+    settings.layout.energySize = 1;
+
+    settings.startDetector = 0;
+    settings.stopDetector = 1;
+
+    settings.startEnergyMin = 0;
+    settings.startEnergyMax = 255;
+    settings.stopEnergyMin = 0;
+    settings.stopEnergyMax = 255;
+
+    settings.coincidenceWindow = 50000.0;
+
+    settings.binWidth = 5.0;
+    settings.timeOffset = 1000.0;
+    settings.channelCnt = 4096;
+
+    return settings;
+}
+
+void PALSListModeImport::histogram(const uchar *records, qint64 firstRecord, qint64 lastRecord, const PALSListModeSettings &settings, std::vector<quint64> *counts)
+{
+    const PALSListModeLayout& layout = settings.layout;
+
+    counts->assign(settings.channelCnt, 0);
+
+    bool isStart = false, isStop = false;
+
+    /* start event pending from the records in front of the chunk: the last start/stop event decides */
+    bool hasStart = false;
+    quint64 startTime = 0;
+
+    for ( qint64 r = firstRecord - 1 ; r >= 0 ; -- r ) {
+        const uchar *record = records + r*layout.recordSize;
+
+        classify(record, settings, &isStart, &isStop);
+
+        if ( isStart ) {
+            hasStart = true;
+            startTime = readUnsigned(record + layout.timestampOffset, layout.timestampSize);
+            break;
+        }
+
+        if ( isStop )
+            break;
+    }
+
+    for ( qint64 r = firstRecord ; r < lastRecord ; ++ r ) {
+        const uchar *record = records + r*layout.recordSize;
+
+        classify(record, settings, &isStart, &isStop);
+
+        if ( !isStart && !isStop )
+            continue;
+
+        const quint64 time = readUnsigned(record + layout.timestampOffset, layout.timestampSize);
+
+        if ( isStop && hasStart ) {
+            const double lifetime = (double)(qint64)(time - startTime)*layout.timestampUnit;
+
+            if ( lifetime >= 0.0 && lifetime <= settings.coincidenceWindow ) {
+                const double channel = std::floor((lifetime + settings.timeOffset)/settings.binWidth);
+
+                if ( channel >= 0.0 && channel < (double)settings.channelCnt )
+                    (*counts)[(int)channel] ++;
+            }
+
+            hasStart = false;
+        }
+
+        if ( isStart ) {
+            hasStart = true;
+            startTime = time;
+        }
+    }
+}
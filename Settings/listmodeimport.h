@@ -0,0 +1,104 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+#ifndef PALSLISTMODEIMPORT_H
+#define PALSLISTMODEIMPORT_H
+
+#include <vector>
+
+#include "asciidataimport.h"
+
+#include "../Fit/fitthreadpool.h"
+
+#define PALS_LISTMODE_PARALLEL_SIZE (16 << 20) /* [bytes] files from this size are histogrammed in parallel chunks */
+#define PALS_LISTMODE_MIN_CHUNK_SIZE (4 << 20) /* [bytes] */
+
+/* binary event file: fixed-size records, unsigned little-endian fields */
+typedef struct {
+    int recordSize; /* [bytes] */
+
+    int timestampOffset; /* [bytes] within the record */
+    int timestampSize; /* [bytes] 1 ... 8 */
+    double timestampUnit; /* [ps] per timestamp LSB */
+
+    int detectorOffset;
+    int detectorSize; /* 0: no detector id */
+
+    int energyOffset;
+    int energySize; /* 0: no energy */
+} PALSListModeLayout;
+
+/* start/stop events and the lifetime histogram */
+typedef struct {
+    PALSListModeLayout layout;
+
+    int startDetector; /* -1: any detector */
+    int stopDetector;
+
+    /* energy windows [min, max] (channels of the energy field) */
+    quint64 startEnergyMin;
+    quint64 startEnergyMax;
+    quint64 stopEnergyMin;
+    quint64 stopEnergyMax;
+
+    double coincidenceWindow; /* [ps] maximum stop - start */
+
+    double binWidth; /* [ps] channel width of the histogram */
+    double timeOffset; /* [ps] added to each lifetime (position of t0) */
+    int channelCnt;
+} PALSListModeSettings;
+
+/*
+ * PALSListModeImport - lifetime histogram from a list-mode event file:
+ *--------------------------------------------------------------------
+ *
+ * The events are read in file (time) order from the memory-mapped file. An event of the start detector within the start
+ * energy window opens a coincidence, the next event of the stop detector within the stop energy window closes it and adds
+ * its lifetime (stop - start) to the histogram if it lies within the coincidence window. An event matching both (e.g. a
+ * single detector with both windows) closes the pending coincidence and opens the next one.
+ *
+ * Large files are split into chunks of records which are histogrammed concurrently into private histograms and merged at
+ * the end. A chunk takes over the pending start event from the records in front of it, so the result equals the serial one.
+ */
+
+class PALSListModeImport
+{
+public:
+    /* threadCnt: threads of the chunked histogramming of large files (0: one per core, 1: serial) */
+    static asciiImportStatus importFile(const QString& fileName, const PALSListModeSettings& settings, PALSASCIIData *data, int threadCnt = 0);
+
+    static bool isValid(const PALSListModeSettings& settings);
+
+    /* 8 bytes: timestamp (6), detector (1), energy (1), 1 ps per LSB */
+    static PALSListModeSettings defaultSettings();
+
+private:
+    static void histogram(const uchar *records, qint64 firstRecord, qint64 lastRecord, const PALSListModeSettings& settings, std::vector<quint64> *counts);
+};
+
+#endif // PALSLISTMODEIMPORT_H
@@ -0,0 +1,502 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+
+#include "projectbinaryfile.h"
+#include "settings.h"
+
+#include <QSaveFile>
+
+#define PALS_BINARY_MAX_TREE_DEPTH 64
+#define PALS_BINARY_MAX_ARRAY_INDEX (PALS_PROJECT_ARRAY_COUNT*4096)
+
+typedef enum : quint8 {
+    text_NodeKind = 0, /* leaf: UTF-8 value */
+    parent_NodeKind = 1, /* child nodes */
+    array_NodeKind = 2 /* leaf: value stored in a 'XYDA' chunk */
+} binaryNodeKind;
+
+static inline void appendUInt8(QByteArray *buffer, quint8 value) {
+    buffer->append((char)value);
+}
+
+static inline void appendUInt16(QByteArray *buffer, quint16 value) {
+    const quint16 le = qToLittleEndian(value);
+    buffer->append((const char*)&le, sizeof(le));
+}
+
+static inline void appendUInt32(QByteArray *buffer, quint32 value) {
+    const quint32 le = qToLittleEndian(value);
+    buffer->append((const char*)&le, sizeof(le));
+}
+
+static inline void appendUInt64(QByteArray *buffer, quint64 value) {
+    const quint64 le = qToLittleEndian(value);
+    buffer->append((const char*)&le, sizeof(le));
+}
+
+static inline void appendString(QByteArray *buffer, const QString& value) {
+    const QByteArray utf8 = value.toUtf8();
+
+    appendUInt32(buffer, (quint32)utf8.size());
+    buffer->append(utf8);
+}
+
+/* bounds-checked reading from a payload: returns false (and leaves *pos) if the payload is too short */
+static inline bool readUInt8(const QByteArray& buffer, int *pos, quint8 *value) {
+    if ( *pos + 1 > buffer.size() )
+        return false;
+
+    *value = (quint8)buffer.at(*pos);
+    *pos += 1;
+
+    return true;
+}
+
+static inline bool readUInt32(const QByteArray& buffer, int *pos, quint32 *value) {
+    if ( *pos + 4 > buffer.size() )
+        return false;
+
+    *value = qFromLittleEndian<quint32>((const uchar*)buffer.constData() + *pos);
+    *pos += 4;
+
+    return true;
+}
+
+static inline bool readUInt64(const QByteArray& buffer, int *pos, quint64 *value) {
+    if ( *pos + 8 > buffer.size() )
+        return false;
+
+    *value = qFromLittleEndian<quint64>((const uchar*)buffer.constData() + *pos);
+    *pos += 8;
+
+    return true;
+}
+
+static inline bool readString(const QByteArray& buffer, int *pos, QString *value) {
+    quint32 size = 0;
+
+    if ( !readUInt32(buffer, pos, &size)
+         || size > (quint32)(buffer.size() - *pos) )
+        return false;
+
+    *value = QString::fromUtf8(buffer.constData() + *pos, (int)size);
+    *pos += (int)size;
+
+    return true;
+}
+
+static inline void appendDoubles(QByteArray *buffer, const double *data, int cnt) {
+    const int offset = buffer->size();
+    buffer->resize(offset + cnt*(int)sizeof(double));
+
+    uchar *dest = (uchar*)buffer->data() + offset;
+
+    for ( int i = 0 ; i < cnt ; ++ i ) {
+        const double value = data[i];
+
+        quint64 bits;
+        memcpy(&bits, &value, sizeof(double));
+
+        qToLittleEndian(bits, dest + i*sizeof(double));
+    }
+}
+
+static inline double doubleAt(const uchar *src) {
+    const quint64 bits = qFromLittleEndian<quint64>(src);
+
+    double value;
+    memcpy(&value, &bits, sizeof(double));
+
+    return value;
+}
+
+PALSProjectBinaryFile::PALSProjectBinaryFile() {}
+PALSProjectBinaryFile::~PALSProjectBinaryFile() {}
+
+bool PALSProjectBinaryFile::isBinaryFile(const QString &fileName)
+{
+    QFile file(fileName);
+
+    if ( !file.open(QIODevice::ReadOnly) )
+        return false;
+
+    const QByteArray magic = file.read(8);
+
+    file.close();
+
+    return (magic.size() == 8 && !qstrncmp(magic.constData(), PALS_BINARY_PROJECT_MAGIC, 8));
+}
+
+bool PALSProjectBinaryFile::isBinaryFileName(const QString &fileName)
+{
+    return fileName.endsWith(PALS_BINARY_PROJECT_EXTENSION, Qt::CaseInsensitive);
+}
+
+int PALSProjectBinaryFile::arrayIndex(int dataStructureIndex, projectArray array)
+{
+    return PALS_PROJECT_ARRAY_COUNT*dataStructureIndex + (int)array;
+}
+
+int PALSProjectBinaryFile::arrayOfNode(const QString &nodeName)
+{
+    if ( nodeName == "lt-data-raw" )
+        return rawData_ProjectArray;
+    else if ( nodeName == "lt-data" )
+        return data_ProjectArray;
+    else if ( nodeName == "lt-fit-data" )
+        return fitData_ProjectArray;
+    else if ( nodeName == "lt-residuals" )
+        return residuals_ProjectArray;
+
+    return -1;
+}
+
+void PALSProjectBinaryFile::writeNode(const DSimpleXMLNode *node, const QString &parentName, int depth, int dataStructureIndex, QByteArray *payload)
+{
+    appendString(payload, node->nodeName());
+
+    if ( node->hasChilds() ) {
+        const QList<DSimpleXMLNode*> childs = node->getChilds();
+
+        appendUInt8(payload, parent_NodeKind);
+        appendUInt32(payload, (quint32)childs.size());
+
+        for ( int i = 0 ; i < childs.size() ; ++ i ) {
+            /* project => data-structure => PALS_ID_<i> => data => lt-... */
+            writeNode(childs.at(i), node->nodeName(), depth + 1, (depth == 1)?i:dataStructureIndex, payload);
+        }
+
+        return;
+    }
+
+    const int array = (depth == 4 && parentName == "data") ? arrayOfNode(node->nodeName()) : -1;
+
+    if ( array >= 0 ) {
+        appendUInt8(payload, array_NodeKind);
+        appendUInt32(payload, (quint32)arrayIndex(dataStructureIndex, (projectArray)array));
+    }
+    else {
+        appendUInt8(payload, text_NodeKind);
+        appendString(payload, node->getValue().toString());
+    }
+}
+
+DSimpleXMLNode *PALSProjectBinaryFile::readNode(const QByteArray &payload, int *pos, int depth)
+{
+    if ( depth > PALS_BINARY_MAX_TREE_DEPTH )
+        return nullptr;
+
+    QString name;
+    quint8 kind = 0;
+
+    if ( !readString(payload, pos, &name)
+         || name.isEmpty()
+         || !readUInt8(payload, pos, &kind) )
+        return nullptr;
+
+    DSimpleXMLNode *node = new DSimpleXMLNode(name);
+
+    switch ( kind ) {
+    case text_NodeKind: {
+        QString value;
+
+        if ( !readString(payload, pos, &value) ) {
+            DDELETE_SAFETY(node);
+            return nullptr;
+        }
+
+        node->setValue(value);
+    }
+        break;
+
+    case array_NodeKind: {
+        quint32 index = 0;
+
+        if ( !readUInt32(payload, pos, &index) ) {
+            DDELETE_SAFETY(node);
+            return nullptr;
+        }
+
+        node->setValue(""); /* set from the 'XYDA' chunk */
+    }
+        break;
+
+    case parent_NodeKind: {
+        quint32 childCnt = 0;
+
+        if ( !readUInt32(payload, pos, &childCnt) ) {
+            DDELETE_SAFETY(node);
+            return nullptr;
+        }
+
+        for ( quint32 i = 0 ; i < childCnt ; ++ i ) {
+            DSimpleXMLNode *child = readNode(payload, pos, depth + 1);
+
+            if ( !child ) {
+                DDELETE_SAFETY(node);
+                return nullptr;
+            }
+
+            *node << child;
+        }
+    }
+        break;
+
+    default:
+        DDELETE_SAFETY(node);
+        return nullptr;
+    }
+
+    return node;
+}
+
+bool PALSProjectBinaryFile::writeChunk(QIODevice *device, quint32 id, const QByteArray &payload, bool compressed)
+{
+    QByteArray stored;
+    quint32 flags = 0;
+
+    /* compressed only if it pays off */
+    if ( compressed
+         && DCompressor::compressIt(&stored, payload, DCompressor::BEST_SPEED)
+         && stored.size() < payload.size() )
+        flags |= PALS_BINARY_CHUNK_COMPRESSED;
+    else
+        stored = payload;
+
+    QByteArray header;
+    header.reserve(PALS_BINARY_CHUNK_HEADER_SIZE);
+
+    appendUInt32(&header, id);
+    appendUInt32(&header, flags);
+    appendUInt64(&header, (quint64)payload.size());
+    appendUInt64(&header, (quint64)stored.size());
+    appendUInt32(&header, DCompressor::crc32(payload));
+    appendUInt32(&header, 0); /* reserved */
+
+#ifdef __BINARY_PROJECT_DEBUG
+    qDebug() << "chunk " << QByteArray((const char*)&id, 4) << ": " << payload.size() << " bytes (stored: " << stored.size() << ")";
+#endif
+
+    return (device->write(header) == header.size()
+            && device->write(stored) == stored.size());
+}
+
+bool PALSProjectBinaryFile::write(const QString &fileName, const DSimpleXMLNode *rootNode, const QList<PALSSpectrum> &arrays, bool compressed)
+{
+    if ( !rootNode )
+        return false;
+
+    QSaveFile file(fileName); /* replaces the file on commit() only */
+
+    if ( !file.open(QIODevice::WriteOnly) )
+        return false;
+
+    int chunkCnt = 1;
+    for ( const PALSSpectrum& array : arrays ) {
+        if ( !array.isEmpty() )
+            chunkCnt ++;
+    }
+
+    QByteArray header(PALS_BINARY_PROJECT_MAGIC, 8);
+
+    appendUInt16(&header, PALS_BINARY_PROJECT_VERSION);
+    appendUInt16(&header, 0); /* flags (reserved) */
+    appendUInt32(&header, (quint32)chunkCnt);
+
+    if ( file.write(header) != header.size() )
+        return false;
+
+    QByteArray tree;
+    writeNode(rootNode, QString(), 0, 0, &tree);
+
+    if ( !writeChunk(&file, PALS_BINARY_CHUNK_TREE, tree, compressed) )
+        return false;
+
+    for ( int i = 0 ; i < arrays.size() ; ++ i ) {
+        const PALSSpectrum& array = arrays.at(i);
+
+        if ( array.isEmpty() )
+            continue;
+
+        QByteArray data;
+        data.reserve(16 + 2*array.size()*(int)sizeof(double));
+
+        appendUInt32(&data, (quint32)i);
+        appendUInt32(&data, 0); /* reserved */
+        appendUInt64(&data, (quint64)array.size());
+
+        appendDoubles(&data, array.channels(), array.size());
+        appendDoubles(&data, array.counts(), array.size());
+
+        if ( !writeChunk(&file, PALS_BINARY_CHUNK_XY_DATA, data, compressed) )
+            return false;
+    }
+
+    return file.commit();
+}
+
+bool PALSProjectBinaryFile::read(const QString &fileName, DSimpleXMLTag *content, QList<PALSSpectrum> *arrays)
+{
+    if ( !content || !arrays )
+        return false;
+
+    QFile file(fileName);
+
+    if ( !file.open(QIODevice::ReadOnly) )
+        return false;
+
+    const QByteArray fileContent = file.readAll();
+
+    file.close();
+
+    if ( fileContent.size() < PALS_BINARY_FILE_HEADER_SIZE
+         || qstrncmp(fileContent.constData(), PALS_BINARY_PROJECT_MAGIC, 8) )
+        return false;
+
+    const quint16 version = qFromLittleEndian<quint16>((const uchar*)fileContent.constData() + 8);
+    const quint32 chunkCnt = qFromLittleEndian<quint32>((const uchar*)fileContent.constData() + 12);
+
+    if ( version > PALS_BINARY_PROJECT_VERSION ) {
+        DERRORLOG("PALSProjectBinaryFile: unsupported version %d.", (int)version);
+        return false;
+    }
+
+    arrays->clear();
+
+    DSimpleXMLNode *rootNode = nullptr;
+    int pos = PALS_BINARY_FILE_HEADER_SIZE;
+
+    for ( quint32 c = 0 ; c < chunkCnt ; ++ c ) {
+        quint32 id = 0, flags = 0, crc = 0, reserved = 0;
+        quint64 size = 0, storedSize = 0;
+
+        if ( !readUInt32(fileContent, &pos, &id)
+             || !readUInt32(fileContent, &pos, &flags)
+             || !readUInt64(fileContent, &pos, &size)
+             || !readUInt64(fileContent, &pos, &storedSize)
+             || !readUInt32(fileContent, &pos, &crc)
+             || !readUInt32(fileContent, &pos, &reserved)
+             || storedSize > (quint64)(fileContent.size() - pos)
+             || size > (quint64)INT_MAX ) {
+            DDELETE_SAFETY(rootNode);
+            return false;
+        }
+
+        /* unknown chunk (newer minor revision) */
+        if ( id != PALS_BINARY_CHUNK_TREE
+             && id != PALS_BINARY_CHUNK_XY_DATA ) {
+            pos += (int)storedSize;
+            continue;
+        }
+
+        const QByteArray stored = QByteArray::fromRawData(fileContent.constData() + pos, (int)storedSize);
+        pos += (int)storedSize;
+
+        QByteArray payload;
+
+        if ( flags & PALS_BINARY_CHUNK_COMPRESSED ) {
+            if ( !DCompressor::uncompressIt(&payload, stored, (int)size) ) {
+                DDELETE_SAFETY(rootNode);
+                return false;
+            }
+        }
+        else
+            payload = QByteArray(stored.constData(), stored.size());
+
+        if ( payload.size() != (int)size
+             || DCompressor::crc32(payload) != crc ) {
+            DERRORLOG("PALSProjectBinaryFile: checksum error in chunk %d.", (int)c);
+
+            DDELETE_SAFETY(rootNode);
+            return false;
+        }
+
+        if ( id == PALS_BINARY_CHUNK_TREE ) {
+            int treePos = 0;
+
+            DDELETE_SAFETY(rootNode);
+            rootNode = readNode(payload, &treePos, 0);
+
+            if ( !rootNode )
+                return false;
+        }
+        else {
+            int dataPos = 0;
+
+            quint32 index = 0, dataReserved = 0;
+            quint64 count = 0;
+
+            if ( !readUInt32(payload, &dataPos, &index)
+                 || !readUInt32(payload, &dataPos, &dataReserved)
+                 || !readUInt64(payload, &dataPos, &count)
+                 || index >= PALS_BINARY_MAX_ARRAY_INDEX
+                 || count > (quint64)(payload.size() - dataPos)/(2*sizeof(double)) ) {
+                DDELETE_SAFETY(rootNode);
+                return false;
+            }
+
+            while ( arrays->size() <= (int)index )
+                arrays->append(PALSSpectrum());
+
+            PALSSpectrum array((int)count);
+
+            double *channels = array.channelData();
+            double *counts = array.countsData();
+
+            const uchar *x = (const uchar*)payload.constData() + dataPos;
+            const uchar *y = x + count*sizeof(double);
+
+            for ( quint64 i = 0 ; i < count ; ++ i ) {
+                channels[i] = doubleAt(x + i*sizeof(double));
+                counts[i] = doubleAt(y + i*sizeof(double));
+            }
+
+            (*arrays)[(int)index] = array;
+        }
+    }
+
+    if ( !rootNode )
+        return false;
+
+    *content = DSimpleXMLTag(DSimpleXMLString(rootNode));
+
+    DDELETE_SAFETY(rootNode);
+
+    return true;
+}
+
+bool PALSProjectBinaryFile::convert(const QString &sourceFileName, const QString &targetFileName)
+{
+    PALSProject project;
+
+    if ( !project.load(sourceFileName) )
+        return false;
+
+    return project.save(targetFileName, false);
+}
@@ -0,0 +1,112 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+
+#ifndef PALSPROJECTBINARYFILE_H
+#define PALSPROJECTBINARYFILE_H
+
+#include <QtEndian>
+
+#include "../DLib/DLib.h"
+
+#include "spectrum.h"
+
+//#define __BINARY_PROJECT_DEBUG
+
+#define PALS_BINARY_PROJECT_EXTENSION QString(".dquickltb")
+
+#define PALS_BINARY_PROJECT_MAGIC "DQLTBIN" /* 8 bytes incl. the terminating zero */
+#define PALS_BINARY_PROJECT_VERSION 1 /* files of a higher version are rejected */
+
+#define PALS_BINARY_FILE_HEADER_SIZE 16
+#define PALS_BINARY_CHUNK_HEADER_SIZE 32
+
+/* chunk identifiers (FourCC, little-endian) */
+#define PALS_BINARY_CHUNK_TREE 0x45455254u /* 'TREE': node tree of the project */
+#define PALS_BINARY_CHUNK_XY_DATA 0x41445958u /* 'XYDA': typed data of a data set */
+
+/* chunk flags */
+#define PALS_BINARY_CHUNK_COMPRESSED 0x1u /* payload compressed (DCompressor) */
+
+/* typed arrays of a data set: index = PALS_PROJECT_ARRAY_COUNT*dataStructure + projectArray */
+#define PALS_PROJECT_ARRAY_COUNT 4
+
+typedef enum : int {
+    rawData_ProjectArray = 0, /* lt-data-raw */
+    data_ProjectArray = 1, /* lt-data (binned) */
+    fitData_ProjectArray = 2, /* lt-fit-data */
+    residuals_ProjectArray = 3 /* lt-residuals */
+} projectArray;
+
+class PALSProject;
+
+/*
+ * PALSProjectBinaryFile - binary project file (.dquickltb):
+ *----------------------------------------------------------
+ *
+ * file header: magic (8 bytes), uint16 version, uint16 flags (reserved), uint32 number of chunks
+ * chunk: uint32 id, uint32 flags, uint64 payload size (uncompressed), uint64 stored size, uint32 CRC-32 of the (uncompressed)
+ *        payload, uint32 reserved, payload
+ *
+ * All values are little-endian. The 'TREE' chunk contains the node tree of the XML project file (name, value as UTF-8 text),
+ * the data sets ({x|y} values of the XML file) are stored in 'XYDA' chunks as typed arrays (uint32 array index, uint32 reserved,
+ * uint64 count, count x float64, count y float64). Chunks of unknown id are skipped.
+ *
+ * The XML project file (.dquicklt) remains the import/export format: both files contain the same information.
+ */
+
+class PALSProjectBinaryFile
+{
+public:
+    /* magic of the file */
+    static bool isBinaryFile(const QString& fileName);
+    /* extension of the file name */
+    static bool isBinaryFileName(const QString& fileName);
+
+    static int arrayIndex(int dataStructureIndex, projectArray array);
+
+    /* the nodes of the arrays (see projectArray) are stored as typed arrays instead of their (text) value */
+    static bool write(const QString& fileName, const DSimpleXMLNode *rootNode, const QList<PALSSpectrum>& arrays, bool compressed = true);
+    static bool read(const QString& fileName, DSimpleXMLTag *content, QList<PALSSpectrum> *arrays);
+
+    /* lossless conversion XML <-> binary (format of the target by its extension) */
+    static bool convert(const QString& sourceFileName, const QString& targetFileName);
+
+private:
+    PALSProjectBinaryFile();
+    virtual ~PALSProjectBinaryFile();
+
+    static void writeNode(const DSimpleXMLNode *node, const QString& parentName, int depth, int dataStructureIndex, QByteArray *payload);
+    static DSimpleXMLNode *readNode(const QByteArray& payload, int *pos, int depth);
+
+    static bool writeChunk(QIODevice *device, quint32 id, const QByteArray& payload, bool compressed);
+
+    static int arrayOfNode(const QString& nodeName);
+};
+
+#endif // PALSPROJECTBINARYFILE_H
@@ -85,6 +85,16 @@ bool PALSProjectSettingsManager::load()
             if ( ok ) m_plotWindowWasShown->setValue(valueTag.getValue());
             else m_plotWindowWasShown->setValue(true);
 
+            valueTag = tag.getTag("fit-thread-count", &ok);
+
+            if ( ok ) m_fitThreadCount->setValue(valueTag.getValue());
+            else m_fitThreadCount->setValue(0);
+
+            valueTag = tag.getTag("fit-multi-start-count", &ok);
+
+            if ( ok ) m_fitMultiStartCount->setValue(valueTag.getValue());
+            else m_fitMultiStartCount->setValue(1);
+
             const QStringList pathList = ((DString)m_lastProjectNode->getValue().toString()).parseBetween2("{", "}");
 
             m_projectPathList.clear();
@@ -102,6 +112,8 @@ bool PALSProjectSettingsManager::load()
             m_lastBackgroundChannelRangeNode->setValue(1000);
             m_resultWindowWasShown->setValue(true);
             m_plotWindowWasShown->setValue(true);
+            m_fitThreadCount->setValue(0);
+            m_fitMultiStartCount->setValue(1);
             m_projectPathList.clear();
 
             return false;
@@ -115,6 +127,8 @@ bool PALSProjectSettingsManager::load()
         m_lastBackgroundChannelRangeNode->setValue(1000);
         m_resultWindowWasShown->setValue(true);
         m_plotWindowWasShown->setValue(true);
+        m_fitThreadCount->setValue(0);
+        m_fitMultiStartCount->setValue(1);
         m_projectPathList.clear();
 
         return false;
@@ -187,6 +201,16 @@ void PALSProjectSettingsManager::setPlotWindowWasShownOnExit(bool on)
     m_plotWindowWasShown->setValue(on);
 }
 
+void PALSProjectSettingsManager::setFitThreadCount(int threadCnt)
+{
+    m_fitThreadCount->setValue(threadCnt);
+}
+
+void PALSProjectSettingsManager::setFitMultiStartCount(int startCnt)
+{
+    m_fitMultiStartCount->setValue(startCnt);
+}
+
 QStringList PALSProjectSettingsManager::getLastProjectPathList() const
 {
     return m_projectPathList;
@@ -222,6 +246,16 @@ bool PALSProjectSettingsManager::getPlotWindowWasShownOnExit() const
     return m_plotWindowWasShown->getValue().toBool();
 }
 
+int PALSProjectSettingsManager::getFitThreadCount() const
+{
+    return m_fitThreadCount->getValue().toInt();
+}
+
+int PALSProjectSettingsManager::getFitMultiStartCount() const
+{
+    return m_fitMultiStartCount->getValue().toInt();
+}
+
 PALSProjectSettingsManager::PALSProjectSettingsManager()
 {
     m_rootNode = new DSimpleXMLNode("project-settings");
@@ -232,14 +266,22 @@ PALSProjectSettingsManager::PALSProjectSettingsManager()
     m_backgroundCalculationWithLastChannels = new DSimpleXMLNode("background-calculation-using-first-channels");
     m_resultWindowWasShown = new DSimpleXMLNode("result-window-was-shown");
     m_plotWindowWasShown = new DSimpleXMLNode("plot-window-was-shown");
+    m_fitThreadCount = new DSimpleXMLNode("fit-thread-count"); /* threads of a single fit (1: serial, 0: one per core) */
+
+    m_fitMultiStartCount = new DSimpleXMLNode("fit-multi-start-count"); /* concurrent Levenberg-Marquardt runs of a single fit (1: single start) */
+
+    m_fitThreadCount->setValue(0);
+    m_fitMultiStartCount->setValue(1);
 
-    (*m_rootNode) << m_lastProjectNode << m_linLogOnExitNode << m_lastPathNode << m_lastBackgroundChannelRangeNode << m_backgroundCalculationWithLastChannels << m_resultWindowWasShown << m_plotWindowWasShown;
+    (*m_rootNode) << m_lastProjectNode << m_linLogOnExitNode << m_lastPathNode << m_lastBackgroundChannelRangeNode << m_backgroundCalculationWithLastChannels << m_resultWindowWasShown << m_plotWindowWasShown << m_fitThreadCount << m_fitMultiStartCount;
 }
 
 PALSProjectSettingsManager::~PALSProjectSettingsManager()
 {
     save();
 
+    DDELETE_SAFETY(m_fitMultiStartCount);
+    DDELETE_SAFETY(m_fitThreadCount);
     DDELETE_SAFETY(m_plotWindowWasShown);
     DDELETE_SAFETY(m_resultWindowWasShown);
     DDELETE_SAFETY(m_lastProjectNode);
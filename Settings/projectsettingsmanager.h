@@ -43,6 +43,8 @@ class PALSProjectSettingsManager
     DSimpleXMLNode *m_resultWindowWasShown;
     DSimpleXMLNode *m_plotWindowWasShown;
     DSimpleXMLNode *m_backgroundCalculationWithLastChannels;
+    DSimpleXMLNode *m_fitThreadCount;
+    DSimpleXMLNode *m_fitMultiStartCount;
 
     QStringList m_projectPathList;
 
@@ -59,6 +61,8 @@ public:
     void setBackgroundCalculationFromFirstChannels(bool first);
     void setResultWindowWasShownOnExit(bool on);
     void setPlotWindowWasShownOnExit(bool on);
+    void setFitThreadCount(int threadCnt);
+    void setFitMultiStartCount(int startCnt);
 
     QStringList getLastProjectPathList() const;
     bool isLinearLastScaling() const;
@@ -67,6 +71,8 @@ public:
     bool getBackgroundCalculationFromFirstChannels() const;
     bool getResultWindowWasShownOnExit() const;
     bool getPlotWindowWasShownOnExit() const;
+    int getFitThreadCount() const;
+    int getFitMultiStartCount() const;
 
 private:
     PALSProjectSettingsManager();
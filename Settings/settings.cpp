@@ -27,6 +27,7 @@
 *****************************************************************************/
 
 #include "settings.h"
+#include "projectbinaryfile.h"
 
 PALSProject::PALSProject()
 {
@@ -62,9 +63,29 @@ PALSProject::~PALSProject()
     DDELETE_SAFETY(m_rootNode);
 }
 
-bool PALSProject::save(const DString &projectPath)
+bool PALSProject::save(const DString &projectPath, bool updateLastSaveTime)
 {
-    setLastSaveTime(QDateTime::currentDateTime());
+    if ( updateLastSaveTime )
+        setLastSaveTime(QDateTime::currentDateTime());
+
+    for ( unsigned int i = 0 ; i < getSize() ; ++ i )
+        m_dataStructureList.at(i)->getFitSetPtr()->updateParameterNodes();
+
+    if ( PALSProjectBinaryFile::isBinaryFileName(projectPath) ) {
+        QList<PALSSpectrum> arrays;
+
+        for ( unsigned int i = 0 ; i < getSize() ; ++ i ) {
+            const PALSDataSet *dataSet = m_dataStructureList.at(i)->getDataSetPtr();
+
+            arrays << dataSet->getLifeTimeRawData() << dataSet->getLifeTimeData() << dataSet->getFitData() << dataSet->getResiduals();
+        }
+
+        return PALSProjectBinaryFile::write(projectPath, m_rootNode, arrays);
+    }
+
+    /* the binary file refers to the arrays directly, the XML file formats them while the tree is written */
+    for ( unsigned int i = 0 ; i < getSize() ; ++ i )
+        m_dataStructureList.at(i)->getDataSetPtr()->attachSpectraToNodes();
 
     DSimpleXMLWriter xmlWriter(projectPath);
 
@@ -72,60 +93,90 @@ bool PALSProject::save(const DString &projectPath)
     //m_rootNode->XMLMessageBox();
 #endif
 
-    return xmlWriter.writeToFile(m_rootNode);
+    const bool written = xmlWriter.writeToFile(m_rootNode);
+
+    for ( unsigned int i = 0 ; i < getSize() ; ++ i )
+        m_dataStructureList.at(i)->getDataSetPtr()->releaseSpectraFromNodes();
+
+    return written;
 }
 
 bool PALSProject::load(const DString &projectPath)
 {
-    DSimpleXMLReader xmlReader(projectPath);
     DSimpleXMLTag projectContent;
 
+    if ( PALSProjectBinaryFile::isBinaryFile(projectPath) ) {
+        QList<PALSSpectrum> arrays;
+
+        if ( !PALSProjectBinaryFile::read(projectPath, &projectContent, &arrays) )
+            return false;
+
+        loadContent(projectContent);
+
+        /* typed arrays of the data sets */
+        for ( unsigned int i = 0 ; i < getSize() ; ++ i ) {
+            PALSDataSet *dataSet = m_dataStructureList.at(i)->getDataSetPtr();
+
+            dataSet->setLifeTimeRawData(arrays.value(PALSProjectBinaryFile::arrayIndex(i, rawData_ProjectArray)));
+            dataSet->setLifeTimeData(arrays.value(PALSProjectBinaryFile::arrayIndex(i, data_ProjectArray)));
+            dataSet->setFitData(arrays.value(PALSProjectBinaryFile::arrayIndex(i, fitData_ProjectArray)));
+            dataSet->setResiduals(arrays.value(PALSProjectBinaryFile::arrayIndex(i, residuals_ProjectArray)));
+        }
+
+        return true;
+    }
+
+    DSimpleXMLReader xmlReader(projectPath);
+
     if ( xmlReader.readFromFile(&projectContent) )
-    {
-        clear();
+        loadContent(projectContent);
+    else
+        return false;
+
+
+    return true;
+}
+
+void PALSProject::loadContent(const DSimpleXMLTag &projectContent)
+{
+    clear();
 
 #ifdef QT_DEBUG
     //projectContent.XMLMessageBox();
 #endif
 
-        bool ok = false;
-        DSimpleXMLTag safeTag = projectContent.getTag("project").getTag(m_lastSaveTimeNode, &ok);
-
-        if ( ok ) setLastSaveTime(safeTag.getValue().toDateTime());
-        else      setLastSaveTime(QDateTime::currentDateTime());
+    bool ok = false;
+    DSimpleXMLTag safeTag = projectContent.getTag("project").getTag(m_lastSaveTimeNode, &ok);
 
-        safeTag = projectContent.getTag("project").getTag(m_projectNameNode, &ok);
+    if ( ok ) setLastSaveTime(safeTag.getValue().toDateTime());
+    else      setLastSaveTime(QDateTime::currentDateTime());
 
-        if ( ok ) setName(safeTag.getValue().toString());
-        else      setName(DString("undefined project-title"));
+    safeTag = projectContent.getTag("project").getTag(m_projectNameNode, &ok);
 
-        safeTag = projectContent.getTag("project").getTag(m_asciiDataNameNode, &ok);
+    if ( ok ) setName(safeTag.getValue().toString());
+    else      setName(DString("undefined project-title"));
 
-        if ( ok ) setASCIIDataName(safeTag.getValue().toString());
-        else      setASCIIDataName(DString("unknown"));
+    safeTag = projectContent.getTag("project").getTag(m_asciiDataNameNode, &ok);
 
-        ok = true;
-        int dataStructCnt = 0;
+    if ( ok ) setASCIIDataName(safeTag.getValue().toString());
+    else      setASCIIDataName(DString("unknown"));
 
-        do
-        {
-            const DString name = DString("PALS_ID_" + QVariant(dataStructCnt).toString());
-            const DSimpleXMLTag tag = projectContent.getTag("project").getTag("data-structure").getTag(name, &ok);
-            DUNUSED_PARAM(tag);
+    ok = true;
+    int dataStructCnt = 0;
 
-            if ( ok ){
-                PALSDataStructure *dStr = new PALSDataStructure(this, projectContent.getTag("project").getTag("data-structure"), name);
-                DUNUSED_PARAM(dStr);
-            }
-
-            dataStructCnt ++;
-        } while ( ok );
-    }
-    else
-        return false;
+    do
+    {
+        const DString name = DString("PALS_ID_" + QVariant(dataStructCnt).toString());
+        const DSimpleXMLTag tag = projectContent.getTag("project").getTag("data-structure").getTag(name, &ok);
+        DUNUSED_PARAM(tag);
 
+        if ( ok ){
+            PALSDataStructure *dStr = new PALSDataStructure(this, projectContent.getTag("project").getTag("data-structure"), name);
+            DUNUSED_PARAM(dStr);
+        }
 
-    return true;
+        dataStructCnt ++;
+    } while ( ok );
 }
 
 unsigned int PALSProject::getSize() const
@@ -545,21 +596,22 @@ PALSDataSet::PALSDataSet(PALSDataStructure *parent, const DSimpleXMLTag &tag)
 
     bool ok = false;
 
+    /* the spectra are parsed into the typed arrays only: the data nodes keep no text copy */
     DSimpleXMLTag safeTag = tag.getTag("data").getTag("lt-data", &ok);
-    if ( ok ) m_xyDataNode->setValue(safeTag.getValue());
+    if ( ok ) parseSpectrum(safeTag.getValue().toString(), &m_xyData);
 
     safeTag = tag.getTag("data").getTag("lt-data-raw", &ok);
-    if ( ok ) m_xyRawDataNode->setValue(safeTag.getValue());
+    if ( ok ) parseSpectrum(safeTag.getValue().toString(), &m_xyRawData);
 
     safeTag = tag.getTag("data").getTag("bin-factor", &ok);
     if ( ok ) m_xyDataBinFac->setValue(safeTag.getValue());
     else m_xyDataBinFac->setValue(1);
 
     safeTag = tag.getTag("data").getTag("lt-fit-data", &ok);
-    if ( ok ) m_fitDataNode->setValue(safeTag.getValue());
+    if ( ok ) parseSpectrum(safeTag.getValue().toString(), &m_fitData);
 
     safeTag = tag.getTag("data").getTag("lt-residuals", &ok);
-    if ( ok ) m_residualNode->setValue(safeTag.getValue());
+    if ( ok ) parseSpectrum(safeTag.getValue().toString(), &m_residualData);
 
     safeTag = tag.getTag("data").getTag("residuals-color", &ok);
     if ( ok ) m_colorResidualsNode->setValue(safeTag.getValue());
@@ -569,147 +621,94 @@ PALSDataSet::PALSDataSet(PALSDataStructure *parent, const DSimpleXMLTag &tag)
     if ( ok ) m_colorDataNode->setValue(safeTag.getValue());
     else m_colorDataNode->setValue(QColor(Qt::blue).colorNames().at(0));
 
+    *m_parentNode << m_xyRawDataNode << m_xyDataNode << m_xyDataBinFac << m_fitDataNode << m_residualNode << m_colorDataNode << m_colorResidualsNode;
+    (*parent->getParent()) << m_parentNode;
+}
 
-    const QStringList xyDataStringList = DString(m_xyDataNode->getValue().toString()).parseBetween2("{", "}");
-    const QStringList xyRawDataStringList = DString(m_xyRawDataNode->getValue().toString()).parseBetween2("{", "}");
-    const QStringList xyFitDataStringList = DString(m_fitDataNode->getValue().toString()).parseBetween2("{", "}");
-    const QStringList residualDataStringList = DString(m_residualNode->getValue().toString()).parseBetween2("{", "}");
-
-    m_xyData.clear();
-    m_xyRawData.clear();
-    m_fitData.clear();
-    m_residualData.clear();
-
-    for ( int i = 0 ; i < xyDataStringList.size() ; ++ i )
-    {
-        const QStringList list = xyDataStringList.at(i).split("|");
-
-        if ( list.size() == 2 )
-        {
-            const double x = list.at(0).toDouble();
-            const double y = list.at(1).toDouble();
-
-            m_xyData.append(QPointF(x, y));
-        }
-    }
-
-    for ( int i = 0 ; i < xyRawDataStringList.size() ; ++ i )
-    {
-        const QStringList list = xyRawDataStringList.at(i).split("|");
-
-        if ( list.size() == 2 )
-        {
-            const double x = list.at(0).toDouble();
-            const double y = list.at(1).toDouble();
-
-            m_xyRawData.append(QPointF(x, y));
-        }
-    }
+PALSDataSet::~PALSDataSet()
+{
+    DDELETE_SAFETY(m_xyDataNode);
+    DDELETE_SAFETY(m_xyRawDataNode);
+    DDELETE_SAFETY(m_xyDataBinFac);
+    DDELETE_SAFETY(m_fitDataNode);
+    DDELETE_SAFETY(m_residualNode);
+    DDELETE_SAFETY(m_colorResidualsNode);
+    DDELETE_SAFETY(m_colorDataNode);
+    DDELETE_SAFETY(m_parentNode);
+}
 
-    for ( int i = 0 ; i < xyFitDataStringList.size() ; ++ i )
-    {
-        const QStringList list = xyFitDataStringList.at(i).split("|");
+DSimpleXMLNode *PALSDataSet::getParent() const
+{
+    return m_parentNode;
+}
 
-        if ( list.size() == 2 )
-        {
-            const double x = list.at(0).toDouble();
-            const double y = list.at(1).toDouble();
+void PALSDataSet::parseSpectrum(const QString &value, PALSSpectrum *spectrum)
+{
+    const QStringList stringList = DString(value).parseBetween2("{", "}");
 
-            m_fitData.append(QPointF(x, y));
-        }
-    }
+    spectrum->clear();
+    spectrum->reserve(stringList.size());
 
-    for ( int i = 0 ; i < residualDataStringList.size() ; ++ i )
+    for ( int i = 0 ; i < stringList.size() ; ++ i )
     {
-        const QStringList list = residualDataStringList.at(i).split("|");
+        const QStringList list = stringList.at(i).split("|");
 
         if ( list.size() == 2 )
         {
             const double x = list.at(0).toDouble();
             const double y = list.at(1).toDouble();
 
-            m_residualData.append(QPointF(x, y));
+            spectrum->append(x, y);
         }
     }
-
-    *m_parentNode << m_xyRawDataNode << m_xyDataNode << m_xyDataBinFac << m_fitDataNode << m_residualNode << m_colorDataNode << m_colorResidualsNode;
-    (*parent->getParent()) << m_parentNode;
 }
 
-PALSDataSet::~PALSDataSet()
+void PALSDataSet::attachSpectraToNodes()
 {
-    DDELETE_SAFETY(m_xyDataNode);
-    DDELETE_SAFETY(m_xyRawDataNode);
-    DDELETE_SAFETY(m_xyDataBinFac);
-    DDELETE_SAFETY(m_fitDataNode);
-    DDELETE_SAFETY(m_residualNode);
-    DDELETE_SAFETY(m_colorResidualsNode);
-    DDELETE_SAFETY(m_colorDataNode);
-    DDELETE_SAFETY(m_parentNode);
+    m_xyDataNode->setPoints(m_xyData.channelVector(), m_xyData.countsVector());
+    m_xyRawDataNode->setPoints(m_xyRawData.channelVector(), m_xyRawData.countsVector());
+    m_fitDataNode->setPoints(m_fitData.channelVector(), m_fitData.countsVector());
+    m_residualNode->setPoints(m_residualData.channelVector(), m_residualData.countsVector());
 }
 
-DSimpleXMLNode *PALSDataSet::getParent() const
+void PALSDataSet::releaseSpectraFromNodes()
 {
-    return m_parentNode;
+    /* the nodes must not keep a reference: a later write access (e.g. the fit) would detach and copy the arrays */
+    m_xyDataNode->setValue("");
+    m_xyRawDataNode->setValue("");
+    m_fitDataNode->setValue("");
+    m_residualNode->setValue("");
 }
 
 void PALSDataSet::clearFitData()
 {
     m_xyData.clear();
-    m_xyDataNode->setValue("");
-
     m_xyRawData.clear();
-    m_xyRawDataNode->setValue("");
 }
 
 void PALSDataSet::clearResidualData()
 {
     m_residualData.clear();
-    m_residualNode->setValue("");
 }
 
-void PALSDataSet::setLifeTimeData(const QList<QPointF> &dataSet)
+void PALSDataSet::setLifeTimeData(const PALSSpectrum &dataSet)
 {
     m_xyData = dataSet;
-
-    DString dataString;
-    for ( int i = 0 ; i < m_xyData.size() ; ++ i )
-        dataString += "{" + QVariant(m_xyData[i].x()).toString() + "|" + QVariant(m_xyData[i].y()).toString() + "}";
-
-    m_xyDataNode->setValue(dataString);
 }
 
-void PALSDataSet::setLifeTimeRawData(const QList<QPointF> &rawDataSet)
+void PALSDataSet::setLifeTimeRawData(const PALSSpectrum &rawDataSet)
 {
     m_xyRawData = rawDataSet;
-
-    DString dataString;
-    for ( int i = 0 ; i < m_xyRawData.size() ; ++ i )
-        dataString += "{" + QVariant(m_xyRawData[i].x()).toString() + "|" + QVariant(m_xyRawData[i].y()).toString() + "}";
-
-    m_xyRawDataNode->setValue(dataString);
 }
 
-void PALSDataSet::setFitData(const QList<QPointF> &dataSet)
+void PALSDataSet::setFitData(const PALSSpectrum &dataSet)
 {
     m_fitData = dataSet;
-
-    DString dataString;
-    for ( int i = 0 ; i < m_fitData.size() ; ++ i )
-        dataString += "{" + QVariant(m_fitData[i].x()).toString() + "|" + QVariant(m_fitData[i].y()).toString() + "}";
-
-    m_fitDataNode->setValue(dataString);
 }
 
-void PALSDataSet::setResiduals(const QList<QPointF> &residuals)
+void PALSDataSet::setResiduals(const PALSSpectrum &residuals)
 {
     m_residualData = residuals;
-
-    DString dataString;
-    for ( int i = 0 ; i < m_residualData.size() ; ++ i )
-        dataString += "{" + QVariant(m_residualData[i].x()).toString() + "|" + QVariant(m_residualData[i].y()).toString() + "}";
-
-    m_residualNode->setValue(dataString);
 }
 
 void PALSDataSet::setLifeTimeDataColor(const DColor &color)
@@ -727,22 +726,22 @@ void PALSDataSet::setBinFactor(unsigned int binFac)
     m_xyDataBinFac->setValue(binFac);
 }
 
-QList<QPointF> PALSDataSet::getLifeTimeData() const
+PALSSpectrum PALSDataSet::getLifeTimeData() const
 {
     return m_xyData;
 }
 
-QList<QPointF> PALSDataSet::getLifeTimeRawData() const
+PALSSpectrum PALSDataSet::getLifeTimeRawData() const
 {
     return m_xyRawData;
 }
 
-QList<QPointF> PALSDataSet::getFitData() const
+PALSSpectrum PALSDataSet::getFitData() const
 {
     return m_fitData;
 }
 
-QList<QPointF> PALSDataSet::getResiduals() const
+PALSSpectrum PALSDataSet::getResiduals() const
 {
     return m_residualData;
 }
@@ -1023,6 +1022,21 @@ PALSResultHistorie *PALSFitSet::getResultHistoriePtr() const
     return m_resultHistorie;
 }
 
+void PALSFitSet::updateParameterNodes()
+{
+    for ( unsigned int i = 0 ; i < m_sourceParams->getSize() ; ++ i )
+        m_sourceParams->getParameterAt(i)->updateNodes();
+
+    for ( unsigned int i = 0 ; i < m_deviceResolutionParams->getSize() ; ++ i )
+        m_deviceResolutionParams->getParameterAt(i)->updateNodes();
+
+    for ( unsigned int i = 0 ; i < m_lifeTimeParams->getSize() ; ++ i )
+        m_lifeTimeParams->getParameterAt(i)->updateNodes();
+
+    if ( m_bgParam->getParameter() )
+        m_bgParam->getParameter()->updateNodes();
+}
+
 int PALSFitSet::getComponentsCount() const
 {
     return getLifeTimeParamPtr()->getSize() + getSourceParamPtr()->getSize();
@@ -1607,114 +1621,129 @@ DSimpleXMLNode *PALSFitParameter::getParent() const
     return m_parentNode;
 }
 
+void PALSFitParameter::updateNodes()
+{
+    m_active->setValue(m_values.active);
+    m_name->setValue((QString)m_values.name);
+    m_alias->setValue(m_values.alias);
+    m_startValue->setValue(m_values.startValue);
+    m_upperBounding->setValue(m_values.upperBoundingValue);
+    m_bupperBounding->setValue(m_values.upperBoundingEnabled);
+    m_lowerBounding->setValue(m_values.lowerBoundingValue);
+    m_blowerBounding->setValue(m_values.lowerBoundingEnabled);
+    m_fixed->setValue(m_values.fixed);
+    m_fitValue->setValue(m_values.fitValue);
+    m_fitValueError->setValue(m_values.fitValueError);
+}
+
 void PALSFitParameter::setActive(bool active)
 {
-    m_active->setValue(active);
+    m_values.active = active;
 }
 
 void PALSFitParameter::setName(const DString &name)
 {
-    m_name->setValue((QString)name);
+    m_values.name = name;
 }
 
 void PALSFitParameter::setAlias(const DString &name)
 {
-    m_alias->setValue(name);
+    m_values.alias = name;
 }
 
 void PALSFitParameter::setStartValue(double value)
 {
-    m_startValue->setValue(value);
+    m_values.startValue = value;
 }
 
 void PALSFitParameter::setUpperBoundingValue(double value)
 {
-    m_upperBounding->setValue(value);
+    m_values.upperBoundingValue = value;
 }
 
 void PALSFitParameter::setUpperBoundingEnabled(bool enabled)
 {
-    m_bupperBounding->setValue(enabled);
+    m_values.upperBoundingEnabled = enabled;
 }
 
 void PALSFitParameter::setLowerBoundingValue(double value)
 {
-    m_lowerBounding->setValue(value);
+    m_values.lowerBoundingValue = value;
 }
 
 void PALSFitParameter::setLowerBoundingEnabled(bool enabled)
 {
-    m_blowerBounding->setValue(enabled);
+    m_values.lowerBoundingEnabled = enabled;
 }
 
 void PALSFitParameter::setAsFixed(bool fixed)
 {
-    m_fixed->setValue(fixed);
+    m_values.fixed = fixed;
 }
 
 void PALSFitParameter::setFitValue(double value)
 {
-    m_fitValue->setValue(value);
+    m_values.fitValue = value;
 }
 
 void PALSFitParameter::setFitValueError(double error)
 {
-    m_fitValueError->setValue(error);
+    m_values.fitValueError = error;
 }
 
 bool PALSFitParameter::isActive() const
 {
-    return m_active->getValue().toBool();
+    return m_values.active;
 }
 
 DString PALSFitParameter::getName() const
 {
-    return (DString)m_name->getValue().toString();
+    return m_values.name;
 }
 
 DString PALSFitParameter::getAlias() const
 {
-    return (DString)m_alias->getValue().toString();
+    return m_values.alias;
 }
 
 double PALSFitParameter::getStartValue() const
 {
-    return m_startValue->getValue().toDouble();
+    return m_values.startValue;
 }
 
 bool PALSFitParameter::isUpperBoundingEnabled() const
 {
-    return m_bupperBounding->getValue().toBool();
+    return m_values.upperBoundingEnabled;
 }
 
 double PALSFitParameter::getUpperBoundingValue() const
 {
-    return m_upperBounding->getValue().toDouble();
+    return m_values.upperBoundingValue;
 }
 
 double PALSFitParameter::getLowerBoundingValue() const
 {
-    return m_lowerBounding->getValue().toDouble();
+    return m_values.lowerBoundingValue;
 }
 
 bool PALSFitParameter::isLowerBoundingEnabled() const
 {
-    return m_blowerBounding->getValue().toBool();
+    return m_values.lowerBoundingEnabled;
 }
 
 bool PALSFitParameter::isFixed() const
 {
-    return m_fixed->getValue().toBool();
+    return m_values.fixed;
 }
 
 double PALSFitParameter::getFitValue() const
 {
-    return m_fitValue->getValue().toDouble();
+    return m_values.fitValue;
 }
 
 double PALSFitParameter::getFitValueError() const
 {
-    return m_fitValueError->getValue().toDouble();
+    return m_values.fitValueError;
 }
 
 
@@ -34,6 +34,8 @@
 
 #include "../DLib/DLib.h"
 
+#include "spectrum.h"
+
 #define SETTINGS_READ              /*Reading and Loading*/
 #define SETTINGS_WRITE             /*Writing and Saving */
 #define LOAD_CONSTRUCTOR      /*Load Constructor*/
@@ -71,7 +73,9 @@ public:
 
     virtual ~PALSProject();
 
-    bool save(const DString& projectPath);
+    /* format by the extension: binary (PALS_BINARY_PROJECT_EXTENSION) or XML */
+    bool save(const DString& projectPath, bool updateLastSaveTime = true);
+    /* format by the content: binary or XML */
     bool load(const DString& projectPath);
 
     unsigned int getSize() const;
@@ -95,6 +99,7 @@ SETTINGS_READ
 
 private:
     void clear();
+    void loadContent(const DSimpleXMLTag& projectContent);
 };
 
 
@@ -137,10 +142,13 @@ class PALSDataSet
 
     DSimpleXMLNode *m_xyDataBinFac;
 
-    QList<QPointF> m_xyData; // << binned data
-    QList<QPointF> m_xyRawData; // << non-binned data
-    QList<QPointF> m_fitData;
-    QList<QPointF> m_residualData;
+    /* the spectra are the only copy of the data: the data nodes (lt-data, ...) are empty and refer to them at save time only */
+    PALSSpectrum m_xyData; // << binned data
+    PALSSpectrum m_xyRawData; // << non-binned data
+    PALSSpectrum m_fitData;
+    PALSSpectrum m_residualData;
+
+    static void parseSpectrum(const QString& value, PALSSpectrum *spectrum);
 
 public:
     SAVE_CONSTRUCTOR PALSDataSet(PALSDataStructure *parent);
@@ -153,20 +161,25 @@ public:
     void clearFitData();
     void clearResidualData();
 
+    /* save: attach the spectra to the data nodes (implicitly shared) before the XML tree is written and release them afterwards */
+    void attachSpectraToNodes();
+    void releaseSpectraFromNodes();
+
 SETTINGS_WRITE
-    void setLifeTimeData(const QList<QPointF>& dataSet); // << binned data
-    void setLifeTimeRawData(const QList<QPointF>& rawDataSet); // << non-binned data
-    void setFitData(const QList<QPointF>& dataSet);
-    void setResiduals(const QList<QPointF>& residuals);
+    void setLifeTimeData(const PALSSpectrum& dataSet); // << binned data
+    void setLifeTimeRawData(const PALSSpectrum& rawDataSet); // << non-binned data
+    void setFitData(const PALSSpectrum& dataSet);
+    void setResiduals(const PALSSpectrum& residuals);
     void setLifeTimeDataColor(const DColor& color);
     void setResidualsColor(const DColor& color);
     void setBinFactor(unsigned int binFac);
 
 SETTINGS_READ
-    QList<QPointF> getLifeTimeData() const; // << binned data
-    QList<QPointF> getLifeTimeRawData() const; // << non-binned data
-    QList<QPointF> getFitData() const;
-    QList<QPointF> getResiduals() const;
+    /* implicitly shared (no copy of the arrays) */
+    PALSSpectrum getLifeTimeData() const; // << binned data
+    PALSSpectrum getLifeTimeRawData() const; // << non-binned data
+    PALSSpectrum getFitData() const;
+    PALSSpectrum getResiduals() const;
 
     DColor getLifeTimeDataColor() const;
     DColor getResidualsColor() const;
@@ -234,6 +247,9 @@ public:
 
     int getComponentsCount() const; //without background and device
 
+    /* save: writes the typed values of all fit parameters to their XML nodes */
+    void updateParameterNodes();
+
 SETTINGS_WRITE
     void setMaximumIterations(unsigned int iterations);
     void setNeededIterations(unsigned int iterations);
@@ -425,8 +441,28 @@ SETTINGS_READ
     QString getResultText() const;
 };
 
+/* typed values of a fit parameter: written to the XML nodes on save only */
+typedef struct {
+    DString name;
+    DString alias;
+
+    double startValue;
+    double upperBoundingValue;
+    double lowerBoundingValue;
+
+    double fitValue;
+    double fitValueError;
+
+    bool active;
+    bool upperBoundingEnabled;
+    bool lowerBoundingEnabled;
+    bool fixed;
+} PALSFitParameterValues;
+
 class PALSFitParameter
 {
+    PALSFitParameterValues m_values;
+
     DSimpleXMLNode *m_parentNode;
 
     DSimpleXMLNode *m_active;
@@ -457,6 +493,9 @@ public:
 
     DSimpleXMLNode* getParent() const;
 
+    /* save: writes the typed values to the XML nodes */
+    void updateNodes();
+
 SETTINGS_WRITE
     void setActive(bool active);
     void setName(const DString& name);
@@ -0,0 +1,180 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+#include "spectrum.h"
+
+#include <algorithm>
+
+PALSSpectrum::PALSSpectrum() :
+    d(new PALSSpectrumData) {}
+
+PALSSpectrum::PALSSpectrum(int size) :
+    d(new PALSSpectrumData)
+{
+    resize(size);
+}
+
+PALSSpectrum::PALSSpectrum(const QVector<double> &channels, const QVector<double> &counts) :
+    d(new PALSSpectrumData)
+{
+    Q_ASSERT(channels.size() == counts.size());
+
+    d->channels = channels;
+    d->counts = counts;
+}
+
+PALSSpectrum PALSSpectrum::fromPoints(const QList<QPointF> &points)
+{
+    PALSSpectrum spectrum(points.size());
+
+    double *channels = spectrum.channelData();
+    double *counts = spectrum.countsData();
+
+    for ( int i = 0 ; i < points.size() ; ++ i )
+    {
+        channels[i] = points.at(i).x();
+        counts[i] = points.at(i).y();
+    }
+
+    return spectrum;
+}
+
+QList<QPointF> PALSSpectrum::toPoints() const
+{
+    QList<QPointF> points;
+    points.reserve(size());
+
+    for ( int i = 0 ; i < size() ; ++ i )
+        points.append(QPointF(d->channels.at(i), d->counts.at(i)));
+
+    return points;
+}
+
+int PALSSpectrum::size() const
+{
+    return d->channels.size();
+}
+
+bool PALSSpectrum::isEmpty() const
+{
+    return d->channels.isEmpty();
+}
+
+void PALSSpectrum::clear()
+{
+    d->channels.clear();
+    d->counts.clear();
+}
+
+void PALSSpectrum::reserve(int size)
+{
+    d->channels.reserve(size);
+    d->counts.reserve(size);
+}
+
+void PALSSpectrum::resize(int size)
+{
+    d->channels.resize(size);
+    d->counts.resize(size);
+}
+
+void PALSSpectrum::append(double channel, double counts)
+{
+    d->channels.append(channel);
+    d->counts.append(counts);
+}
+
+double PALSSpectrum::channelAt(int index) const
+{
+    return d->channels.at(index);
+}
+
+double PALSSpectrum::countsAt(int index) const
+{
+    return d->counts.at(index);
+}
+
+QPointF PALSSpectrum::at(int index) const
+{
+    return QPointF(d->channels.at(index), d->counts.at(index));
+}
+
+QPointF PALSSpectrum::first() const
+{
+    return at(0);
+}
+
+QPointF PALSSpectrum::last() const
+{
+    return at(size() - 1);
+}
+
+const double *PALSSpectrum::channels() const
+{
+    return d->channels.constData();
+}
+
+const double *PALSSpectrum::counts() const
+{
+    return d->counts.constData();
+}
+
+double *PALSSpectrum::channelData()
+{
+    return d->channels.data();
+}
+
+double *PALSSpectrum::countsData()
+{
+    return d->counts.data();
+}
+
+QVector<double> PALSSpectrum::channelVector() const
+{
+    return d->channels;
+}
+
+QVector<double> PALSSpectrum::countsVector() const
+{
+    return d->counts;
+}
+
+int PALSSpectrum::lowerBound(double channel) const
+{
+    return (int)(std::lower_bound(d->channels.constBegin(), d->channels.constEnd(), channel) - d->channels.constBegin());
+}
+
+double PALSSpectrum::integral() const
+{
+    double sum = 0.0;
+
+    for ( int i = 0 ; i < size() ; ++ i )
+        sum += d->counts.at(i);
+
+    return sum;
+}
@@ -0,0 +1,107 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+#ifndef PALSSPECTRUM_H
+#define PALSSPECTRUM_H
+
+#include <QSharedData>
+#include <QSharedDataPointer>
+#include <QVector>
+#include <QList>
+#include <QPointF>
+#include <QMetaType>
+
+/*
+ * PALSSpectrum - lifetime spectrum as structure of arrays:
+ *--------------------------------------------------------
+ *
+ * Channels and counts are stored in contiguous arrays which are implicitly shared (copy-on-write)
+ * between the data set of the project, the fit engines, the plots and the exporters: copies are cheap, the arrays are only
+ * copied on the first write access (channelData(), countsData(), ...) of a shared spectrum.
+ *
+ * The channels are expected in ascending order. The fits weight the counts by Poisson noise (1/sqrt(counts + 1)).
+ */
+
+class PALSSpectrumData : public QSharedData
+{
+public:
+    QVector<double> channels;
+    QVector<double> counts;
+};
+
+class PALSSpectrum
+{
+public:
+    PALSSpectrum();
+    explicit PALSSpectrum(int size); /* zero channels and counts */
+    PALSSpectrum(const QVector<double>& channels, const QVector<double>& counts);
+
+    static PALSSpectrum fromPoints(const QList<QPointF>& points);
+    QList<QPointF> toPoints() const;
+
+    int size() const;
+    bool isEmpty() const;
+
+    void clear();
+    void reserve(int size);
+    void resize(int size);
+
+    void append(double channel, double counts);
+
+    double channelAt(int index) const;
+    double countsAt(int index) const;
+
+    QPointF at(int index) const;
+    QPointF first() const;
+    QPointF last() const;
+
+    /* read access: no detach */
+    const double *channels() const;
+    const double *counts() const;
+
+    /* write access: detaches a shared spectrum */
+    double *channelData();
+    double *countsData();
+
+    /* the arrays (implicitly shared) */
+    QVector<double> channelVector() const;
+    QVector<double> countsVector() const;
+
+    /* index of the first channel >= channel (size(): none) */
+    int lowerBound(double channel) const;
+
+    double integral() const;
+
+private:
+    QSharedDataPointer<PALSSpectrumData> d;
+};
+
+Q_DECLARE_TYPEINFO(PALSSpectrum, Q_MOVABLE_TYPE);
+Q_DECLARE_METATYPE(PALSSpectrum)
+
+#endif // PALSSPECTRUM_H
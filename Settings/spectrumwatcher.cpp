@@ -0,0 +1,374 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+
+#include "spectrumwatcher.h"
+
+#ifdef __SPECTRUM_WATCH_DEBUG
+#include <QDebug>
+#endif
+
+PALSSpectrumWatcher::PALSSpectrumWatcher(QObject *parent) :
+    QObject(parent),
+    m_directory(false),
+    m_binFac(1)
+{
+    reset();
+
+    m_updateTimer.setSingleShot(true);
+    m_updateTimer.setInterval(PALS_WATCH_UPDATE_DELAY);
+
+    m_pollTimer.setInterval(PALS_WATCH_POLL_INTERVAL);
+
+    connect(&m_watcher, SIGNAL(fileChanged(QString)), this, SLOT(scheduleUpdate()));
+    connect(&m_watcher, SIGNAL(directoryChanged(QString)), this, SLOT(scheduleUpdate()));
+    connect(&m_updateTimer, SIGNAL(timeout()), this, SLOT(update()));
+    connect(&m_pollTimer, SIGNAL(timeout()), this, SLOT(update()));
+}
+
+PALSSpectrumWatcher::~PALSSpectrumWatcher()
+{
+    stop();
+}
+
+bool PALSSpectrumWatcher::watch(const QString &path, int binFac)
+{
+    stop();
+
+    const QFileInfo info(path);
+
+    if ( !info.exists() )
+        return false;
+
+    m_path = info.absoluteFilePath();
+    m_directory = info.isDir();
+    m_binFac = qMax(1, binFac);
+
+    if ( m_directory ) {
+        m_watcher.addPath(m_path);
+        m_fileName = latestFile(m_path); /* empty until the first file is written */
+    }
+    else
+        m_fileName = m_path;
+
+    if ( !m_fileName.isEmpty() )
+        m_watcher.addPath(m_fileName);
+
+    m_pollTimer.start();
+
+    update();
+
+    return true;
+}
+
+bool PALSSpectrumWatcher::isWatching() const
+{
+    return !m_path.isEmpty();
+}
+
+QString PALSSpectrumWatcher::path() const
+{
+    return m_path;
+}
+
+QString PALSSpectrumWatcher::fileName() const
+{
+    return m_fileName;
+}
+
+int PALSSpectrumWatcher::binFactor() const
+{
+    return m_binFac;
+}
+
+PALSASCIIData PALSSpectrumWatcher::data() const
+{
+    return m_data;
+}
+
+qint64 PALSSpectrumWatcher::readBytes() const
+{
+    return m_readBytes;
+}
+
+void PALSSpectrumWatcher::stop()
+{
+    m_updateTimer.stop();
+    m_pollTimer.stop();
+
+    if ( !m_watcher.files().isEmpty() )
+        m_watcher.removePaths(m_watcher.files());
+
+    if ( !m_watcher.directories().isEmpty() )
+        m_watcher.removePaths(m_watcher.directories());
+
+    m_path.clear();
+    m_fileName.clear();
+    m_directory = false;
+
+    reset();
+}
+
+void PALSSpectrumWatcher::scheduleUpdate()
+{
+    /* the acquisition writes in several steps: a single read after the delay */
+    if ( !m_updateTimer.isActive() )
+        m_updateTimer.start();
+}
+
+void PALSSpectrumWatcher::update()
+{
+    if ( m_path.isEmpty() )
+        return;
+
+    /* directory: the latest file is the spectrum of the running acquisition */
+    if ( m_directory ) {
+        const QString latest = latestFile(m_path);
+
+        if ( !latest.isEmpty() && latest != m_fileName ) {
+            if ( !m_fileName.isEmpty() )
+                m_watcher.removePath(m_fileName);
+
+            m_fileName = latest;
+            m_watcher.addPath(m_fileName);
+
+            reset();
+
+            emit fileChanged(m_fileName);
+        }
+    }
+
+    if ( m_fileName.isEmpty() )
+        return;
+
+    const QFileInfo info(m_fileName);
+
+    /* replaced by the acquisition (removed and written again): the path has to be added again */
+    if ( !info.exists() )
+        return;
+
+    if ( !m_watcher.files().contains(m_fileName) )
+        m_watcher.addPath(m_fileName);
+
+    if ( info.size() == m_size && info.lastModified() == m_lastModified )
+        return;
+
+    QFile file(m_fileName);
+
+    /* locked by the acquisition: retried on the next change or poll */
+    if ( !file.open(QIODevice::ReadOnly) )
+        return;
+
+    int firstChangedRow = -1;
+
+    if ( !readAppendedRows(&file, &firstChangedRow) ) {
+        firstChangedRow = -1;
+
+        if ( !readFile(&file, &firstChangedRow) )
+            return;
+    }
+
+    file.close();
+
+    m_size = info.size();
+    m_lastModified = info.lastModified();
+
+#ifdef __SPECTRUM_WATCH_DEBUG
+    qDebug() << "watch:" << m_fileName << "read:" << m_readBytes << "bytes, first changed row:" << firstChangedRow;
+#endif
+
+    if ( firstChangedRow < 0 )
+        return;
+
+    int firstChangedChannel = 0;
+    const asciiImportStatus status = rebin(firstChangedRow, &firstChangedChannel);
+
+    /* acquisition just started */
+    if ( status == asciiImportStatus::tooFewData_ImportStatus )
+        return;
+
+    if ( status != asciiImportStatus::ok_ImportStatus ) {
+        emit importFailed(status);
+        return;
+    }
+
+    /* only the incomplete last bin has changed */
+    if ( firstChangedChannel >= m_data.dataSet.size() )
+        return;
+
+    emit spectrumChanged(firstChangedChannel);
+}
+
+void PALSSpectrumWatcher::reset()
+{
+    m_delimiter = ' ';
+    m_offset = 0;
+    m_tail.clear();
+    m_size = -1;
+    m_lastModified = QDateTime();
+    m_readBytes = 0;
+
+    m_rows.clear();
+
+    m_data.dataSet.clear();
+    m_data.minChannel = INT_MAX;
+    m_data.maxChannel = -INT_MAX;
+    m_data.minCounts = INT_MAX;
+    m_data.maxCounts = -INT_MAX;
+}
+
+bool PALSSpectrumWatcher::readAppendedRows(QFile *file, int *firstChangedRow)
+{
+    /* the delimiter is detected again on the first rows */
+    if ( m_offset <= 0 || m_rows.size() < PALS_ASCII_IMPORT_SAMPLE_ROWS )
+        return false;
+
+    /* same size but modified or truncated: rewritten */
+    if ( file->size() == m_size || file->size() < m_offset )
+        return false;
+
+    /* unchanged bytes in front of the offset: the rows were appended */
+    if ( !file->seek(m_offset - m_tail.size())
+         || file->read(m_tail.size()) != m_tail )
+        return false;
+
+    const QByteArray appended = file->read(file->size() - m_offset);
+
+    m_readBytes = m_tail.size() + appended.size();
+
+    /* complete rows only: a partial last row is read on the next update */
+    const int rowEnd = appended.lastIndexOf('\n');
+
+    if ( rowEnd < 0 )
+        return true;
+
+    std::vector<int> rows;
+    PALSASCIIDataImport::parseRows(appended.constData(), appended.constData() + rowEnd + 1, m_delimiter, &rows);
+
+    if ( !rows.empty() ) {
+        *firstChangedRow = (int)m_rows.size();
+
+        m_rows.insert(m_rows.end(), rows.begin(), rows.end());
+    }
+
+    m_offset += rowEnd + 1;
+    m_tail = (m_tail + appended.left(rowEnd + 1)).right(PALS_WATCH_TAIL_SIZE);
+
+    return true;
+}
+
+bool PALSSpectrumWatcher::readFile(QFile *file, int *firstChangedRow)
+{
+    if ( !file->seek(0) )
+        return false;
+
+    const QByteArray content = file->readAll();
+
+    m_readBytes = content.size();
+
+    /* complete rows only */
+    const int length = content.lastIndexOf('\n') + 1;
+
+    const char *begin = content.constData();
+    const char *end = begin + length;
+
+    m_delimiter = PALSASCIIDataImport::detectDelimiter(begin, end);
+
+    std::vector<int> rows;
+    PALSASCIIDataImport::parseRows(begin, end, m_delimiter, &rows);
+
+    /* first row with other counts than on the last update */
+    const size_t commonRows = qMin(rows.size(), m_rows.size());
+
+    size_t row = 0;
+    while ( row < commonRows && rows[row] == m_rows[row] )
+        row ++;
+
+    if ( row < commonRows || rows.size() != m_rows.size() )
+        *firstChangedRow = (int)row;
+
+    m_rows.swap(rows);
+
+    m_offset = length;
+    m_tail = content.mid(qMax(0, length - PALS_WATCH_TAIL_SIZE), qMin(length, PALS_WATCH_TAIL_SIZE));
+
+    return true;
+}
+
+asciiImportStatus PALSSpectrumWatcher::rebin(int firstChangedRow, int *firstChangedChannel)
+{
+    const int binCnt = (int)(m_rows.size()/m_binFac);
+
+    /* the bins in front of the changed row are kept */
+    const int firstBin = qMin(firstChangedRow/m_binFac, m_data.dataSet.size());
+
+    m_data.dataSet.resize(firstBin);
+    m_data.dataSet.reserve(binCnt);
+
+    for ( int bin = firstBin ; bin < binCnt ; ++ bin ) {
+        int counts = 0;
+
+        for ( int i = bin*m_binFac ; i < (bin + 1)*m_binFac ; ++ i )
+            counts += m_rows[i];
+
+        if ( counts < 0 )
+            return asciiImportStatus::negativeCounts_ImportStatus;
+
+        m_data.dataSet.append(bin, counts);
+    }
+
+    *firstChangedChannel = firstBin;
+
+    m_data.minChannel = 0;
+    m_data.maxChannel = binCnt - 1;
+    m_data.minCounts = INT_MAX;
+    m_data.maxCounts = -INT_MAX;
+
+    const double *counts = m_data.dataSet.counts();
+
+    for ( int bin = 0 ; bin < m_data.dataSet.size() ; ++ bin ) {
+        m_data.minCounts = qMin((int)counts[bin], m_data.minCounts);
+        m_data.maxCounts = qMax((int)counts[bin], m_data.maxCounts);
+    }
+
+    if ( m_data.dataSet.size() <= 2 )
+        return asciiImportStatus::tooFewData_ImportStatus;
+
+    return asciiImportStatus::ok_ImportStatus;
+}
+
+QString PALSSpectrumWatcher::latestFile(const QString &dirPath)
+{
+    const QFileInfoList files = QDir(dirPath).entryInfoList(QStringList() << "*.dat" << "*.txt" << "*.log",
+                                                             QDir::Files, QDir::Time);
+
+    if ( files.isEmpty() )
+        return QString();
+
+    return files.first().absoluteFilePath();
+}
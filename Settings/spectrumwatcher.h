@@ -0,0 +1,135 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+
+#ifndef PALSSPECTRUMWATCHER_H
+#define PALSSPECTRUMWATCHER_H
+
+#include <QObject>
+#include <QFileSystemWatcher>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QTimer>
+#include <QDir>
+
+#include <vector>
+
+#include "asciidataimport.h"
+
+//#define __SPECTRUM_WATCH_DEBUG
+
+#define PALS_WATCH_UPDATE_DELAY 250 /* [ms] changes of the file within this delay are read at once */
+#define PALS_WATCH_POLL_INTERVAL 2000 /* [ms] fallback if the file system doesn´t notify (e.g. network shares) */
+#define PALS_WATCH_TAIL_SIZE 64 /* [bytes] in front of the read offset: unchanged = rows were only appended */
+
+/*
+ * PALSSpectrumWatcher - ASCII spectrum of a running acquisition:
+ *---------------------------------------------------------------
+ *
+ * Watches a growing ASCII file (or the latest file of a directory) and keeps its binned spectrum up to date. The rows are
+ * parsed by PALSASCIIDataImport (delimiter detected once on the first read).
+ *
+ * The file is read from the offset behind the last complete row: if the bytes in front of this offset are unchanged only
+ * the appended rows are parsed (a partial last row is kept for the next update). Otherwise (file rewritten by the
+ * acquisition, e.g. counts updated in place) the file is parsed again and compared with the previous counts. In both cases
+ * only the bins from the first changed channel on are rebinned, spectrumChanged(...) reports this channel.
+ */
+
+class PALSSpectrumWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PALSSpectrumWatcher(QObject *parent = nullptr);
+    virtual ~PALSSpectrumWatcher();
+
+    /* path: ASCII file or directory (the latest modified file is watched) */
+    bool watch(const QString& path, int binFac);
+
+    bool isWatching() const;
+
+    QString path() const;
+    QString fileName() const; /* file of the current spectrum */
+
+    int binFactor() const;
+
+    /* binned spectrum of the last update */
+    PALSASCIIData data() const;
+
+    /* bytes parsed by the last update (appended rows only or the whole file) */
+    qint64 readBytes() const;
+
+public slots:
+    void stop();
+
+    /* reads the changes immediately */
+    void update();
+
+signals:
+    /* channels (index of the binned spectrum) from firstChangedChannel on have changed */
+    void spectrumChanged(int firstChangedChannel);
+
+    /* directory: a new file is watched */
+    void fileChanged(const QString& fileName);
+
+    void importFailed(int status);
+
+private slots:
+    void scheduleUpdate();
+
+private:
+    void reset();
+
+    bool readAppendedRows(QFile *file, int *firstChangedRow);
+    bool readFile(QFile *file, int *firstChangedRow);
+
+    asciiImportStatus rebin(int firstChangedRow, int *firstChangedChannel);
+
+    static QString latestFile(const QString& dirPath);
+
+private:
+    QFileSystemWatcher m_watcher;
+    QTimer m_updateTimer;
+    QTimer m_pollTimer;
+
+    QString m_path;
+    QString m_fileName;
+    bool m_directory;
+    int m_binFac;
+
+    char m_delimiter;
+    qint64 m_offset; /* behind the last complete row */
+    QByteArray m_tail; /* PALS_WATCH_TAIL_SIZE bytes in front of m_offset */
+    qint64 m_size; /* of the file on the last update */
+    QDateTime m_lastModified;
+    qint64 m_readBytes;
+
+    std::vector<int> m_rows; /* counts of each row (unbinned) */
+    PALSASCIIData m_data;
+};
+
+#endif // PALSSPECTRUMWATCHER_H
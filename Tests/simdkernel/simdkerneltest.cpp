@@ -0,0 +1,156 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+
+/*
+ * simdkerneltest - checks the documented error bounds of the SIMD kernel (see Fit/simdkernel.h):
+ *-----------------------------------------------------------------------------------------------
+ *
+ * erfc over its full argument range and the lifetime edge terms (vectorized path of the running CPU) over the leading edge,
+ * the peak and the decay are compared against long double erfc/exp. The vectorized edge terms have to be bit-identical to
+ * the scalar path. Exit code: 0 if all bounds hold.
+ */
+
+#include "../../Fit/simdkernel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#define TEST_MIN_VALUE 1E-300 /* results below are subnormal or underflow (not covered by the relative bounds) */
+
+static bool checkErfc()
+{
+    double maxError = 0.0, maxTailError = 0.0;
+
+    for ( int i = 0 ; i <= 35000000 ; ++ i ) {
+        const double z = -8.0 + (double)i*1E-6;
+
+        if ( z > 26.5 )
+            break;
+
+        const long double reference = erfcl((long double)z);
+
+        if ( reference < TEST_MIN_VALUE )
+            continue;
+
+        const double error = (double)fabsl(((long double)simdErfc(z) - reference)/reference);
+
+        if ( std::fabs(z) < 5.0 )
+            maxError = std::max(maxError, error);
+        else
+            maxTailError = std::max(maxTailError, error);
+    }
+
+    const bool ok = (maxError < SIMD_KERNEL_ERFC_ERROR && maxTailError < SIMD_KERNEL_ERFC_TAIL_ERROR);
+
+    printf("erfc: max. relative error %.3g (|z| < 5, bound %.3g), %.3g (tail, bound %.3g): %s\n",
+           maxError, SIMD_KERNEL_ERFC_ERROR, maxTailError, SIMD_KERNEL_ERFC_TAIL_ERROR, ok ? "ok" : "FAILED");
+
+    return ok;
+}
+
+static bool checkLifetimeEdgeTerms()
+{
+    const double sigmas[] = { 0.3, 0.7, 1.0, 2.2, 3.0, 6.5, 10.0, 25.0 };
+    const double taus[] = { 0.2, 0.5, 1.3, 2.0, 10.0, 50.0, 200.0, 1000.0 };
+
+    const double xOffset = 1.1;
+    const double mu = 2.6;
+
+    const int edgeCnt = 200003; /* not a multiple of the lanes: includes the scalar remainder */
+
+    double maxError = 0.0, maxTailError = 0.0;
+    bool identical = true;
+
+    std::vector<double> x(edgeCnt), yEdge(edgeCnt);
+
+    for ( double sigma : sigmas ) {
+        for ( double tau : taus ) {
+            for ( int e = 0 ; e < edgeCnt ; ++ e )
+                x[e] = xOffset + mu - 28.0*sigma + (double)e*(56.0*sigma + 100.0*tau)/(double)edgeCnt;
+
+            simdLifetimeEdgeTerms(edgeCnt, x.data(), xOffset, mu, sigma, tau, yEdge.data());
+
+            for ( int e = 0 ; e < edgeCnt ; ++ e ) {
+                /* scalar path */
+                double yScalar = 0.0;
+                simdLifetimeEdgeTerms(1, &x[e], xOffset, mu, sigma, tau, &yScalar);
+
+                if ( std::memcmp(&yScalar, &yEdge[e], sizeof(double)) )
+                    identical = false;
+
+                const long double u = (long double)((x[e] - xOffset) - mu);
+                const long double p = ((long double)sigma*sigma/(4.0L*tau) - u)/tau;
+                const long double q = (long double)sigma/(2.0L*tau) - u/sigma;
+
+                const long double erfcQ = erfcl(q);
+
+                if ( erfcQ <= 0.0L )
+                    continue;
+
+                const long double reference = expl(p + logl(erfcQ));
+
+                if ( reference < TEST_MIN_VALUE )
+                    continue;
+
+                const double error = (double)fabsl(((long double)yEdge[e] - reference)/reference);
+
+                if ( fabsl(u/sigma) < 5.0L )
+                    maxError = std::max(maxError, error);
+                else
+                    maxTailError = std::max(maxTailError, error);
+            }
+        }
+    }
+
+    const bool ok = (identical && maxError < SIMD_KERNEL_EDGE_ERROR && maxTailError < SIMD_KERNEL_EDGE_TAIL_ERROR);
+
+    printf("edge term: max. relative error %.3g (|u/sigma| < 5, bound %.3g), %.3g (tail, bound %.3g), %s scalar path: %s\n",
+           maxError, SIMD_KERNEL_EDGE_ERROR, maxTailError, SIMD_KERNEL_EDGE_TAIL_ERROR, identical ? "identical to the" : "DIFFERS from the", ok ? "ok" : "FAILED");
+
+    return ok;
+}
+
+int main()
+{
+    if ( sizeof(long double) <= sizeof(double) ) {
+        printf("skipped: long double has no extended precision on this platform\n");
+        return 0;
+    }
+
+    const char *instructionSets[] = { "scalar", "SSE2", "AVX2" };
+    printf("instruction set: %s\n", instructionSets[simdKernelInstructionSet()]);
+
+    const bool erfcOk = checkErfc();
+    const bool edgeOk = checkLifetimeEdgeTerms();
+
+    return (erfcOk && edgeOk) ? 0 : 1;
+}
@@ -0,0 +1,15 @@
+#checks the documented error bounds of the SIMD kernel (Fit/simdkernel.h): qmake && make && ./simdkerneltest
+
+TEMPLATE = app
+TARGET = simdkerneltest
+
+CONFIG += console c++11
+CONFIG -= qt app_bundle
+
+QMAKE_CXXFLAGS += -ffp-contract=off
+
+SOURCES += simdkerneltest.cpp \
+           ../../Fit/simdkernel.cpp
+
+HEADERS += ../../Fit/simdkernel.h \
+           ../../Fit/simdkernelimpl.h
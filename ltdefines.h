@@ -30,6 +30,7 @@
 #define LTDEFINES
 
 #define PROJECT_EXTENSION   QString(".dquicklt")
+#define PROJECT_BINARY_EXTENSION   QString(".dquickltb")
 #define VERSION_STRING_AND_PROGRAM_NAME QString("DQuickLTFit v4.2")
 #define VERSION_RELEASE_DATE QString("2021-01-25")
 #define COPYRIGHT_NOTICE QString("Copyright (C) 2016-2021 by Danny Petschke. All rights reserved.")
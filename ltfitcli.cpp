@@ -0,0 +1,326 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+
+#include "ltfitcli.h"
+#include "ltfitservice.h"
+
+bool DFastLTFitCLI::isRequested(int argc, char *argv[])
+{
+    for ( int i = 1 ; i < argc ; ++ i ) {
+        if ( !qstrcmp(argv[i], "--fit")
+             || !qstrcmp(argv[i], "--convert")
+             || !qstrcmp(argv[i], "--serve") )
+            return true;
+    }
+
+    return false;
+}
+
+int DFastLTFitCLI::exec(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("DQuickLTFit");
+    app.setApplicationVersion(VERSION_STRING_AND_PROGRAM_NAME);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(VERSION_STRING_AND_PROGRAM_NAME % " - headless fitting of lifetime spectra");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    const QCommandLineOption fitOption("fit", "Project (template) to be fitted.", "project");
+    const QCommandLineOption formatOption(QStringList() << "f" << "format", "Output format: json (default) or csv.", "format", "json");
+    const QCommandLineOption outputOption(QStringList() << "o" << "output", "Output file (default: stdout).", "file");
+    const QCommandLineOption binFactorOption(QStringList() << "b" << "bin-factor", "Bin factor of the ASCII spectra (default: bin factor of the project).", "n");
+    const QCommandLineOption threadsOption(QStringList() << "j" << "threads", "Concurrent fits, threads of the fit for a single spectrum (0: one per core, default: 1).", "n", "1");
+    const QCommandLineOption convertOption("convert", "Project to be converted to --output (XML <-> binary by the extension of the output).", "project");
+    const QCommandLineOption multiStartOption(QStringList() << "m" << "multi-start", "Levenberg-Marquardt starts of each fit (default: 1).", "n", "1");
+    const QCommandLineOption numericalOption("numerical-derivatives", "Finite-difference Jacobian instead of the analytic derivatives (columns in parallel for a single spectrum with --threads != 1).");
+    const QCommandLineOption serveOption("serve", "Run as fit service with the project as default template (JSON requests over a local socket).", "project");
+    const QCommandLineOption portOption("port", "TCP port of the service on localhost (default: " % QVariant(SERVICE_DEFAULT_PORT).toString() % ").", "n", QVariant(SERVICE_DEFAULT_PORT).toString());
+    const QCommandLineOption localOption("local", "Name of the local socket (Unix domain socket/named pipe) of the service instead of TCP.", "name");
+    const QCommandLineOption maxQueueOption("max-queue", "Limit of queued and running fits of the service (default: " % QVariant(SERVICE_QUEUE_FACTOR).toString() % " per thread).", "n", "0");
+
+    parser.addOption(fitOption);
+    parser.addOption(formatOption);
+    parser.addOption(outputOption);
+    parser.addOption(binFactorOption);
+    parser.addOption(threadsOption);
+    parser.addOption(multiStartOption);
+    parser.addOption(numericalOption);
+    parser.addOption(convertOption);
+    parser.addOption(serveOption);
+    parser.addOption(portOption);
+    parser.addOption(localOption);
+    parser.addOption(maxQueueOption);
+    parser.addPositionalArgument("spectra", "ASCII spectra to be fitted with the project as template (default: data of the project).", "[spectrum ...]");
+
+    parser.process(app); /* exits on --help/--version */
+
+    if ( parser.isSet(convertOption) ) {
+        if ( !parser.isSet(outputOption) ) {
+            fprintf(stderr, "--convert requires --output\n");
+            return CLI_EXIT_USAGE;
+        }
+
+        const QString sourceFileName = parser.value(convertOption);
+        const QString targetFileName = parser.value(outputOption);
+
+        if ( !PALSProjectBinaryFile::convert(sourceFileName, targetFileName) ) {
+            fprintf(stderr, "cannot convert project: %s => %s\n", qPrintable(sourceFileName), qPrintable(targetFileName));
+            return QFileInfo(sourceFileName).isReadable() ? CLI_EXIT_OUTPUT : CLI_EXIT_NO_PROJECT;
+        }
+
+        return CLI_EXIT_OK;
+    }
+
+    const QString format = parser.value(formatOption).toLower();
+
+    if ( format != "json"
+         && format != "csv" ) {
+        fprintf(stderr, "unknown format: %s\n", qPrintable(format));
+        return CLI_EXIT_USAGE;
+    }
+
+    bool ok = true;
+
+    const int threadCnt = parser.value(threadsOption).toInt(&ok);
+
+    if ( !ok || threadCnt < 0 ) {
+        fprintf(stderr, "invalid number of threads: %s\n", qPrintable(parser.value(threadsOption)));
+        return CLI_EXIT_USAGE;
+    }
+
+    const int startCnt = parser.value(multiStartOption).toInt(&ok);
+
+    if ( !ok || startCnt < 1 ) {
+        fprintf(stderr, "invalid number of starts: %s\n", qPrintable(parser.value(multiStartOption)));
+        return CLI_EXIT_USAGE;
+    }
+
+    if ( parser.isSet(serveOption) ) {
+        const int maxQueue = parser.value(maxQueueOption).toInt(&ok);
+
+        if ( !ok || maxQueue < 0 ) {
+            fprintf(stderr, "invalid queue limit: %s\n", qPrintable(parser.value(maxQueueOption)));
+            return CLI_EXIT_USAGE;
+        }
+
+        const int port = parser.value(portOption).toInt(&ok);
+
+        if ( !ok || port < 0 || port > 65535 ) {
+            fprintf(stderr, "invalid port: %s\n", qPrintable(parser.value(portOption)));
+            return CLI_EXIT_USAGE;
+        }
+
+        const QString templateFileName = parser.value(serveOption);
+
+        if ( !PALSProjectManager::sharedInstance()->load(templateFileName)
+             || !PALSProjectManager::sharedInstance()->getDataStructure() ) {
+            fprintf(stderr, "cannot load project: %s\n", qPrintable(templateFileName));
+            return CLI_EXIT_NO_PROJECT;
+        }
+
+        /* the default of --threads (1) is meant for a single batch: the service uses all cores unless given */
+        DFastLTFitService service(PALSProjectManager::sharedInstance()->getDataStructure()->getFitSetPtr(),
+                                  parser.isSet(threadsOption)?threadCnt:0, startCnt, maxQueue);
+
+        const bool listening = parser.isSet(localOption)?service.listenLocal(parser.value(localOption))
+                                                        :service.listen((quint16)port);
+
+        if ( !listening ) {
+            fprintf(stderr, "cannot listen: %s\n", qPrintable(service.errorString()));
+            return CLI_EXIT_USAGE;
+        }
+
+        fprintf(stderr, "fit service listening on %s\n", parser.isSet(localOption)?qPrintable(parser.value(localOption))
+                                                                                   :qPrintable("localhost:" % QVariant(service.serverPort()).toString())); /* --port 0: chosen by the system */
+
+        return app.exec(); /* until terminated */
+    }
+
+    const QString projectFileName = parser.value(fitOption);
+
+    if ( !PALSProjectManager::sharedInstance()->load(projectFileName)
+         || !PALSProjectManager::sharedInstance()->getDataStructure() ) {
+        fprintf(stderr, "cannot load project: %s\n", qPrintable(projectFileName));
+        return CLI_EXIT_NO_PROJECT;
+    }
+
+    PALSDataStructure *dataStructure = PALSProjectManager::sharedInstance()->getDataStructure();
+
+    int binFac = (int)dataStructure->getDataSetPtr()->getBinFactor();
+
+    if ( parser.isSet(binFactorOption) ) {
+        binFac = parser.value(binFactorOption).toInt(&ok);
+
+        if ( !ok || binFac < 1 ) {
+            fprintf(stderr, "invalid bin factor: %s\n", qPrintable(parser.value(binFactorOption)));
+            return CLI_EXIT_USAGE;
+        }
+    }
+
+    LifeTimeDecayBatchFitEngine engine;
+
+    engine.setTemplate(dataStructure->getFitSetPtr());
+    engine.setThreadCount(threadCnt);
+    engine.setMultiStartCount(startCnt);
+    engine.setNumericalDerivatives(parser.isSet(numericalOption));
+
+    const QStringList spectra = parser.positionalArguments();
+
+    if ( spectra.isEmpty() )
+        engine.addSpectrum(QFileInfo(projectFileName).fileName(), dataStructure->getDataSetPtr()->getLifeTimeData());
+    else {
+        for ( const QString& fileName : spectra )
+            engine.addSpectrum(fileName, binFac);
+    }
+
+    engine.run(); /* blocking */
+
+    QList<PALSBatchFitResult> results = engine.results();
+
+    /* order of the spectra (the batch reports in the order of completion) */
+    std::sort(results.begin(), results.end(), [](const PALSBatchFitResult& a, const PALSBatchFitResult& b) { return a.index < b.index; });
+
+    const QByteArray output = (format == "json")?jsonResult(QFileInfo(projectFileName).fileName(), dataStructure->getFitSetPtr(), results)
+                                                :csvResult(dataStructure->getFitSetPtr(), results);
+
+    QFile outputFile;
+
+    if ( parser.isSet(outputOption) ) {
+        outputFile.setFileName(parser.value(outputOption));
+        ok = outputFile.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    }
+    else
+        ok = outputFile.open(stdout, QIODevice::WriteOnly);
+
+    if ( !ok
+         || outputFile.write(output) != output.size() ) {
+        fprintf(stderr, "cannot write the result: %s\n", qPrintable(outputFile.fileName()));
+        return CLI_EXIT_OUTPUT;
+    }
+
+    outputFile.close();
+
+    for ( const PALSBatchFitResult& result : results ) {
+        const int code = exitCode(result.status);
+
+        if ( code != CLI_EXIT_OK )
+            return code;
+    }
+
+    return CLI_EXIT_OK;
+}
+
+int DFastLTFitCLI::exitCode(int fitStatus)
+{
+    if ( fitStatus >= MP_OK_CHI
+         && fitStatus <= MP_OK_DIR ) /* converged (see PALSFitErrorCodeStringBuilder) */
+        return CLI_EXIT_OK;
+
+    if ( fitStatus >= MP_MAXITER
+         && fitStatus <= MP_GTOL ) /* stopped without convergence: maximum iterations or tolerances too small */
+        return fitStatus;
+
+    if ( fitStatus == 0 ) /* general input error */
+        return 1;
+
+    return qMin(-fitStatus, 125);
+}
+
+QByteArray DFastLTFitCLI::jsonResult(const QString &projectName, const PALSFitSet *fitSet, const QList<PALSBatchFitResult> &results)
+{
+    const QStringList names = LifeTimeDecayBatchFitEngine::parameterNames(fitSet);
+
+    QJsonArray resultArray;
+
+    for ( const PALSBatchFitResult& result : results )
+        resultArray.append(jsonResultObject(names, result));
+
+    QJsonObject rootObject;
+
+    rootObject.insert("project", projectName);
+    rootObject.insert("version", VERSION_STRING_AND_PROGRAM_NAME);
+    rootObject.insert("results", resultArray);
+
+    return QJsonDocument(rootObject).toJson(QJsonDocument::Indented);
+}
+
+QJsonObject DFastLTFitCLI::jsonResultObject(const QStringList &names, const PALSBatchFitResult &result)
+{
+    QJsonObject resultObject;
+
+    resultObject.insert("name", result.name);
+    resultObject.insert("status", result.status);
+
+    if ( result.status == BATCH_ERR_IMPORT )
+        resultObject.insert("status_text", QString("Error. ASCII import failed."));
+    else if ( result.status == BATCH_ERR_CANCELED )
+        resultObject.insert("status_text", QString("Error. Canceled."));
+    else
+        resultObject.insert("status_text", plainText(PALSFitErrorCodeStringBuilder::errorString(result.status)));
+
+    resultObject.insert("reduced_chi_square", result.chiSquare);
+    resultObject.insert("fit_time", result.fitTime);
+
+    QJsonObject parameterObject;
+
+    for ( int i = 0 ; i < result.values.size() && i < names.size() ; ++ i ) {
+        QJsonObject valueObject;
+
+        valueObject.insert("value", result.values.at(i));
+        valueObject.insert("error", result.errors.at(i));
+
+        parameterObject.insert(names.at(i), valueObject);
+    }
+
+    resultObject.insert("parameters", parameterObject);
+
+    return resultObject;
+}
+
+QByteArray DFastLTFitCLI::csvResult(const PALSFitSet *fitSet, const QList<PALSBatchFitResult> &results)
+{
+    QString csv = LifeTimeDecayBatchFitEngine::resultHeader(fitSet) % "\n";
+
+    for ( const PALSBatchFitResult& result : results )
+        csv.append(LifeTimeDecayBatchFitEngine::resultRow(result) % "\n");
+
+    return csv.toUtf8();
+}
+
+QString DFastLTFitCLI::plainText(const QString &htmlText)
+{
+    QString text = htmlText;
+
+    text.replace("&#967;<sup>2</sup>", "chi-square");
+    text.remove(QRegularExpression("<[^>]*>"));
+
+    return text;
+}
@@ -0,0 +1,102 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+
+#ifndef DFASTLTFITCLI_H
+#define DFASTLTFITCLI_H
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QRegularExpression>
+
+#include <algorithm>
+
+#include "Settings/projectmanager.h"
+#include "Settings/asciidataimport.h"
+#include "Settings/projectbinaryfile.h"
+
+#include "Fit/lifetimedecayfit.h"
+#include "Fit/lifetimedecaybatchfit.h"
+
+#include "ltdefines.h"
+
+/* exit codes of the command-line mode (besides the mapped fit status, see DFastLTFitCLI::exitCode(...)) */
+#define CLI_EXIT_OK (0)
+#define CLI_EXIT_USAGE (64) /* invalid arguments */
+#define CLI_EXIT_NO_PROJECT (66) /* project cannot be loaded */
+#define CLI_EXIT_OUTPUT (73) /* result cannot be written */
+
+/*
+ * DFastLTFitCLI - headless fitting (no QWidget is constructed):
+ *---------------------------------------------------------------
+ *
+ * DQuickLTFit --fit <project.dquicklt> [spectrum ...] [--format json|csv] [--output <file>] [--bin-factor <n>] [--threads <n>]
+ *                                                    [--multi-start <n>] [--numerical-derivatives]
+ *
+ * The fit set of the project is the template. Without spectra the lifetime data stored in the project is fitted, otherwise
+ * each ASCII spectrum is fitted. The results are written to stdout (or --output).
+ *
+ * DQuickLTFit --convert <project> --output <target>
+ *
+ * converts the project between the XML (.dquicklt) and the binary (.dquickltb) format, the format of the target is given by
+ * its extension.
+ *
+ * DQuickLTFit --serve <project> [--port <n> | --local <name>] [--threads <n>] [--multi-start <n>] [--max-queue <n>]
+ *
+ * runs the fit service (see DFastLTFitService) with the fit set of the project as default template.
+ *
+ * exit code: 0 if all fits converged (mpfit status 1 ... 4), otherwise the code of the first failed fit:
+ *            1 (mpfit: general input error), 5 (mpfit: maximum number of iterations reached), 6 ... 8 (mpfit: no further
+ *            improvement, the ftol/xtol/gtol criterion is too small), -status (mpfit: 16 ... 24, engine: 60 ... 62,
+ *            multi-start: 63, batch: 70 ... 71) or one of the CLI_EXIT_... codes.
+ */
+
+class DFastLTFitCLI
+{
+public:
+    /* true: the arguments request the command-line mode (--fit, --convert or --serve) */
+    static bool isRequested(int argc, char *argv[]);
+
+    static int exec(int argc, char *argv[]);
+
+    static int exitCode(int fitStatus);
+
+    /* JSON of a single result: name, status, status_text, reduced_chi_square, fit_time and the parameters (value, error) */
+    static QJsonObject jsonResultObject(const QStringList& names, const PALSBatchFitResult& result);
+
+private:
+    static QByteArray jsonResult(const QString& projectName, const PALSFitSet *fitSet, const QList<PALSBatchFitResult>& results);
+    static QByteArray csvResult(const PALSFitSet *fitSet, const QList<PALSBatchFitResult>& results);
+
+    static QString plainText(const QString& htmlText);
+};
+
+#endif // DFASTLTFITCLI_H
@@ -99,6 +99,44 @@ DFastLTFitDlg::DFastLTFitDlg(const QString projectPath, QWidget *parent) :
     connect(ui->pushButtonRunFit, SIGNAL(clicked()), this, SLOT(runFit()));
     connect(m_fitEngine, SIGNAL(finished()), this, SLOT(fitHasFinished()));
 
+    m_batchFitEngineThread = new QThread;
+    m_batchFitEngine = new LifeTimeDecayBatchFitEngine;
+    m_batchFitEngine->moveToThread(m_batchFitEngineThread);
+
+    connect(m_batchFitEngineThread, SIGNAL(started()), m_batchFitEngine, SLOT(run()));
+    connect(m_batchFitEngine, SIGNAL(progress(int,int,double)), this, SLOT(batchFitProgress(int,int,double)));
+    connect(m_batchFitEngine, SIGNAL(finished()), this, SLOT(batchFitHasFinished()));
+
+    m_previewGeneration = 0;
+
+    m_previewEngineThread = new QThread;
+    m_previewEngine = new LifeTimeDecayPreviewEngine;
+    m_previewEngine->moveToThread(m_previewEngineThread);
+
+    connect(m_previewEngine, SIGNAL(previewReady(PALSPreviewResult)), this, SLOT(previewReady(PALSPreviewResult)));
+
+    m_previewEngineThread->start();
+
+    m_listModeSettings = PALSListModeImport::defaultSettings();
+
+    m_spectrumWatcher = new PALSSpectrumWatcher;
+    m_watchRefitTimer = new QTimer;
+
+    m_watchBinFactor = 1;
+    m_watchRefitInterval = 10;
+    m_watchInitialized = false;
+    m_watchRefitPending = false;
+    m_watchRefitRunning = false;
+    m_watchRefitCount = 0;
+    m_watchDeferredChannel = -1;
+    m_watchMaxChannel = -1;
+    m_watchYMax = 0.0;
+
+    connect(m_spectrumWatcher, SIGNAL(spectrumChanged(int)), this, SLOT(watchedSpectrumChanged(int)));
+    connect(m_spectrumWatcher, SIGNAL(fileChanged(QString)), this, SLOT(watchedFileChanged(QString)));
+    connect(m_spectrumWatcher, SIGNAL(importFailed(int)), this, SLOT(watchImportFailed(int)));
+    connect(m_watchRefitTimer, SIGNAL(timeout()), this, SLOT(watchRefit()));
+
     m_chiSquareLabel = new QLabel;
     m_integralCountInROI = new QLabel;
 
@@ -112,6 +150,10 @@ DFastLTFitDlg::DFastLTFitDlg(const QString projectPath, QWidget *parent) :
     connect(ui->actionNew, SIGNAL(triggered()), this, SLOT(newProject()));
     connect(ui->actionSaveAs, SIGNAL(triggered()), this, SLOT(saveProjectAs()));
     connect(ui->actionImport, SIGNAL(triggered()), this, SLOT(importASCII()));
+    connect(ui->actionImportListMode, SIGNAL(triggered()), this, SLOT(importListMode()));
+    connect(ui->actionWatch, SIGNAL(triggered()), this, SLOT(watchASCII()));
+    connect(ui->actionStopWatching, SIGNAL(triggered()), this, SLOT(stopWatching()));
+    connect(ui->actionBatchFit, SIGNAL(triggered()), this, SLOT(runBatchFit()));
 
     connect(ui->widget, SIGNAL(dataChanged()), this, SLOT(instantPreview()));
 
@@ -262,9 +304,23 @@ DFastLTFitDlg::~DFastLTFitDlg()
     DDELETE_SAFETY(m_chiSquareLabel);
     DDELETE_SAFETY(m_integralCountInROI);
 
+    m_watchRefitTimer->stop();
+
+    DDELETE_SAFETY(m_watchRefitTimer);
+    DDELETE_SAFETY(m_spectrumWatcher);
+
     DDELETE_SAFETY(m_fitEngine);
     DDELETE_SAFETY(m_fitEngineThread);
 
+    DDELETE_SAFETY(m_batchFitEngine);
+    DDELETE_SAFETY(m_batchFitEngineThread);
+
+    m_previewEngineThread->quit();
+    m_previewEngineThread->wait();
+
+    DDELETE_SAFETY(m_previewEngine);
+    DDELETE_SAFETY(m_previewEngineThread);
+
     DDELETE_SAFETY(ui);
 }
 
@@ -312,7 +368,7 @@ void DFastLTFitDlg::openProject()
 {
     const QString fileName = QFileDialog::getOpenFileName(this, tr("Open a project"),
                                                     PALSProjectSettingsManager::sharedInstance()->getLastChosenPath(),
-                                                    QString("DQuickLTFit Project File (*" % PROJECT_EXTENSION % ")"));
+                                                    QString("DQuickLTFit Project File (*" % PROJECT_EXTENSION % " *" % PROJECT_BINARY_EXTENSION % ")"));
 
     openProjectFromPath(fileName);
 }
@@ -349,10 +405,12 @@ void DFastLTFitDlg::openProjectFromPath(const QString& fileName)
             int minCnts = INT_MAX;
             int maxCnts = -INT_MAX;
 
-            for ( int i = 0 ; i < PALSProjectManager::sharedInstance()->getDataStructure()->getDataSetPtr()->getLifeTimeData().size() ; ++ i )
+            const PALSSpectrum lifetimeData = PALSProjectManager::sharedInstance()->getDataStructure()->getDataSetPtr()->getLifeTimeData();
+
+            for ( int i = 0 ; i < lifetimeData.size() ; ++ i )
             {
-                const int channel = (const int)PALSProjectManager::sharedInstance()->getDataStructure()->getDataSetPtr()->getLifeTimeData().at(i).x();
-                const int counts = (const int)PALSProjectManager::sharedInstance()->getDataStructure()->getDataSetPtr()->getLifeTimeData().at(i).y();
+                const int channel = (const int)lifetimeData.channelAt(i);
+                const int counts = (const int)lifetimeData.countsAt(i);
 
                 maxChn = qMax(channel, maxChn);
                 minChn = qMin(channel, minChn);
@@ -413,7 +471,7 @@ void DFastLTFitDlg::saveProject()
     {
         filename = QFileDialog::getSaveFileName(this, tr("Select or type a filename..."),
                                                 PALSProjectSettingsManager::sharedInstance()->getLastChosenPath(),
-                                                QString("DQuickLTFit Project File (*" % PROJECT_EXTENSION % ")"));
+                                                QString("DQuickLTFit Project File (*" % PROJECT_EXTENSION % ");;DQuickLTFit Binary Project File (*" % PROJECT_BINARY_EXTENSION % ")"));
 
         if ( filename.isEmpty() )
             return;
@@ -442,7 +500,7 @@ void DFastLTFitDlg::saveProjectAs()
 {
     const QString filename = QFileDialog::getSaveFileName(this, tr("Select or type a filename..."),
                                                           PALSProjectSettingsManager::sharedInstance()->getLastChosenPath(),
-                                                          QString("DQuickLTFit Project File (*" % PROJECT_EXTENSION % ")"));
+                                                          QString("DQuickLTFit Project File (*" % PROJECT_EXTENSION % ");;DQuickLTFit Binary Project File (*" % PROJECT_BINARY_EXTENSION % ")"));
 
     if ( filename.isEmpty() )
         return;
@@ -489,125 +547,6 @@ void DFastLTFitDlg::newProject()
     updateWindowTitle();
 }
 
-QStringList DFastLTFitDlg::autoDetectDelimiter(const QString& row)
-{
-    if ( row.split(";").size() != 2 )
-    {
-        if ( row.split("|").size() != 2 )
-        {
-            if ( row.split("\t").size() < 2 )
-            {
-                if ( row.split(" ").size() >= 2 )
-                {
-                    QStringList returnList;
-                    const QStringList list = row.split(" ");
-                    const int splitSize = list.size();
-
-                    int cnt = 0;
-                    for ( int i = 0 ; i < splitSize ; ++ i )
-                    {
-                        if ( list.at(i).isEmpty() )
-                            continue;
-                        else
-                        {
-                            bool ok = false;
-                            const int value = (int)QVariant(list.at(i).trimmed()).toDouble(&ok);
-                            DUNUSED_PARAM(value);
-
-                            if ( ok )
-                            {
-                                returnList.append(list.at(i).trimmed());
-                                cnt ++;
-                            }
-
-                            if ( cnt == 2 )
-                                break;
-                        }
-                    }
-
-
-                    return returnList;
-                }
-                else
-                {
-                    QStringList returnList;
-
-                    bool ok = false;
-                    const int value = (int)QVariant(row.trimmed()).toDouble(&ok);
-                    DUNUSED_PARAM(value);
-
-                    if ( ok )
-                    {
-                        returnList.append(row.trimmed());
-                    }
-
-
-                    return returnList;
-                }
-            }
-            else
-            {
-                QStringList returnList;
-                const QStringList list = row.split("\t");
-                const int splitSize = list.size();
-
-                int cnt = 0;
-                for ( int i = 0 ; i < splitSize ; ++ i )
-                {
-                    if ( list.at(i).isEmpty() )
-                        continue;
-                    else
-                    {
-                        bool ok = false;
-                        const int value = (int)QVariant(list.at(i).trimmed()).toDouble(&ok);
-                        DUNUSED_PARAM(value);
-
-                        if ( ok )
-                        {
-                            returnList.append(list.at(i).trimmed());
-                            cnt ++;
-                        }
-
-                        if ( cnt == 2 )
-                            break;
-                    }
-                }
-
-
-                return returnList;
-            }
-        }
-        else
-        {
-            const QStringList list = row.split("|");
-            const QString value1 = list.at(0).trimmed();
-            const QString value2 = list.at(1).trimmed();
-
-            QStringList returnList;
-            returnList.append(value1);
-            returnList.append(value2);
-
-
-            return returnList;
-        }
-    }
-    else
-    {
-        const QStringList list = row.split(";");
-        const QString value1 = list.at(0).trimmed();
-        const QString value2 = list.at(1).trimmed();
-
-        QStringList returnList;
-        returnList.append(value1);
-        returnList.append(value2);
-
-
-        return returnList;
-    }
-
-    return QStringList();
-}
-
 void DFastLTFitDlg::importASCII(const AccessType& type, const QString& fileNameFromSeq)
 {
     QString fileName = "";
@@ -665,114 +604,463 @@ void DFastLTFitDlg::importASCII(const AccessType& type, const QString& fileNameF
         fileName = fileNameFromSeq;
 
 
-    QFile file(fileName);
+    PALSASCIIData data;
+    const asciiImportStatus status = PALSASCIIDataImport::importFile(fileName, binFac, &data);
 
-    if ( file.open(QIODevice::ReadOnly) ) {
-        QList<QPointF> dataSet;
-        int minChn = INT_MAX;
-        int  maxChn = -INT_MAX;
-        int minCnts = INT_MAX;
-        int maxCnts = -INT_MAX;
+    if ( status == asciiImportStatus::ok_ImportStatus ) {
+        setImportedData(data, binFac);
+    }
+    else if ( status == asciiImportStatus::negativeCounts_ImportStatus )
+    {
+        if ( type == AccessType::FromOneFile ) {
+            DMSGBOX("Please correct the content of this file. Values lower than 0 detected.")
+        }
 
-        int channelCounter = 0;
-        int channel = 0;
-        int counts = 0;
+        return;
+    }
+    else if ( status == asciiImportStatus::tooFewData_ImportStatus )
+    {
+        DMSGBOX("Either the Number of Data-Points was too low or the Bin-Factor is too high!");
+        return;
+    }
+    else
+    {
+        if ( type == AccessType::FromOneFile )
+        {
+            DMSGBOX("Sorry, an error occurred while importing lifetime-data.")
+        }
+    }
 
-        while ( !file.atEnd() ) {
-            QString dataRow = file.readLine();
+    PALSProjectManager::sharedInstance()->setASCIIDataName(fileName);
 
-            const QStringList dataSetString = autoDetectDelimiter(dataRow);
+    updateWindowTitle();
+}
 
-            if ( dataSetString.size() != 2
-                 && dataSetString.size() != 1 )
-                continue;
+void DFastLTFitDlg::importListMode()
+{
+    const QString fileName = QFileDialog::getOpenFileName(this, tr("Import data from List-Mode Events..."),
+                                                          PALSProjectSettingsManager::sharedInstance()->getLastChosenPath(),
+                                                          tr("List-Mode Events (*.dat *.bin *.lst);;All Files (*)"));
 
-            bool ok_1 = true, ok_2 = false;
+    if ( fileName.isEmpty() )
+        return;
 
-            channelCounter ++;
+    PALSProjectSettingsManager::sharedInstance()->setLastChosenPath(QFileInfo(fileName).absoluteDir().absolutePath());
 
-            if ( dataSetString.size() == 2 ) {
-                int tchannel = (int)QVariant(dataSetString.at(0)).toInt(&ok_1);
-                DUNUSED_PARAM(tchannel);
-            }
+    if ( !editListModeSettings(&m_listModeSettings) )
+        return;
 
-            if ( dataSetString.size() == 2 )
-                counts += (int)QVariant(dataSetString.at(1)).toInt(&ok_2);
-            else if ( dataSetString.size() == 1 )
-                counts += (int)QVariant(dataSetString.at(0)).toInt(&ok_2);
+    QApplication::setOverrideCursor(Qt::WaitCursor);
 
-            if ( !ok_1 || !ok_2 )
-                continue;
+    PALSASCIIData data;
+    const asciiImportStatus status = PALSListModeImport::importFile(fileName, m_listModeSettings, &data);
 
-            maxChn = qMax(channel, maxChn);
-            minChn = qMin(channel, minChn);
-            maxCnts = qMax(counts, maxCnts);
-            minCnts = qMin(counts, minCnts);
+    QApplication::restoreOverrideCursor();
 
-            if ( counts < 0 ) {
-                if ( type == AccessType::FromOneFile ) {
-                    DMSGBOX("Please correct the content of this file. Values lower than 0 detected.")
-                }
+    if ( status == asciiImportStatus::ok_ImportStatus )
+    {
+        /* the bin width replaces the bin-factor */
+        PALSProjectManager::sharedInstance()->getDataStructure()->getFitSetPtr()->setChannelResolution(m_listModeSettings.binWidth);
+        ui->widget->updateParamterList();
 
-                file.close();
-                return;
-            }
+        setImportedData(data, 1);
+    }
+    else if ( status == asciiImportStatus::invalidLayout_ImportStatus )
+    {
+        DMSGBOX("Please check the Record Layout: the Fields have to lie within the Record and the Histogram needs more than 2 Channels.");
+        return;
+    }
+    else if ( status == asciiImportStatus::tooFewData_ImportStatus )
+    {
+        DMSGBOX("No Start-Stop Coincidences found. Please check the Detectors, Energy Windows and the Coincidence Window.");
+        return;
+    }
+    else
+    {
+        DMSGBOX("Sorry, an error occurred while importing lifetime-data.");
+        return;
+    }
 
-            if ( !(channelCounter%binFac) ) {
-                dataSet.append(QPointF(channel, counts));
-                counts = 0;
-                channel ++;
-            }
-        }
+    PALSProjectManager::sharedInstance()->setASCIIDataName(fileName);
 
-        file.close();
+    updateWindowTitle();
+}
 
-        if ( dataSet.size() <= 2 ) {
-            DMSGBOX("Either the Number of Data-Points was too low or the Bin-Factor is too high!");
-            return;
-        }
+void DFastLTFitDlg::setImportedData(const PALSASCIIData &data, int binFac)
+{
+    const PALSSpectrum dataSet = data.dataSet;
+    const int minChn = data.minChannel;
+    const int maxChn = data.maxChannel;
+    const int maxCnts = data.maxCounts;
 
+    PALSProjectManager::sharedInstance()->setChannelRanges(minChn, maxChn);
 
-        PALSProjectManager::sharedInstance()->setChannelRanges(minChn, maxChn);
+    PALSProjectManager::sharedInstance()->getDataStructure()->getDataSetPtr()->clearFitData();
+    PALSProjectManager::sharedInstance()->getDataStructure()->getDataSetPtr()->clearResidualData();
 
-        PALSProjectManager::sharedInstance()->getDataStructure()->getDataSetPtr()->clearFitData();
-        PALSProjectManager::sharedInstance()->getDataStructure()->getDataSetPtr()->clearResidualData();
+    PALSProjectManager::sharedInstance()->getDataStructure()->getDataSetPtr()->setLifeTimeData(dataSet);
+    PALSProjectManager::sharedInstance()->getDataStructure()->getDataSetPtr()->setBinFactor(binFac);
+
+    m_plotWindow->clearAll();
 
-        PALSProjectManager::sharedInstance()->getDataStructure()->getDataSetPtr()->setLifeTimeData(dataSet);
-        PALSProjectManager::sharedInstance()->getDataStructure()->getDataSetPtr()->setBinFactor(binFac);
+    m_plotWindow->setXRange(minChn, maxChn);
+    m_plotWindow->addRawData(dataSet);
+    m_plotWindow->setXRange(minChn, maxChn);
 
-        m_plotWindow->clearAll();
+    int newStartChannel = PALSProjectManager::sharedInstance()->getDataStructure()->getFitSetPtr()->getStartChannel();
+    if (  newStartChannel < minChn )
+        newStartChannel = minChn;
 
-        m_plotWindow->setXRange(minChn, maxChn);
-        m_plotWindow->addRawData(dataSet);
-        m_plotWindow->setXRange(minChn, maxChn);
+    int newStopChannel = PALSProjectManager::sharedInstance()->getDataStructure()->getFitSetPtr()->getStopChannel();
+    if (  newStopChannel > maxChn )
+        newStopChannel = maxChn;
 
-        int newStartChannel = PALSProjectManager::sharedInstance()->getDataStructure()->getFitSetPtr()->getStartChannel();
-        if (  newStartChannel < minChn )
-            newStartChannel = minChn;
+    ui->widget->setFitRangeLimits(minChn, maxChn);
+    ui->widget->setFitRange(newStartChannel, newStopChannel);
 
-        int newStopChannel = PALSProjectManager::sharedInstance()->getDataStructure()->getFitSetPtr()->getStopChannel();
-        if (  newStopChannel > maxChn )
-            newStopChannel = maxChn;
+    m_plotWindow->setYRangeData(1, 1.3*((double)maxCnts));
 
-        ui->widget->setFitRangeLimits(minChn, maxChn);
-        ui->widget->setFitRange(newStartChannel, newStopChannel);
+    instantPreview();
+}
 
-        m_plotWindow->setYRangeData(1, 1.3*((double)maxCnts));
+bool DFastLTFitDlg::editListModeSettings(PALSListModeSettings *settings)
+{
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("List-Mode Import"));
+
+    QFormLayout *layout = new QFormLayout(&dialog);
+
+    auto addIntBox = [&](const QString& label, int value, int min, int max) {
+        QSpinBox *box = new QSpinBox(&dialog);
+        box->setRange(min, max);
+        box->setValue(value);
+
+        layout->addRow(label, box);
+
+        return box;
+    };
+
+    auto addDoubleBox = [&](const QString& label, double value, double min, double max, int decimals) {
+        QDoubleSpinBox *box = new QDoubleSpinBox(&dialog);
+        box->setRange(min, max);
+        box->setDecimals(decimals);
+        box->setValue(value);
+
+        layout->addRow(label, box);
+
+        return box;
+    };
+
+    /* record layout */
+    QSpinBox *recordSize = addIntBox(tr("Record Size [bytes]"), settings->layout.recordSize, 1, 256);
+    QSpinBox *timestampOffset = addIntBox(tr("Timestamp Offset [bytes]"), settings->layout.timestampOffset, 0, 255);
+    QSpinBox *timestampSize = addIntBox(tr("Timestamp Width [bytes]"), settings->layout.timestampSize, 1, 8);
+    QDoubleSpinBox *timestampUnit = addDoubleBox(tr("Timestamp Unit [ps]"), settings->layout.timestampUnit, 0.001, 1E6, 3);
+    QSpinBox *detectorOffset = addIntBox(tr("Detector-Id Offset [bytes]"), settings->layout.detectorOffset, 0, 255);
+    QSpinBox *detectorSize = addIntBox(tr("Detector-Id Width [bytes] (0: none)"), settings->layout.detectorSize, 0, 8);
+    QSpinBox *energyOffset = addIntBox(tr("Energy Offset [bytes]"), settings->layout.energyOffset, 0, 255);
+    QSpinBox *energySize = addIntBox(tr("Energy Width [bytes] (0: none)"), settings->layout.energySize, 0, 8);
+
+    /* start/stop events */
+    QSpinBox *startDetector = addIntBox(tr("Start Detector-Id (-1: any)"), settings->startDetector, -1, INT_MAX);
+    QSpinBox *stopDetector = addIntBox(tr("Stop Detector-Id (-1: any)"), settings->stopDetector, -1, INT_MAX);
+    QSpinBox *startEnergyMin = addIntBox(tr("Start Energy-Window (min)"), (int)qMin(settings->startEnergyMin, (quint64)INT_MAX), 0, INT_MAX);
+    QSpinBox *startEnergyMax = addIntBox(tr("Start Energy-Window (max)"), (int)qMin(settings->startEnergyMax, (quint64)INT_MAX), 0, INT_MAX);
+    QSpinBox *stopEnergyMin = addIntBox(tr("Stop Energy-Window (min)"), (int)qMin(settings->stopEnergyMin, (quint64)INT_MAX), 0, INT_MAX);
+    QSpinBox *stopEnergyMax = addIntBox(tr("Stop Energy-Window (max)"), (int)qMin(settings->stopEnergyMax, (quint64)INT_MAX), 0, INT_MAX);
+    QDoubleSpinBox *coincidenceWindow = addDoubleBox(tr("Coincidence Window [ps]"), settings->coincidenceWindow, 1.0, 1E9, 1);
+
+    /* histogram */
+    QDoubleSpinBox *binWidth = addDoubleBox(tr("Bin Width [ps]"), settings->binWidth, 0.001, 1E6, 3);
+    QDoubleSpinBox *timeOffset = addDoubleBox(tr("Time Offset [ps]"), settings->timeOffset, -1E9, 1E9, 1);
+    QSpinBox *channelCnt = addIntBox(tr("Channels"), settings->channelCnt, 3, 1 << 20);
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok|QDialogButtonBox::Cancel, &dialog);
+    layout->addRow(buttonBox);
+
+    connect(buttonBox, SIGNAL(accepted()), &dialog, SLOT(accept()));
+    connect(buttonBox, SIGNAL(rejected()), &dialog, SLOT(reject()));
+
+    if ( dialog.exec() != QDialog::Accepted )
+        return false;
+
+    settings->layout.recordSize = recordSize->value();
+    settings->layout.timestampOffset = timestampOffset->value();
+    settings->layout.timestampSize = timestampSize->value();
+    settings->layout.timestampUnit = timestampUnit->value();
+    settings->layout.detectorOffset = detectorOffset->value();
+    settings->layout.detectorSize = detectorSize->value();
+    settings->layout.energyOffset = energyOffset->value();
+    settings->layout.energySize = energySize->value();
+
+    settings->startDetector = startDetector->value();
+    settings->stopDetector = stopDetector->value();
+    settings->startEnergyMin = (quint64)startEnergyMin->value();
+    settings->startEnergyMax = (quint64)startEnergyMax->value();
+    settings->stopEnergyMin = (quint64)stopEnergyMin->value();
+    settings->stopEnergyMax = (quint64)stopEnergyMax->value();
+    settings->coincidenceWindow = coincidenceWindow->value();
+
+    settings->binWidth = binWidth->value();
+    settings->timeOffset = timeOffset->value();
+    settings->channelCnt = channelCnt->value();
+
+    return true;
+}
 
-        instantPreview();
+void DFastLTFitDlg::watchASCII()
+{
+    QString path = PALSProjectSettingsManager::sharedInstance()->getLastChosenPath();
+
+    if ( !editWatchSettings(&path) )
+        return;
+
+    stopWatching();
+
+    const QFileInfo info(path);
+    PALSProjectSettingsManager::sharedInstance()->setLastChosenPath(info.isDir()?info.absoluteFilePath():info.absoluteDir().absolutePath());
+
+    m_watchInitialized = false;
+    m_watchRefitPending = false;
+    m_watchRefitCount = 0;
+    m_watchDeferredChannel = -1;
+    m_watchMaxChannel = -1;
+    m_watchYMax = 0.0;
+
+    /* the first refit starts from the start values of the fit set, the following ones from the previous refit */
+    m_fitEngine->resetWarmStart();
+
+    if ( !m_spectrumWatcher->watch(path, m_watchBinFactor) )
+    {
+        DMSGBOX("Sorry, the File or Directory cannot be watched.");
+        return;
     }
-    else
+
+    if ( m_watchRefitInterval > 0 )
+        m_watchRefitTimer->start(m_watchRefitInterval*1000);
+
+    ui->actionStopWatching->setEnabled(true);
+
+    showWatchStatus();
+}
+
+void DFastLTFitDlg::stopWatching()
+{
+    if ( !m_spectrumWatcher->isWatching() )
+        return;
+
+    m_spectrumWatcher->stop();
+    m_watchRefitTimer->stop();
+
+    m_watchRefitPending = false;
+    m_watchDeferredChannel = -1;
+
+    ui->actionStopWatching->setEnabled(false);
+    ui->statusBar->clearMessage();
+}
+
+bool DFastLTFitDlg::editWatchSettings(QString *path)
+{
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Watch growing ASCII File"));
+
+    QFormLayout *layout = new QFormLayout(&dialog);
+
+    /* file or directory (latest file) */
+    QLineEdit *pathEdit = new QLineEdit(*path, &dialog);
+    QPushButton *fileButton = new QPushButton(tr("File..."), &dialog);
+    QPushButton *directoryButton = new QPushButton(tr("Directory..."), &dialog);
+
+    QHBoxLayout *pathLayout = new QHBoxLayout;
+    pathLayout->addWidget(pathEdit);
+    pathLayout->addWidget(fileButton);
+    pathLayout->addWidget(directoryButton);
+
+    layout->addRow(tr("File/Directory"), pathLayout);
+
+    connect(fileButton, &QPushButton::clicked, [&]() {
+        const QString fileName = QFileDialog::getOpenFileName(&dialog, tr("Watch growing ASCII File..."),
+                                                              pathEdit->text(),
+                                                              tr("Lifetime Data (*.dat *.txt *.log)"));
+
+        if ( !fileName.isEmpty() )
+            pathEdit->setText(fileName);
+    });
+
+    connect(directoryButton, &QPushButton::clicked, [&]() {
+        const QString dirName = QFileDialog::getExistingDirectory(&dialog, tr("Watch the latest ASCII File of..."), pathEdit->text());
+
+        if ( !dirName.isEmpty() )
+            pathEdit->setText(dirName);
+    });
+
+    QSpinBox *binFacBox = new QSpinBox(&dialog);
+    binFacBox->setRange(1, 100);
+    binFacBox->setValue(m_watchBinFactor);
+
+    layout->addRow(tr("Bin-Factor"), binFacBox);
+
+    QSpinBox *refitIntervalBox = new QSpinBox(&dialog);
+    refitIntervalBox->setRange(0, 3600);
+    refitIntervalBox->setValue(m_watchRefitInterval);
+
+    layout->addRow(tr("Refit Interval [s] (0: no refit)"), refitIntervalBox);
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok|QDialogButtonBox::Cancel, &dialog);
+    layout->addRow(buttonBox);
+
+    connect(buttonBox, SIGNAL(accepted()), &dialog, SLOT(accept()));
+    connect(buttonBox, SIGNAL(rejected()), &dialog, SLOT(reject()));
+
+    if ( dialog.exec() != QDialog::Accepted )
+        return false;
+
+    if ( pathEdit->text().isEmpty() )
+        return false;
+
+    *path = pathEdit->text();
+
+    m_watchBinFactor = binFacBox->value();
+    m_watchRefitInterval = refitIntervalBox->value();
+
+    return true;
+}
+
+void DFastLTFitDlg::watchedSpectrumChanged(int firstChangedChannel)
+{
+    /* the data set is read by the running fit (GUI disabled): applied when the fit has finished */
+    if ( !isEnabled() )
     {
-        if ( type == AccessType::FromOneFile )
-        {
-            DMSGBOX("Sorry, an error occurred while importing lifetime-data.")
-        }
+        m_watchDeferredChannel = (m_watchDeferredChannel < 0)?firstChangedChannel:qMin(m_watchDeferredChannel, firstChangedChannel);
+        return;
     }
 
-    PALSProjectManager::sharedInstance()->setASCIIDataName(fileName);
+    applyWatchedSpectrum(firstChangedChannel);
+    showWatchStatus();
+}
 
-    updateWindowTitle();
+void DFastLTFitDlg::applyWatchedSpectrum(int firstChangedChannel)
+{
+    const PALSASCIIData data = m_spectrumWatcher->data();
+
+    m_watchRefitPending = true;
+
+    /* first spectrum: imported as from a single ASCII file */
+    if ( !m_watchInitialized )
+    {
+        m_watchInitialized = true;
+        m_watchMaxChannel = data.maxChannel;
+        m_watchYMax = 1.3*((double)data.maxCounts);
+
+        setImportedData(data, m_spectrumWatcher->binFactor());
+
+        PALSProjectManager::sharedInstance()->setASCIIDataName(m_spectrumWatcher->fileName());
+
+        updateWindowTitle();
+        return;
+    }
+
+    PALSProjectManager::sharedInstance()->getDataStructure()->getDataSetPtr()->setLifeTimeData(data.dataSet);
+
+    /* appended channels: the fit range is kept */
+    if ( data.maxChannel != m_watchMaxChannel )
+    {
+        m_watchMaxChannel = data.maxChannel;
+
+        PALSProjectManager::sharedInstance()->setChannelRanges(data.minChannel, data.maxChannel);
+
+        const int startChannel = qMax(data.minChannel, (int)PALSProjectManager::sharedInstance()->getDataStructure()->getFitSetPtr()->getStartChannel());
+        const int stopChannel = qMin(data.maxChannel, (int)PALSProjectManager::sharedInstance()->getDataStructure()->getFitSetPtr()->getStopChannel());
+
+        ui->widget->setFitRangeLimits(data.minChannel, data.maxChannel);
+        ui->widget->setFitRange(startChannel, stopChannel);
+
+        m_plotWindow->setXRange(data.minChannel, data.maxChannel);
+    }
+
+    /* only the changed channels of the raw data trace are drawn again */
+    m_plotWindow->updateRawData(data.dataSet, firstChangedChannel);
+
+    if ( data.maxCounts > m_watchYMax )
+    {
+        m_watchYMax = 1.3*((double)data.maxCounts);
+        m_plotWindow->setYRangeData(1, m_watchYMax);
+    }
+}
+
+void DFastLTFitDlg::watchedFileChanged(const QString &fileName)
+{
+    DUNUSED_PARAM(fileName);
+
+    /* directory: a new acquisition is imported from scratch */
+    m_watchInitialized = false;
+    m_watchRefitPending = false;
+    m_watchDeferredChannel = -1;
+    m_watchMaxChannel = -1;
+    m_watchYMax = 0.0;
+
+    m_fitEngine->resetWarmStart();
+
+    showWatchStatus();
+}
+
+void DFastLTFitDlg::watchImportFailed(int status)
+{
+    if ( status == asciiImportStatus::negativeCounts_ImportStatus )
+        ui->statusBar->showMessage("Watching: " % m_spectrumWatcher->fileName() % " - values lower than 0 detected.");
+    else
+        ui->statusBar->showMessage("Watching: " % m_spectrumWatcher->fileName() % " - an error occurred while importing lifetime-data.");
+}
+
+void DFastLTFitDlg::watchRefit()
+{
+    if ( !m_watchInitialized || !m_watchRefitPending )
+        return;
+
+    /* a running fit is not interrupted: the spectrum is fitted on the next interval */
+    if ( !isEnabled() || m_fitEngineThread->isRunning() || m_batchFitEngineThread->isRunning() )
+        return;
+
+    if ( PALSProjectManager::sharedInstance()->getDataStructure()->getDataSetPtr()->getLifeTimeData().isEmpty() )
+        return;
+
+    m_watchRefitPending = false;
+    m_watchRefitRunning = true;
+
+    enableGUI(false);
+
+    /* warm start: a few iterations from the previous refit instead of a cold start */
+    m_fitEngine->setWarmStart(true);
+
+    m_fitEngine->init(PALSProjectManager::sharedInstance()->getDataStructure());
+    m_fitEngine->setThreadCount(PALSProjectSettingsManager::sharedInstance()->getFitThreadCount());
+    m_fitEngine->setMultiStartCount(PALSProjectSettingsManager::sharedInstance()->getFitMultiStartCount());
+    m_fitEngineThread->start();
+}
+
+void DFastLTFitDlg::showWatchStatus()
+{
+    if ( !m_spectrumWatcher->isWatching() )
+        return;
+
+    const QString fileName = m_spectrumWatcher->fileName().isEmpty()?m_spectrumWatcher->path():QFileInfo(m_spectrumWatcher->fileName()).fileName();
+
+    QString status = "Watching: " % fileName % " (" % QVariant(m_spectrumWatcher->data().dataSet.size()).toString() % " channels, " % QVariant((qint64)m_spectrumWatcher->data().dataSet.integral()).toString() % " counts)";
+
+    /* lifetimes of the last refit */
+    if ( m_watchRefitCount > 0 )
+    {
+        PALSFitSet *fitSet = PALSProjectManager::sharedInstance()->getDataStructure()->getFitSetPtr();
+
+        status = status % " - Refit #" % QVariant(m_watchRefitCount).toString() % ":";
+
+        for ( int i = 0 ; i < fitSet->getLifeTimeParamPtr()->getSize() ; i += 2 )
+            status = status % " " % QString(fitSet->getLifeTimeParamPtr()->getParameterAt(i)->getAlias()) % " = " % QString::number(fitSet->getLifeTimeParamPtr()->getParameterAt(i)->getFitValue(), 'f', 1) % " ps";
+
+        status = status % ", chi-square = " % QString::number(fitSet->getChiSquareAfterFit(), 'f', 3) % " (" % QVariant(fitSet->getNeededIterations()).toString() % " iterations)";
+    }
+
+    ui->statusBar->showMessage(status);
 }
 
 void DFastLTFitDlg::runFit()
@@ -851,7 +1139,12 @@ void DFastLTFitDlg::runFit()
 
     enableGUI(false);
 
+    /* start values of the fit set */
+    m_fitEngine->setWarmStart(false);
+
     m_fitEngine->init(PALSProjectManager::sharedInstance()->getDataStructure());
+    m_fitEngine->setThreadCount(PALSProjectSettingsManager::sharedInstance()->getFitThreadCount());
+    m_fitEngine->setMultiStartCount(PALSProjectSettingsManager::sharedInstance()->getFitMultiStartCount());
     m_fitEngineThread->start();
 }
 
@@ -867,9 +1160,103 @@ void DFastLTFitDlg::fitHasFinished()
     m_plotWindow->clearResidualData();
     m_plotWindow->addResidualData(PALSProjectManager::sharedInstance()->getDataStructure()->getDataSetPtr()->getResiduals());
 
-    m_resultWindow->addResultTabFromLastFit();
+    /* watch mode: the refits are shown in the status bar (no result tab per refit) */
+    if ( m_watchRefitRunning )
+    {
+        m_watchRefitRunning = false;
+        m_watchRefitCount ++;
+    }
+    else
+        m_resultWindow->addResultTabFromLastFit();
+
+    enableGUI(true);
+
+    if ( m_spectrumWatcher->isWatching() )
+    {
+        if ( m_watchDeferredChannel >= 0 )
+        {
+            const int firstChangedChannel = m_watchDeferredChannel;
+            m_watchDeferredChannel = -1;
+
+            applyWatchedSpectrum(firstChangedChannel);
+        }
+
+        showWatchStatus();
+    }
+}
+
+void DFastLTFitDlg::runBatchFit()
+{
+    const QStringList fileNames = QFileDialog::getOpenFileNames(this, tr("Select the lifetime spectra (ASCII) of the batch..."),
+                                                                PALSProjectSettingsManager::sharedInstance()->getLastChosenPath(),
+                                                                tr("Lifetime Data (*.dat *.txt *.log)"));
+
+    if ( fileNames.isEmpty() )
+        return;
+
+    const QString resultFileName = QFileDialog::getSaveFileName(this, tr("Save the batch results as..."),
+                                                                QFileInfo(fileNames.first()).absoluteDir().absolutePath(),
+                                                                tr("Batch Results (*.csv)"));
+
+    if ( resultFileName.isEmpty() )
+        return;
+
+    PALSProjectSettingsManager::sharedInstance()->setLastChosenPath(QFileInfo(fileNames.first()).absoluteDir().absolutePath());
+
+    const int binFac = PALSProjectManager::sharedInstance()->getDataStructure()->getDataSetPtr()->getBinFactor();
+
+    /* the fit set of the current project is the template of all fits */
+    m_batchFitEngine->setTemplate(PALSProjectManager::sharedInstance()->getDataStructure()->getFitSetPtr());
+    m_batchFitEngine->clearSpectra();
+
+    for ( const QString& fileName : fileNames )
+        m_batchFitEngine->addSpectrum(fileName, binFac);
+
+    m_batchFitEngine->setResultFileName(resultFileName);
+    m_batchFitEngine->setThreadCount(PALSProjectSettingsManager::sharedInstance()->getFitThreadCount());
+    m_batchFitEngine->setMultiStartCount(PALSProjectSettingsManager::sharedInstance()->getFitMultiStartCount());
+
+    enableGUI(false);
+
+    ui->statusBar->showMessage("Batch-Fit: 0/" % QVariant(fileNames.size()).toString());
+
+    m_batchFitEngineThread->start();
+}
+
+void DFastLTFitDlg::batchFitProgress(int finishedFits, int fitCnt, double fitsPerSecond)
+{
+    ui->statusBar->showMessage("Batch-Fit: " % QVariant(finishedFits).toString() % "/" % QVariant(fitCnt).toString() % " (" % QString::number(fitsPerSecond, 'f', 2) % " fits/s)");
+}
+
+void DFastLTFitDlg::batchFitHasFinished()
+{
+    m_batchFitEngineThread->exit(0);
+    m_batchFitEngineThread->wait();
+
+    ui->statusBar->clearMessage();
 
     enableGUI(true);
+
+    if ( m_spectrumWatcher->isWatching() && m_watchDeferredChannel >= 0 )
+    {
+        const int firstChangedChannel = m_watchDeferredChannel;
+        m_watchDeferredChannel = -1;
+
+        applyWatchedSpectrum(firstChangedChannel);
+        showWatchStatus();
+    }
+
+    const QList<PALSBatchFitResult> results = m_batchFitEngine->results();
+
+    int failedFits = 0;
+
+    for ( const PALSBatchFitResult& result : results )
+    {
+        if ( result.status <= 0 ) /* import/mpfit error or canceled */
+            failedFits ++;
+    }
+
+    DMSGBOX("<nobr>Batch-Fit finished: <b>" % QVariant(results.size()-failedFits).toString() % "/" % QVariant(results.size()).toString() % "</b> spectra fitted successfully (" % QString::number(m_batchFitEngine->throughput(), 'f', 2) % " fits/s).</nobr>");
 }
 
 void DFastLTFitDlg::updateWindowTitle()
@@ -970,58 +1357,19 @@ void DFastLTFitDlg::instantPreview()
 
     double channelResolution = dataStructure->getFitSetPtr()->getChannelResolution();
 
-    double startChannel = dataStructure->getFitSetPtr()->getStartChannel();
-    double stopChannel = dataStructure->getFitSetPtr()->getStopChannel();
-    double peakChannel = 0;
-    double countsInPeak = -(double)INT_MAX;
-
-     int startChannelIndex = 0;
-     int stopChannelIndex = 0;
-     int peakChannelIndex = 0;
-
-     int channelCnt = 0;
-     int dataCntInRange = (stopChannel-startChannel+1);
-
-     double *x = new double[dataCntInRange];
-     double *y = new double[dataCntInRange];
-     double *ey = new double[dataCntInRange];
-
-     int inRangeCnt = 0;
-     int integralCounts = 0;
-     int tZero = 0;
-
-     for ( QPointF p : dataStructure->getDataSetPtr()->getLifeTimeData() ) {
-         if ( ((int)p.x()) >= ((int)startChannel) && ((int)p.x()) <= ((int)stopChannel) ) {
-             x[inRangeCnt] = p.x();
-             y[inRangeCnt] = p.y();
-
-             /* calculate error (weighting) (statistical weighting) */
-             ey[inRangeCnt] = 1.0/sqrt(p.y() + 1.0); //prevent zero division
-
-             integralCounts += (int)p.y();
-
-             if ( ((int)p.x()) == ((int)startChannel) )
-                 startChannelIndex = channelCnt;
-
-             if ( ((int)p.x()) == ((int)stopChannel) )
-                 stopChannelIndex = channelCnt;
+    /* snapshot of the start values: the model curve is evaluated by the preview engine (latest request wins) */
+    PALSPreviewRequest request;
 
-             if ( ((int)p.y()) > ((int)countsInPeak) ) {
-                 countsInPeak = p.y();
-                 peakChannel = p.x();
-                 peakChannelIndex = channelCnt;
-                 tZero = peakChannel;
-             }
+    request.generation = ++ m_previewGeneration;
+    request.dataSet = dataStructure->getDataSetPtr()->getLifeTimeData();
+    request.channelResolution = channelResolution;
+    request.startChannel = dataStructure->getFitSetPtr()->getStartChannel();
+    request.stopChannel = dataStructure->getFitSetPtr()->getStopChannel();
+    request.componentCnt = dataStructure->getFitSetPtr()->getComponentsCount()/2;
+    request.gaussianCnt = dataStructure->getFitSetPtr()->getDeviceResolutionParamPtr()->getSize()/3;
+    request.params.resize(paramCnt);
 
-             inRangeCnt ++;
-         }
-
-         channelCnt ++;
-     }
-
-     tZero -= startChannel;
-
-    double *params = new double[paramCnt]; /* following order: source => sample => gaussian => bkgrd */
+    double *params = request.params.data(); /* following order: source => sample => gaussian => bkgrd */
 
     int i = 0;
     for ( i = 0 ; i < dataStructure->getFitSetPtr()->getSourceParamPtr()->getSize() ; i+=2 ) {
@@ -1069,80 +1417,29 @@ void DFastLTFitDlg::instantPreview()
 
     params[bkgrdIndex] = bkgrd->getStartValue();
 
-    countsInPeak -= bkgrd->getStartValue();
-
-    const double bkgrdVal = params[bkgrdIndex];
-
-
-    QList<QPointF> fitPlotSet;
-
-    double residuals = 0.0;
-    const int reducedCntInRange = (dataCntInRange - 1);
-    const int reducedDevCount = (paramCnt - cntGaussian - 1);
-    const int reducedParamCount = (paramCnt - 1);
-    const double integralCountsWithoutBkgrd = (double)integralCounts-(double)dataCntInRange*bkgrdVal;
-
-    for ( int i = 0 ; i < reducedCntInRange ; ++ i ) {
-        double f = 0.0;
-
-        x[i] -= startChannel;
-        const double x_plus_1 = x[i+1]-startChannel;
-
-        for ( int device = reducedDevCount ; device < reducedParamCount ; device += 3 ) {
-            const double gaussianSigmaVal = params[device]/(2*sqrt(log(2))); /* transform FWHM to 1-sigma uncertainty */
-            const double gaussianMuVal = params[device+1];
-
-            const double gaussianIntensity = params[device+2]; /* IRF contribution */
-
-            double valF = 0.0;
-
-            /* Kirkegaard and Eldrup (1972) */
-            for ( int param = 0 ; param <  reducedDevCount ; param += 2 ) { /* 1st param[0] = tau; 2nd param[1] = Intensity */
-                const double yji = exp(-(x[i]-gaussianMuVal-(gaussianSigmaVal*gaussianSigmaVal)/(4*params[param]))/params[param])*(1-erf((0.5*gaussianSigmaVal/params[param])-(x[i]-gaussianMuVal)/gaussianSigmaVal));
-                const double yji_plus_1 = exp(-(x_plus_1-gaussianMuVal-(gaussianSigmaVal*gaussianSigmaVal)/(4*params[param]))/params[param])*(1-erf((0.5*gaussianSigmaVal/params[param])-(x_plus_1-gaussianMuVal)/gaussianSigmaVal));
-
-                valF += 0.5*params[param+1]*(yji-yji_plus_1-erf((x[i]-gaussianMuVal)/gaussianSigmaVal)+erf((x_plus_1-gaussianMuVal)/gaussianSigmaVal));
-            }
-
-            valF *= gaussianIntensity;
-            f += valF;
-        }
-
-        x[i] += startChannel;
-
-        f *= integralCountsWithoutBkgrd;
-        f += (double)bkgrdVal;
-
-        residuals += (y[i]-f)*(y[i]-f)*ey[i]*ey[i];
-
-        fitPlotSet.append(QPointF(x[i], f));
-    }
+    m_previewEngine->requestPreview(request);
+}
 
-    /*approximated reduced chi-square (number of free parameters is not taken into account) */
-    if ( dataCntInRange == 0 )
-        residuals = -1;
-    else
-        residuals /= ((double)dataCntInRange);
+void DFastLTFitDlg::previewReady(const PALSPreviewResult &result)
+{
+    /* stale: a newer request is pending */
+    if ( result.generation != m_previewGeneration )
+        return;
 
     m_plotWindow->clearPreviewData();
-    m_plotWindow->addPreviewData(fitPlotSet);
+    m_plotWindow->addPreviewData(result.dataSet);
     m_plotWindow->updateBkgrdData();
 
-    m_plotWindow->setFitRange(startChannel, stopChannel);
+    m_plotWindow->setFitRange(result.startChannel, result.stopChannel);
 
-    if ( residuals == -1 ) {
+    if ( result.chiSquare == -1 ) {
         m_integralCountInROI->setText("");
         m_chiSquareLabel->setText("");
     }
     else {
-        m_integralCountInROI->setText("estimated t<sub>0</sub>: <b>" % QVariant(tZero*channelResolution).toString() % "ps</b> Integral Cnts. ROI [" % QVariant(startChannel).toString() % ":" % QVariant(stopChannel).toString() % "]: <b>" % QVariant(integralCounts).toString() % "</b>");
-        m_chiSquareLabel->setText("approx. &#967;<sub>&#957;</sub><sup>2</sup> ( @ start ): <b>" % QString::number(residuals, 'g', 3) % "</b>"); //appr. reduced chi-square
+        m_integralCountInROI->setText("estimated t<sub>0</sub>: <b>" % QVariant(result.tZero).toString() % "ps</b> Integral Cnts. ROI [" % QVariant(result.startChannel).toString() % ":" % QVariant(result.stopChannel).toString() % "]: <b>" % QVariant(result.integralCounts).toString() % "</b>");
+        m_chiSquareLabel->setText("approx. &#967;<sub>&#957;</sub><sup>2</sup> ( @ start ): <b>" % QString::number(result.chiSquare, 'g', 3) % "</b>"); //appr. reduced chi-square
     }
-
-    delete [] x;
-    delete [] y;
-    delete [] ey;
-    delete [] params;
 }
 
 void DFastLTFitDlg::changePlotWindowVisibility(bool visible)
@@ -1236,7 +1533,7 @@ void DFastLTFitDlg::enableGUI(bool enable)
     }
 }
 
-void DFastLTFitDlg::printToFile(const QString &fileName, const QList<QPointF> &vec)
+void DFastLTFitDlg::printToFile(const QString &fileName, const PALSSpectrum &vec)
 {
     QFile file(fileName + ".in");
 
@@ -1247,7 +1544,7 @@ void DFastLTFitDlg::printToFile(const QString &fileName, const QList<QPointF> &v
             QString text("       " + QVariant(i).toString() + "        \n\r");
 
             for (int u = 0 ; u < 8 ; ++ u) {
-                text.append(QVariant(vec.at((i) + u).y()).toString() + "        \n\r");
+                text.append(QVariant(vec.countsAt((i) + u)).toString() + "        \n\r");
             }
 
             stream << text << endl;
@@ -34,12 +34,22 @@
 #include <QInputDialog>
 #include <QLabel>
 #include <QSpinBox>
+#include <QDoubleSpinBox>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QFormLayout>
 #include <QAction>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QTimer>
 #include <QDebug>
 
 #include "Settings/settings.h"
 #include "Settings/projectmanager.h"
 #include "Settings/projectsettingsmanager.h"
+#include "Settings/asciidataimport.h"
+#include "Settings/listmodeimport.h"
+#include "Settings/spectrumwatcher.h"
 
 #include "ltplotdlg.h"
 #include "ltresultdlg.h"
@@ -47,6 +57,8 @@
 #include "ltlicensetextbox.h"
 
 #include "Fit/lifetimedecayfit.h"
+#include "Fit/lifetimedecaybatchfit.h"
+#include "Fit/lifetimedecaypreview.h"
 
 #include "ltdefines.h"
 
@@ -80,8 +92,13 @@ public slots:
     void newProject();
 
     void importASCII(const AccessType& type = AccessType::FromOneFile, const QString &fileNameFromSeq = "");
+    void importListMode();
+
+    void watchASCII();
+    void stopWatching();
 
     void runFit();
+    void runBatchFit();
     void instantPreview();
 
     void changePlotWindowVisibility(bool visible);
@@ -101,10 +118,18 @@ public slots:
 
     void enableGUI(bool enable);
 
-    void printToFile(const QString& fileName, const QList<QPointF>& vec);
+    void printToFile(const QString& fileName, const PALSSpectrum& vec);
 
 private slots:
     void fitHasFinished();
+    void batchFitProgress(int finishedFits, int fitCnt, double fitsPerSecond);
+    void batchFitHasFinished();
+    void previewReady(const PALSPreviewResult& result);
+
+    void watchedSpectrumChanged(int firstChangedChannel);
+    void watchedFileChanged(const QString& fileName);
+    void watchImportFailed(int status);
+    void watchRefit();
     void updateWindowTitle();
 
     void openProjectFromPath(const QString& fileName);
@@ -119,8 +144,17 @@ private slots:
     void showLGPL();
     void showUsedGPL();
 
-public:
-    static QStringList autoDetectDelimiter(const QString& row);
+private:
+    /* spectrum of an import (ASCII or list-mode) into the current data structure */
+    void setImportedData(const PALSASCIIData& data, int binFac);
+
+    bool editListModeSettings(PALSListModeSettings *settings);
+
+    /* watch mode: path (file or directory), bin-factor and refit interval */
+    bool editWatchSettings(QString *path);
+    /* spectrum of the watcher into the current data structure (channels from firstChangedChannel on) */
+    void applyWatchedSpectrum(int firstChangedChannel);
+    void showWatchStatus();
 
 private:
     Ui::DFastLTFitDlg *ui;
@@ -136,6 +170,28 @@ private:
     LifeTimeDecayFitEngine *m_fitEngine;
     QThread *m_fitEngineThread;
 
+    LifeTimeDecayBatchFitEngine *m_batchFitEngine;
+    QThread *m_batchFitEngineThread;
+
+    LifeTimeDecayPreviewEngine *m_previewEngine;
+    QThread *m_previewEngineThread;
+    int m_previewGeneration;
+
+    PALSListModeSettings m_listModeSettings; /* of the last list-mode import */
+
+    /* watch mode: growing ASCII spectrum, warm-started refits on a fixed interval */
+    PALSSpectrumWatcher *m_spectrumWatcher;
+    QTimer *m_watchRefitTimer;
+    int m_watchBinFactor;
+    int m_watchRefitInterval; /* [s] 0: no refit */
+    bool m_watchInitialized; /* first spectrum imported */
+    bool m_watchRefitPending; /* spectrum changed since the last refit */
+    bool m_watchRefitRunning;
+    int m_watchRefitCount;
+    int m_watchDeferredChannel; /* changed while a fit was running (-1: none) */
+    int m_watchMaxChannel;
+    double m_watchYMax;
+
     QLabel *m_chiSquareLabel;
     QLabel *m_integralCountInROI;
 
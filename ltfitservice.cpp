@@ -0,0 +1,832 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+
+#include "ltfitservice.h"
+#include "ltfitcli.h"
+
+DFastLTFitService::DFastLTFitService(const PALSFitSet *defaultTemplate, int threadCnt, int multiStartCnt, int maxQueue) :
+    QObject(),
+    m_defaultTemplate(defaultTemplate),
+    m_loader(nullptr),
+    m_pool(nullptr),
+    m_multiStartCnt(qMax(1, multiStartCnt)),
+    m_nextJobId(1),
+    m_queuedJobs(0),
+    m_runningJobs(0),
+    m_acceptedJobs(0),
+    m_completedJobs(0)
+{
+    m_loader = new FitThreadPool(1);
+    m_pool = new FitThreadPool(qMax(0, threadCnt));
+    m_threadCnt = m_pool->threadCount();
+
+    m_maxQueue = (maxQueue > 0)?maxQueue:(SERVICE_QUEUE_FACTOR*m_threadCnt);
+
+    m_uptime.start();
+
+    connect(&m_tcpServer, SIGNAL(newConnection()), this, SLOT(newTcpConnection()));
+    connect(&m_localServer, SIGNAL(newConnection()), this, SLOT(newLocalConnection()));
+}
+
+DFastLTFitService::~DFastLTFitService()
+{
+    m_loader->waitForDone();
+    DDELETE_SAFETY(m_loader);
+
+    m_pool->waitForDone();
+    DDELETE_SAFETY(m_pool);
+
+    for ( DFastLTFitServiceJob *job : m_jobs ) {
+        DDELETE_SAFETY(job->project);
+        delete job;
+    }
+
+    qDeleteAll(m_templates);
+    qDeleteAll(m_loadedTemplates);
+    qDeleteAll(m_workspaces);
+}
+
+bool DFastLTFitService::listen(quint16 port)
+{
+    return m_tcpServer.listen(QHostAddress::LocalHost, port); /* not reachable from other hosts */
+}
+
+bool DFastLTFitService::listenLocal(const QString &name)
+{
+    QLocalServer::removeServer(name); /* stale socket file of a crashed service */
+
+    return m_localServer.listen(name);
+}
+
+QString DFastLTFitService::errorString() const
+{
+    if ( m_localServer.serverError() != QAbstractSocket::UnknownSocketError )
+        return m_localServer.errorString();
+
+    return m_tcpServer.errorString();
+}
+
+quint16 DFastLTFitService::serverPort() const
+{
+    return m_tcpServer.isListening()?m_tcpServer.serverPort():0;
+}
+
+int DFastLTFitService::queueDepth() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_queuedJobs + m_runningJobs;
+}
+
+void DFastLTFitService::newTcpConnection()
+{
+    while ( m_tcpServer.hasPendingConnections() )
+        addConnection(m_tcpServer.nextPendingConnection());
+}
+
+void DFastLTFitService::newLocalConnection()
+{
+    while ( m_localServer.hasPendingConnections() )
+        addConnection(m_localServer.nextPendingConnection());
+}
+
+void DFastLTFitService::addConnection(QIODevice *connection)
+{
+    if ( !connection )
+        return;
+
+    /* a bounded read buffer: the socket stops reading (and the client blocks) while a request of this connection is held */
+    if ( QAbstractSocket *socket = qobject_cast<QAbstractSocket*>(connection) )
+        socket->setReadBufferSize(SERVICE_MAX_REQUEST_SIZE);
+    else if ( QLocalSocket *socket = qobject_cast<QLocalSocket*>(connection) )
+        socket->setReadBufferSize(SERVICE_MAX_REQUEST_SIZE);
+
+    m_connections.append(connection);
+
+    connect(connection, SIGNAL(readyRead()), this, SLOT(readRequests()));
+    connect(connection, SIGNAL(disconnected()), this, SLOT(connectionClosed()));
+
+#ifdef __FITSERVICE_DEBUG
+    qDebug() << "fit-service: connection opened (" << m_connections.size() << " connections)";
+#endif
+
+    processConnection(connection); /* data might have arrived before the signals were connected */
+}
+
+void DFastLTFitService::readRequests()
+{
+    QIODevice *connection = qobject_cast<QIODevice*>(sender());
+
+    if ( connection )
+        processConnection(connection);
+}
+
+void DFastLTFitService::connectionClosed()
+{
+    QIODevice *connection = qobject_cast<QIODevice*>(sender());
+
+    if ( !connection )
+        return;
+
+    m_connections.removeAll(connection);
+    m_heldRequests.remove(connection);
+    m_heldConnections.removeAll(connection);
+
+    /* the jobs of the connection are finished, their results are dropped (see DFastLTFitServiceJob::connection) */
+    connection->deleteLater();
+
+#ifdef __FITSERVICE_DEBUG
+    qDebug() << "fit-service: connection closed (" << m_connections.size() << " connections)";
+#endif
+}
+
+void DFastLTFitService::processConnection(QIODevice *connection)
+{
+    if ( m_heldRequests.contains(connection) )
+        return;
+
+    while ( connection->canReadLine() ) {
+        const QByteArray line = connection->readLine().trimmed();
+
+        if ( line.isEmpty() )
+            continue;
+
+        QJsonParseError parseError;
+        const QJsonDocument document = QJsonDocument::fromJson(line, &parseError);
+
+        if ( parseError.error != QJsonParseError::NoError
+             || !document.isObject() ) {
+            sendError(connection, QJsonValue(), "invalid request: " % ((parseError.error != QJsonParseError::NoError)?parseError.errorString():QString("JSON object expected")));
+            continue;
+        }
+
+        if ( !processRequest(connection, document.object()) ) {
+            m_heldRequests.insert(connection, document.object());
+            m_heldConnections.append(connection);
+
+            return;
+        }
+    }
+
+    if ( connection->bytesAvailable() >= SERVICE_MAX_REQUEST_SIZE ) {
+        sendError(connection, QJsonValue(), "request too large");
+        connection->close();
+    }
+}
+
+bool DFastLTFitService::processRequest(QIODevice *connection, const QJsonObject &request)
+{
+    const QString type = request.value("type").toString();
+
+    if ( type == "status" ) {
+        QJsonObject response = statusObject();
+
+        if ( request.contains("id") )
+            response.insert("id", request.value("id"));
+
+        send(connection, response);
+        return true;
+    }
+
+    if ( type == "fit" ) {
+        /* held requests go first */
+        if ( queueDepth() >= m_maxQueue
+             || !m_heldConnections.isEmpty() )
+            return false;
+
+        submitFit(connection, request);
+        return true;
+    }
+
+    sendError(connection, request.value("id"), "unknown request type: " % type);
+
+    return true;
+}
+
+bool DFastLTFitService::submitFit(QIODevice *connection, const QJsonObject &request)
+{
+    const QJsonValue clientId = request.value("id");
+
+    QString error;
+
+    const QString templateName = request.value("template").toString();
+    const PALSFitSet *fitSet = m_defaultTemplate;
+
+    if ( !templateName.isEmpty() ) {
+        const QString path = QFileInfo(templateName).absoluteFilePath();
+
+        if ( !m_templates.contains(path) ) {
+            loadTemplate(path, connection, request);
+            return true;
+        }
+
+        fitSet = m_templates.value(path)->getDataStructureAt(0)->getFitSetPtr();
+    }
+
+    if ( !fitSet ) {
+        sendError(connection, clientId, "no default template");
+        return false;
+    }
+
+    PALSBatchSpectrum spectrum;
+
+    if ( !readSpectrum(request, &spectrum, &error) ) {
+        sendError(connection, clientId, error);
+        return false;
+    }
+
+    /* private copy of the template incl. the overrides of the request */
+    PALSProject *project = new PALSProject;
+    PALSDataStructure *dataStructure = new PALSDataStructure(project);
+
+    LifeTimeDecayBatchFitEngine::copyFitSet(fitSet, dataStructure->getFitSetPtr());
+
+    if ( !applyOverrides(request, dataStructure->getFitSetPtr(), &error) ) {
+        DDELETE_SAFETY(project);
+
+        sendError(connection, clientId, error);
+        return false;
+    }
+
+    int multiStartCnt = m_multiStartCnt;
+
+    if ( request.contains("multi_start") ) {
+        multiStartCnt = request.value("multi_start").toInt(0);
+
+        if ( multiStartCnt < 1 ) {
+            DDELETE_SAFETY(project);
+
+            sendError(connection, clientId, "invalid multi_start");
+            return false;
+        }
+    }
+
+    DFastLTFitServiceJob *job = new DFastLTFitServiceJob;
+
+    job->id = m_nextJobId ++;
+    job->clientId = clientId;
+    job->connection = connection;
+    job->spectrum = spectrum;
+    job->project = project;
+    job->names = LifeTimeDecayBatchFitEngine::parameterNames(dataStructure->getFitSetPtr());
+    job->multiStartCnt = qMin(multiStartCnt, __MAX_NUMBER_OF_MULTI_STARTS);
+
+    if ( job->spectrum.name.isEmpty() )
+        job->spectrum.name = "job_" + QVariant(job->id).toString();
+
+    m_jobs.insert(job->id, job);
+
+    m_mutex.lock();
+    m_queuedJobs ++;
+    const int depth = m_queuedJobs + m_runningJobs;
+    m_mutex.unlock();
+
+    m_acceptedJobs ++;
+
+    QJsonObject response;
+
+    response.insert("type", QString("accepted"));
+    response.insert("job", job->id);
+    response.insert("id", clientId);
+    response.insert("queue_depth", depth);
+
+    send(connection, response);
+
+    m_pool->start([this, job] { runJob(job); });
+
+    return true;
+}
+
+void DFastLTFitService::runJob(DFastLTFitServiceJob *job)
+{
+    m_mutex.lock();
+    m_queuedJobs --;
+    m_runningJobs ++;
+    m_mutex.unlock();
+
+    FitWorkspace *workspace = acquireWorkspace();
+
+    job->result = LifeTimeDecayBatchFitEngine::fitSpectrum(job->project->getDataStructureAt(0)->getFitSetPtr(), job->spectrum, job->multiStartCnt, workspace);
+    job->result.index = job->id;
+
+    releaseWorkspace(workspace);
+
+    m_mutex.lock();
+    m_runningJobs --;
+    m_mutex.unlock();
+
+    /* the result is sent from the thread of the service (sockets) */
+    QMetaObject::invokeMethod(this, "jobFinished", Qt::QueuedConnection, Q_ARG(int, job->id));
+}
+
+void DFastLTFitService::jobFinished(int jobId)
+{
+    DFastLTFitServiceJob *job = m_jobs.take(jobId);
+
+    if ( !job )
+        return;
+
+    m_completedJobs ++;
+
+    const qint64 now = m_uptime.elapsed();
+
+    m_completionTimes.append(now);
+
+    while ( !m_completionTimes.isEmpty()
+            && m_completionTimes.first() < now - SERVICE_RATE_WINDOW )
+        m_completionTimes.removeFirst();
+
+#ifdef __FITSERVICE_DEBUG
+    qDebug() << "fit-service: job " << job->id << " finished (" << job->result.fitTime << " s)";
+#endif
+
+    if ( job->connection ) {
+        QJsonObject response = DFastLTFitCLI::jsonResultObject(job->names, job->result);
+
+        response.insert("type", QString("result"));
+        response.insert("job", job->id);
+        response.insert("id", job->clientId);
+        response.insert("queue_depth", queueDepth());
+
+        send(job->connection, response);
+    }
+
+    DDELETE_SAFETY(job->project);
+    delete job;
+
+    admitHeldRequests();
+}
+
+void DFastLTFitService::admitHeldRequests()
+{
+    /* in the order of arrival */
+    while ( !m_heldConnections.isEmpty()
+            && queueDepth() < m_maxQueue ) {
+        QIODevice *connection = m_heldConnections.takeFirst();
+        const QJsonObject request = m_heldRequests.take(connection);
+
+        submitFit(connection, request);
+        processConnection(connection);
+    }
+}
+
+void DFastLTFitService::loadTemplate(const QString &path, QIODevice *connection, const QJsonObject &request)
+{
+    DFastLTFitServiceRequest waitingRequest;
+
+    waitingRequest.connection = connection;
+    waitingRequest.request = request;
+
+    /* the waiting requests take their place in the queue */
+    m_mutex.lock();
+    m_queuedJobs ++;
+    m_mutex.unlock();
+
+    if ( m_loadingTemplates.contains(path) ) {
+        m_loadingTemplates[path].append(waitingRequest);
+        return;
+    }
+
+    m_loadingTemplates.insert(path, QList<DFastLTFitServiceRequest>() << waitingRequest);
+
+#ifdef __FITSERVICE_DEBUG
+    qDebug() << "fit-service: loading template " << path;
+#endif
+
+    /* off the thread of the service: the connections are served during the load */
+    m_loader->start([this, path] {
+        PALSProject *project = new PALSProject;
+
+        if ( !project->load(path)
+             || !project->getSize() )
+            DDELETE_SAFETY(project);
+
+        m_mutex.lock();
+        m_loadedTemplates.insert(path, project);
+        m_mutex.unlock();
+
+        QMetaObject::invokeMethod(this, "templateLoaded", Qt::QueuedConnection, Q_ARG(QString, path));
+    });
+}
+
+void DFastLTFitService::templateLoaded(const QString &path)
+{
+    m_mutex.lock();
+    PALSProject *project = m_loadedTemplates.take(path);
+    m_mutex.unlock();
+
+    const QList<DFastLTFitServiceRequest> waitingRequests = m_loadingTemplates.take(path);
+
+    m_mutex.lock();
+    m_queuedJobs -= waitingRequests.size();
+    m_mutex.unlock();
+
+    if ( project )
+        m_templates.insert(path, project); /* failed loads are not kept: the next request tries again */
+
+    for ( const DFastLTFitServiceRequest& waitingRequest : waitingRequests ) {
+        if ( !waitingRequest.connection )
+            continue;
+
+        if ( project )
+            submitFit(waitingRequest.connection, waitingRequest.request);
+        else
+            sendError(waitingRequest.connection, waitingRequest.request.value("id"), "cannot load template: " % waitingRequest.request.value("template").toString());
+    }
+
+    admitHeldRequests();
+}
+
+bool DFastLTFitService::readSpectrum(const QJsonObject &request, PALSBatchSpectrum *spectrum, QString *error)
+{
+    spectrum->name = request.value("name").toString();
+    spectrum->binFactor = 1;
+
+    int binFac = 1;
+
+    if ( request.contains("bin_factor") ) {
+        binFac = request.value("bin_factor").toInt(0);
+
+        if ( binFac < 1 ) {
+            *error = "invalid bin_factor";
+            return false;
+        }
+    }
+
+    /* ASCII file: imported (and binned) by the fit */
+    if ( request.contains("file") ) {
+        spectrum->fileName = request.value("file").toString();
+        spectrum->binFactor = binFac;
+
+        if ( spectrum->name.isEmpty() )
+            spectrum->name = QFileInfo(spectrum->fileName).fileName();
+
+        return true;
+    }
+
+    QVector<double> counts;
+
+    if ( request.contains("counts_f64") ) {
+        const QByteArray data = QByteArray::fromBase64(request.value("counts_f64").toString().toLatin1());
+
+        if ( data.size()%sizeof(double) ) {
+            *error = "invalid counts_f64: size is not a multiple of 8 bytes";
+            return false;
+        }
+
+        counts.resize(data.size()/sizeof(double));
+
+        const uchar *src = (const uchar*)data.constData();
+
+        for ( int i = 0 ; i < counts.size() ; ++ i ) {
+            const quint64 bits = qFromLittleEndian<quint64>(src + i*sizeof(double));
+            memcpy(&counts[i], &bits, sizeof(double));
+        }
+    }
+    else if ( request.value("counts").isArray() ) {
+        const QJsonArray countsArray = request.value("counts").toArray();
+
+        counts.resize(countsArray.size());
+
+        for ( int i = 0 ; i < countsArray.size() ; ++ i ) {
+            if ( !countsArray.at(i).isDouble() ) {
+                *error = "invalid counts: numbers expected";
+                return false;
+            }
+
+            counts[i] = countsArray.at(i).toDouble();
+        }
+    }
+    else {
+        *error = "no spectrum: counts, counts_f64 or file expected";
+        return false;
+    }
+
+    QVector<double> channels;
+
+    if ( request.contains("channels") ) {
+        /* the bins of a binned spectrum are numbered as by the ASCII import */
+        if ( binFac > 1 ) {
+            *error = "invalid channels: not supported with bin_factor > 1";
+            return false;
+        }
+
+        if ( !request.value("channels").isArray() ) {
+            *error = "invalid channels: JSON array expected";
+            return false;
+        }
+
+        const QJsonArray channelArray = request.value("channels").toArray();
+
+        if ( channelArray.size() != counts.size() ) {
+            *error = "invalid channels: size differs from counts";
+            return false;
+        }
+
+        channels.resize(channelArray.size());
+
+        for ( int i = 0 ; i < channelArray.size() ; ++ i ) {
+            if ( !channelArray.at(i).isDouble()
+                 || !std::isfinite(channelArray.at(i).toDouble()) ) {
+                *error = "invalid channels: finite numbers expected";
+                return false;
+            }
+
+            channels[i] = channelArray.at(i).toDouble();
+
+            /* the ROI is looked up by a binary search (PALSSpectrum::lowerBound(...)) */
+            if ( i > 0
+                 && channels.at(i) <= channels.at(i - 1) ) {
+                *error = "invalid channels: strictly ascending values expected (index " % QVariant(i).toString() % ")";
+                return false;
+            }
+        }
+    }
+
+    for ( int i = 0 ; i < counts.size() ; ++ i ) {
+        if ( !std::isfinite(counts.at(i))
+             || counts.at(i) < 0.0f ) {
+            *error = "invalid counts: negative or non-finite value at channel " % QVariant(i).toString();
+            return false;
+        }
+    }
+
+    if ( binFac == 1 ) {
+        if ( channels.isEmpty() ) {
+            channels.resize(counts.size());
+
+            for ( int i = 0 ; i < channels.size() ; ++ i )
+                channels[i] = i;
+        }
+
+        spectrum->dataSet = PALSSpectrum(channels, counts);
+    }
+    else {
+        /* as the ASCII import: the bins are numbered 0, 1, ..., incomplete bins at the end are dropped */
+        const int binCnt = counts.size()/binFac;
+
+        spectrum->dataSet = PALSSpectrum(binCnt);
+
+        double *binChannels = spectrum->dataSet.channelData();
+        double *binCounts = spectrum->dataSet.countsData();
+
+        for ( int bin = 0 ; bin < binCnt ; ++ bin ) {
+            binChannels[bin] = bin;
+
+            for ( int i = 0 ; i < binFac ; ++ i )
+                binCounts[bin] += counts.at(bin*binFac + i);
+        }
+    }
+
+    if ( spectrum->dataSet.size() <= 2 ) {
+        *error = "too few channels";
+        return false;
+    }
+
+    return true;
+}
+
+bool DFastLTFitService::readNumber(const QJsonObject &object, const QString &key, double *value, QString *error)
+{
+    if ( !object.value(key).isDouble() ) {
+        *error = "invalid parameter: " % key % " (number expected)";
+        return false;
+    }
+
+    *value = object.value(key).toDouble();
+
+    return true;
+}
+
+bool DFastLTFitService::applyOverrides(const QJsonObject &request, PALSFitSet *fitSet, QString *error)
+{
+    double value = 0.0f;
+
+    if ( request.contains("start_channel") ) {
+        if ( !readNumber(request, "start_channel", &value, error) )
+            return false;
+
+        fitSet->setStartChannel((int)value);
+    }
+
+    if ( request.contains("stop_channel") ) {
+        if ( !readNumber(request, "stop_channel", &value, error) )
+            return false;
+
+        fitSet->setStopChannel((int)value);
+    }
+
+    if ( request.contains("channel_resolution") ) {
+        if ( !readNumber(request, "channel_resolution", &value, error) )
+            return false;
+
+        if ( value <= 0.0f ) {
+            *error = "invalid channel_resolution";
+            return false;
+        }
+
+        fitSet->setChannelResolution(value);
+    }
+
+    if ( request.contains("max_iterations") ) {
+        if ( !readNumber(request, "max_iterations", &value, error) )
+            return false;
+
+        if ( value < 1.0f ) {
+            *error = "invalid max_iterations";
+            return false;
+        }
+
+        fitSet->setMaximumIterations((unsigned int)value);
+    }
+
+    if ( !request.contains("parameters") )
+        return true;
+
+    if ( !request.value("parameters").isObject() ) {
+        *error = "invalid parameters: JSON object expected";
+        return false;
+    }
+
+    /* parameters in the order of LifeTimeDecayBatchFitEngine::parameterNames(...) */
+    QList<PALSFitParameter*> parameters;
+
+    for ( unsigned int i = 0 ; i < fitSet->getSourceParamPtr()->getSize() ; ++ i )
+        parameters.append(fitSet->getSourceParamPtr()->getParameterAt(i));
+
+    for ( unsigned int i = 0 ; i < fitSet->getLifeTimeParamPtr()->getSize() ; ++ i )
+        parameters.append(fitSet->getLifeTimeParamPtr()->getParameterAt(i));
+
+    for ( unsigned int i = 0 ; i < fitSet->getDeviceResolutionParamPtr()->getSize() ; ++ i )
+        parameters.append(fitSet->getDeviceResolutionParamPtr()->getParameterAt(i));
+
+    parameters.append(fitSet->getBackgroundParamPtr()->getParameter());
+
+    const QStringList names = LifeTimeDecayBatchFitEngine::parameterNames(fitSet);
+    const QJsonObject parameterObject = request.value("parameters").toObject();
+
+    for ( auto it = parameterObject.constBegin() ; it != parameterObject.constEnd() ; ++ it ) {
+        const int index = names.indexOf(it.key());
+
+        if ( index < 0
+             || index >= parameters.size() /* average_lifetime */
+             || !it.value().isObject() ) {
+            *error = "invalid parameter: " % it.key();
+            return false;
+        }
+
+        PALSFitParameter *parameter = parameters.at(index);
+        const QJsonObject overrideObject = it.value().toObject();
+
+        if ( overrideObject.contains("start") ) {
+            if ( !readNumber(overrideObject, "start", &value, error) ) {
+                *error = "invalid parameter: " % it.key() % ".start (number expected)";
+                return false;
+            }
+
+            parameter->setStartValue(value);
+        }
+
+        /* null: bound disabled */
+        if ( overrideObject.contains("lower") ) {
+            if ( overrideObject.value("lower").isNull() )
+                parameter->setLowerBoundingEnabled(false);
+            else if ( readNumber(overrideObject, "lower", &value, error) ) {
+                parameter->setLowerBoundingEnabled(true);
+                parameter->setLowerBoundingValue(value);
+            }
+            else {
+                *error = "invalid parameter: " % it.key() % ".lower (number or null expected)";
+                return false;
+            }
+        }
+
+        if ( overrideObject.contains("upper") ) {
+            if ( overrideObject.value("upper").isNull() )
+                parameter->setUpperBoundingEnabled(false);
+            else if ( readNumber(overrideObject, "upper", &value, error) ) {
+                parameter->setUpperBoundingEnabled(true);
+                parameter->setUpperBoundingValue(value);
+            }
+            else {
+                *error = "invalid parameter: " % it.key() % ".upper (number or null expected)";
+                return false;
+            }
+        }
+
+        if ( overrideObject.contains("fixed") ) {
+            if ( !overrideObject.value("fixed").isBool() ) {
+                *error = "invalid parameter: " % it.key() % ".fixed (boolean expected)";
+                return false;
+            }
+
+            parameter->setAsFixed(overrideObject.value("fixed").toBool());
+        }
+    }
+
+    return true;
+}
+
+QJsonObject DFastLTFitService::statusObject() const
+{
+    m_mutex.lock();
+    const int queuedJobs = m_queuedJobs;
+    const int runningJobs = m_runningJobs;
+    m_mutex.unlock();
+
+    const qint64 now = m_uptime.elapsed();
+    const double uptime = (double)now*1E-3;
+
+    int recentJobs = 0;
+
+    for ( int i = m_completionTimes.size() - 1 ; i >= 0 && m_completionTimes.at(i) >= now - SERVICE_RATE_WINDOW ; -- i )
+        recentJobs ++;
+
+    /* the window is shorter during the first SERVICE_RATE_WINDOW */
+    const double window = (double)qMin(now, (qint64)SERVICE_RATE_WINDOW)*1E-3;
+
+    QJsonObject status;
+
+    status.insert("type", QString("status"));
+    status.insert("queue_depth", queuedJobs + runningJobs);
+    status.insert("queued", queuedJobs);
+    status.insert("running", runningJobs);
+    status.insert("max_queue", m_maxQueue);
+    status.insert("workers", m_threadCnt);
+    status.insert("accepted", (double)m_acceptedJobs);
+    status.insert("completed", (double)m_completedJobs);
+    status.insert("fits_per_second", (window > 0.0f)?((double)recentJobs/window):0.0f);
+    status.insert("average_fits_per_second", (uptime > 0.0f)?((double)m_completedJobs/uptime):0.0f);
+    status.insert("uptime", uptime);
+
+    return status;
+}
+
+void DFastLTFitService::send(QIODevice *connection, const QJsonObject &response)
+{
+    if ( !connection
+         || !connection->isOpen() )
+        return;
+
+    connection->write(QJsonDocument(response).toJson(QJsonDocument::Compact) + '\n');
+}
+
+void DFastLTFitService::sendError(QIODevice *connection, const QJsonValue &clientId, const QString &message)
+{
+    QJsonObject response;
+
+    response.insert("type", QString("error"));
+
+    if ( !clientId.isUndefined() )
+        response.insert("id", clientId);
+
+    response.insert("message", message);
+
+    send(connection, response);
+}
+
+FitWorkspace *DFastLTFitService::acquireWorkspace()
+{
+    QMutexLocker locker(&m_workspaceMutex);
+
+    if ( !m_idleWorkspaces.isEmpty() )
+        return m_idleWorkspaces.takeLast();
+
+    FitWorkspace *workspace = new FitWorkspace;
+    m_workspaces.append(workspace);
+
+    return workspace;
+}
+
+void DFastLTFitService::releaseWorkspace(FitWorkspace *workspace)
+{
+    QMutexLocker locker(&m_workspaceMutex);
+
+    m_idleWorkspaces.append(workspace);
+}
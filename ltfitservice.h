@@ -0,0 +1,220 @@
+/****************************************************************************
+**
+**  DQuickLTFit, a software for the analysis of Positron-Lifetime Spectra
+**  based on the Least-Square Optimization using the Levenberg-Marquardt
+**  Algorithm.
+**
+**  Copyright (C) 2016-2021 Danny Petschke
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU General Public License as published by
+**  the Free Software Foundation, either version 3 of the License, or
+**  (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU General Public License for more details.
+**
+**  You should have received a copy of the GNU General Public License
+**  along with this program.  If not, see http://www.gnu.org/licenses/.
+**
+*****************************************************************************
+**
+**  @author: Danny Petschke
+**  @contact: danny.petschke@uni-wuerzburg.de
+**
+*****************************************************************************/
+
+
+#ifndef DFASTLTFITSERVICE_H
+#define DFASTLTFITSERVICE_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QPointer>
+#include <QHash>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QtEndian>
+
+#include <cstring>
+
+#include "Settings/projectmanager.h"
+
+#include "Fit/lifetimedecayfit.h"
+#include "Fit/lifetimedecaybatchfit.h"
+#include "Fit/fitthreadpool.h"
+#include "Fit/fitworkspace.h"
+
+#include "ltdefines.h"
+
+//#define __FITSERVICE_DEBUG
+
+#define SERVICE_DEFAULT_PORT 7283
+#define SERVICE_MAX_REQUEST_SIZE (64 << 20) /* [bytes] of a single request (line) */
+#define SERVICE_QUEUE_FACTOR 4 /* default queue limit: jobs per worker */
+#define SERVICE_RATE_WINDOW 60000 /* [ms] sliding window of fits_per_second */
+
+/* fit job of the service: a spectrum fitted with a private copy of the template (incl. the overrides of the request) */
+typedef struct {
+    int id; /* job id of the service */
+    QJsonValue clientId; /* "id" of the request (echoed) */
+
+    QPointer<QIODevice> connection; /* null: client disconnected */
+
+    PALSBatchSpectrum spectrum;
+    PALSProject *project; /* private fit set */
+    QStringList names; /* of the result values */
+    int multiStartCnt;
+
+    PALSBatchFitResult result;
+} DFastLTFitServiceJob;
+
+/* fit request waiting for its template to be loaded */
+typedef struct {
+    QPointer<QIODevice> connection; /* null: client disconnected */
+    QJsonObject request;
+} DFastLTFitServiceRequest;
+
+/*
+ * DFastLTFitService - fit daemon (JSON over a local socket):
+ *-----------------------------------------------------------
+ *
+ * DQuickLTFit --serve <project> [--port <n> | --local <name>] [--threads <n>] [--multi-start <n>] [--max-queue <n>]
+ *
+ * Listens on localhost (TCP) or on a local socket (Unix domain socket/named pipe). Requests and responses are JSON objects,
+ * one per line (UTF-8, '\n' terminated). The project of the command line is the default template, further templates are
+ * loaded on their first use by a loader thread (the requests of a template being loaded wait, all other requests and
+ * results keep flowing) and kept.
+ *
+ * requests:
+ *
+ * {"type": "fit", "id": <any>, "template": <project>, "counts": [...], "channels": [...], "bin_factor": <n>,
+ *  "multi_start": <n>, "start_channel": <n>, "stop_channel": <n>, "channel_resolution": <ps>, "max_iterations": <n>,
+ *  "parameters": {"tau_1": {"start": <v>, "lower": <v>, "upper": <v>, "fixed": <bool>}, ...}}
+ *
+ *      the spectrum is given by "counts" (JSON array), "counts_f64" (binary: base64 of little-endian doubles) or "file"
+ *      (ASCII file readable by the service). "channels" of counts/counts_f64: strictly ascending (0, 1, ... by default),
+ *      not combined with "bin_factor" > 1 (the bins are numbered 0, 1, ... as by the ASCII import). Parameter names as in
+ *      the batch results (see LifeTimeDecayBatchFitEngine::parameterNames(...)), all fields except the spectrum are
+ *      optional. Numeric fields must be JSON numbers, "lower"/"upper": null disables the bound.
+ *
+ * {"type": "status"}
+ *
+ * responses:
+ *
+ * {"type": "accepted", "job": <job>, "id": <any>, "queue_depth": <n>}
+ * {"type": "result", "job": <job>, "id": <any>, "status": <mpfit status>, "status_text": ..., "reduced_chi_square": ...,
+ *  "fit_time": ..., "parameters": {"tau_1": {"value": ..., "error": ...}, ...}, "queue_depth": <n>}
+ * {"type": "status", "queue_depth": <n>, "queued": <n>, "running": <n>, "max_queue": <n>, "workers": <n>, "accepted": <n>,
+ *  "completed": <n>, "fits_per_second": ..., "average_fits_per_second": ..., "uptime": <s>}
+ * {"type": "error", "id": <any>, "message": ...}
+ *
+ *      fits_per_second: completed fits within the last SERVICE_RATE_WINDOW, average_fits_per_second: since the start.
+ *
+ * The results are streamed back in the order of completion. Backpressure: if queue_depth (queued + running jobs incl. the
+ * requests waiting for their template) reaches the limit, the next fit request of a connection is held and the connection
+ * is not read any further until a job has finished (the socket buffers fill up and block the client). Held requests are admitted in the order of arrival.
+ */
+
+class DFastLTFitService : public QObject
+{
+    Q_OBJECT
+public:
+    /* threadCnt: concurrent fits (0: one per core), maxQueue: limit of queued + running jobs (0: SERVICE_QUEUE_FACTOR per worker) */
+    DFastLTFitService(const PALSFitSet *defaultTemplate, int threadCnt, int multiStartCnt, int maxQueue);
+    virtual ~DFastLTFitService();
+
+    bool listen(quint16 port);
+    bool listenLocal(const QString& name);
+
+    QString errorString() const;
+
+    /* TCP port (e.g. chosen by the system for listen(0)), 0: not listening on TCP */
+    quint16 serverPort() const;
+
+    /* queued + running jobs */
+    int queueDepth() const;
+
+private slots:
+    void newTcpConnection();
+    void newLocalConnection();
+
+    void readRequests();
+    void connectionClosed();
+
+    void jobFinished(int jobId);
+    void templateLoaded(const QString& path);
+
+private:
+    void addConnection(QIODevice *connection);
+    void processConnection(QIODevice *connection);
+
+    /* false: the queue is full, the request is held */
+    bool processRequest(QIODevice *connection, const QJsonObject& request);
+    bool submitFit(QIODevice *connection, const QJsonObject& request);
+
+    void runJob(DFastLTFitServiceJob *job);
+
+    /* fit requests of held connections while the queue has room */
+    void admitHeldRequests();
+
+    /* the request is submitted again when the template is loaded (see templateLoaded(...)) */
+    void loadTemplate(const QString& path, QIODevice *connection, const QJsonObject& request);
+
+    static bool readSpectrum(const QJsonObject& request, PALSBatchSpectrum *spectrum, QString *error);
+    static bool readNumber(const QJsonObject& object, const QString& key, double *value, QString *error);
+    static bool applyOverrides(const QJsonObject& request, PALSFitSet *fitSet, QString *error);
+
+    QJsonObject statusObject() const;
+
+    void send(QIODevice *connection, const QJsonObject& response);
+    void sendError(QIODevice *connection, const QJsonValue& clientId, const QString& message);
+
+    FitWorkspace *acquireWorkspace();
+    void releaseWorkspace(FitWorkspace *workspace);
+
+private:
+    QTcpServer m_tcpServer;
+    QLocalServer m_localServer;
+
+    const PALSFitSet *m_defaultTemplate;
+    QHash<QString, PALSProject*> m_templates; /* loaded on first use */
+    QHash<QString, QList<DFastLTFitServiceRequest> > m_loadingTemplates; /* requests waiting for the template */
+    QHash<QString, PALSProject*> m_loadedTemplates; /* handed over by the loader (nullptr: failed), guarded by m_mutex */
+    FitThreadPool *m_loader;
+
+    FitThreadPool *m_pool;
+    int m_threadCnt;
+    int m_multiStartCnt;
+    int m_maxQueue;
+
+    int m_nextJobId;
+    QHash<int, DFastLTFitServiceJob*> m_jobs;
+
+    QList<QIODevice*> m_connections;
+    QHash<QIODevice*, QJsonObject> m_heldRequests; /* fit requests waiting for a free slot of the queue */
+    QList<QIODevice*> m_heldConnections; /* in the order of arrival */
+
+    mutable QMutex m_mutex;
+    int m_queuedJobs;
+    int m_runningJobs;
+
+    qint64 m_acceptedJobs;
+    qint64 m_completedJobs;
+    QElapsedTimer m_uptime;
+    QList<qint64> m_completionTimes; /* [ms] of m_uptime within SERVICE_RATE_WINDOW */
+
+    QList<FitWorkspace*> m_idleWorkspaces;
+    QList<FitWorkspace*> m_workspaces;
+    QMutex m_workspaceMutex;
+};
+
+#endif // DFASTLTFITSERVICE_H
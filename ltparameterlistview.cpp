@@ -466,20 +466,19 @@ void ParameterListView::updateBackgroundValue()
         return;
     }
 
+    const PALSSpectrum spectrum = dataStructure->getDataSetPtr()->getLifeTimeData();
+
     int startChannelIndex = -1;
     int stopChannelIndex = -1;
 
-    int cnt = 0;
-    for ( QPointF p : dataStructure->getDataSetPtr()->getLifeTimeData() )
+    for ( int cnt = 0 ; cnt < spectrum.size() ; ++ cnt )
     {
-        if ( qFuzzyCompare(p.x(), channelMin) )
+        if ( qFuzzyCompare(spectrum.channelAt(cnt), channelMin) )
             startChannelIndex = cnt;
 
-        if ( qFuzzyCompare(p.x(), channelMax) )
+        if ( qFuzzyCompare(spectrum.channelAt(cnt), channelMax) )
             stopChannelIndex = cnt;
 
-         cnt ++;
-
          if ( startChannelIndex != -1 && stopChannelIndex != -1 )
              break;
     }
@@ -490,8 +489,8 @@ void ParameterListView::updateBackgroundValue()
     }
 
     double average = 0.0f;
-    int channelDiff = dataStructure->getDataSetPtr()->getLifeTimeData().last().x() -dataStructure->getDataSetPtr()->getLifeTimeData().at(stopChannelIndex).x();
-    int indexOffset = dataStructure->getDataSetPtr()->getLifeTimeData().size()-channels-channelDiff-1;
+    int channelDiff = spectrum.channelAt(spectrum.size() - 1) - spectrum.channelAt(stopChannelIndex);
+    int indexOffset = spectrum.size()-channels-channelDiff-1;
 
     if ( PALSProjectSettingsManager::sharedInstance()->getBackgroundCalculationFromFirstChannels() )
         indexOffset = 0;
@@ -500,7 +499,7 @@ void ParameterListView::updateBackgroundValue()
     {
         const int index = indexOffset+i;
 
-        average += dataStructure->getDataSetPtr()->getLifeTimeData().at(index).y();
+        average += spectrum.countsAt(index);
     }
 
     average /= channels;
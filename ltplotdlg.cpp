@@ -35,6 +35,10 @@ DFastPlotDlg::DFastPlotDlg(QWidget *parent) :
 {
     ui->setupUi(this);
 
+    ///rasterized on a worker thread (large spectra):
+    ui->widget->dataPlotView_1()->setAsyncRendering(true);
+    ui->widget->dataPlotView_2()->setAsyncRendering(true);
+
     ///raw-data:
     ui->widget->dataPlotView_1()->curve().at(0)->setCurveColor(Qt::red);
     ui->widget->dataPlotView_1()->curve().at(0)->setCurveStyle(plot2DXCurve::rect);
@@ -108,29 +112,38 @@ void DFastPlotDlg::showEvent(QShowEvent *event)
     QWidget::showEvent(event);
 }
 
-void DFastPlotDlg::addRawData(const QList<QPointF> &datas)
+void DFastPlotDlg::addRawData(const PALSSpectrum &datas)
 {
-    ui->widget->dataPlotView_1()->curve().at(0)->addData(datas);
+    ui->widget->dataPlotView_1()->curve().at(0)->addData(datas.channels(), datas.counts(), datas.size());
     ui->widget->dataPlotView_1()->replot();
 
     ui->widget->dataPlotView_1()->autoscale();
 }
 
-void DFastPlotDlg::addPreviewData(const QList<QPointF> &datas)
+void DFastPlotDlg::updateRawData(const PALSSpectrum &datas, int fromChannel)
+{
+    if ( fromChannel < 0 || fromChannel > datas.size() )
+        return;
+
+    ui->widget->dataPlotView_1()->curve().at(0)->updateData(fromChannel, datas.channels() + fromChannel, datas.counts() + fromChannel, datas.size() - fromChannel);
+    ui->widget->dataPlotView_1()->replot();
+}
+
+void DFastPlotDlg::addPreviewData(const PALSSpectrum &datas)
 {
-    ui->widget->dataPlotView_1()->curve().at(1)->addData(datas);
+    ui->widget->dataPlotView_1()->curve().at(1)->addData(datas.channels(), datas.counts(), datas.size());
     ui->widget->dataPlotView_1()->replot();
 }
 
-void DFastPlotDlg::addFitData(const QList<QPointF> &datas)
+void DFastPlotDlg::addFitData(const PALSSpectrum &datas)
 {
-    ui->widget->dataPlotView_1()->curve().at(2)->addData(datas);
+    ui->widget->dataPlotView_1()->curve().at(2)->addData(datas.channels(), datas.counts(), datas.size());
     ui->widget->dataPlotView_1()->replot();
 }
 
-void DFastPlotDlg::addResidualData(const QList<QPointF> &datas)
+void DFastPlotDlg::addResidualData(const PALSSpectrum &datas)
 {
-    ui->widget->dataPlotView_2()->curve().at(0)->addData(datas);
+    ui->widget->dataPlotView_2()->curve().at(0)->addData(datas.channels(), datas.counts(), datas.size());
     ui->widget->dataPlotView_2()->replot();
 
     ui->widget->dataPlotView_2()->autoscale();
@@ -58,10 +58,11 @@ protected:
     virtual void showEvent(QShowEvent *event);
 
 public slots:
-    void addRawData(const QList<QPointF>& datas);
-    void addPreviewData(const QList<QPointF>& datas);
-    void addFitData(const QList<QPointF>& datas);
-    void addResidualData(const QList<QPointF>& datas);
+    void addRawData(const PALSSpectrum& datas);
+    void updateRawData(const PALSSpectrum& datas, int fromChannel);
+    void addPreviewData(const PALSSpectrum& datas);
+    void addFitData(const PALSSpectrum& datas);
+    void addResidualData(const PALSSpectrum& datas);
 
     void clearAll();
 
@@ -27,6 +27,7 @@
 *****************************************************************************/
 
 #include "ltfitdlg.h"
+#include "ltfitcli.h"
 #include "ltdefines.h"
 
 #include <QApplication>
@@ -37,6 +38,10 @@
 
 int main(int argc, char *argv[])
 {
+    /* headless mode: no QApplication, no single-instance lock and no splash screen */
+    if ( DFastLTFitCLI::isRequested(argc, argv) )
+        return DFastLTFitCLI::exec(argc, argv);
+
     QSharedMemory sharedMemory;
     sharedMemory.setKey("DQuickLTFit0123456789qwetzuioasdfghjklerfgbnpokjn,.-234567890weuhcq8934cn43q8DQuickLTFit");
 